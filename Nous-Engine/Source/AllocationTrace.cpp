@@ -0,0 +1,193 @@
+#include "AllocationTrace.h"
+
+#include "Logger.h"
+#include "Asserts.h"
+#include "FileHandle.h"
+#include "VirtualMemory.h"
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+struct TraceFileHeader
+{
+	char magic[4];
+	uint32 version;
+	uint64 eventCount;
+};
+
+static const char c_TRACE_MAGIC[4] = { 'N', 'T', 'R', 'C' };
+static const uint32 c_TRACE_VERSION = 1;
+
+struct TraceState
+{
+	std::atomic<bool> recording;
+	std::atomic<uint64> eventCount;
+	std::atomic<uint64> droppedEvents;
+	std::atomic<uint16> nextThreadIndex;
+
+	AllocationTrace::Event* events;
+	uint64 capacity;
+	uint64 bufferSize;
+
+	std::chrono::steady_clock::time_point startTime;
+};
+
+static TraceState trace;
+
+static uint16 GetThreadIndex()
+{
+	static thread_local uint16 threadIndex = trace.nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+	return threadIndex;
+}
+
+bool AllocationTrace::Start(uint64 maxEvents)
+{
+	Reset();
+
+	trace.bufferSize = VirtualMemory::AlignToPage(maxEvents * sizeof(Event));
+	trace.events = static_cast<Event*>(VirtualMemory::Reserve(trace.bufferSize));
+
+	// Pages are only backed once an event is written to them
+	if (!trace.events || !VirtualMemory::Commit(trace.events, trace.bufferSize))
+	{
+		NOUS_ERROR("AllocationTrace::Start() - Failed to reserve %llu bytes for the trace", trace.bufferSize);
+		Reset();
+		return false;
+	}
+
+	trace.capacity = maxEvents;
+	trace.startTime = std::chrono::steady_clock::now();
+
+	trace.recording.store(true, std::memory_order_release);
+
+	NOUS_INFO("Allocation trace recording started (%llu events max)", maxEvents);
+
+	return true;
+}
+
+void AllocationTrace::Stop()
+{
+	if (!trace.recording.exchange(false, std::memory_order_acq_rel)) return;
+
+	NOUS_INFO("Allocation trace recording stopped: %llu events, %llu dropped", GetEventCount(), GetDroppedEventCount());
+}
+
+void AllocationTrace::Reset()
+{
+	trace.recording.store(false, std::memory_order_release);
+
+	if (trace.events)
+	{
+		VirtualMemory::Release(trace.events, trace.bufferSize);
+	}
+
+	trace.events = nullptr;
+	trace.capacity = 0;
+	trace.bufferSize = 0;
+
+	trace.eventCount.store(0, std::memory_order_relaxed);
+	trace.droppedEvents.store(0, std::memory_order_relaxed);
+}
+
+bool AllocationTrace::IsRecording()
+{
+	return trace.recording.load(std::memory_order_relaxed);
+}
+
+void AllocationTrace::Record(EventType type, const void* address, uint64 size, uint64 alignment, MemoryManager::MemoryTag tag)
+{
+	if (!trace.recording.load(std::memory_order_acquire)) return;
+
+	const uint64 index = trace.eventCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (index >= trace.capacity)
+	{
+		trace.droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Event& event = trace.events[index];
+
+	event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace.startTime).count();
+	event.address = reinterpret_cast<uint64>(address);
+	event.size = size;
+	event.alignment = static_cast<uint32>(alignment);
+	event.threadIndex = GetThreadIndex();
+	event.tag = static_cast<uint8>(tag);
+	event.type = type;
+}
+
+uint64 AllocationTrace::GetEventCount()
+{
+	return std::min(trace.eventCount.load(std::memory_order_relaxed), trace.capacity);
+}
+
+uint64 AllocationTrace::GetDroppedEventCount()
+{
+	return trace.droppedEvents.load(std::memory_order_relaxed);
+}
+
+bool AllocationTrace::Save(const char* path)
+{
+	NOUS_ASSERT_MSG(!IsRecording(), "AllocationTrace::Save() - Stop the recording first.");
+
+	FileHandle fileHandle;
+
+	if (!fileHandle.Open(path, FileMode::WRITE, true))
+	{
+		NOUS_ERROR("AllocationTrace::Save() - Couldn't open %s", path);
+		return false;
+	}
+
+	TraceFileHeader header = {};
+	MemoryManager::CopyMemory(header.magic, c_TRACE_MAGIC, sizeof(header.magic));
+	header.version = c_TRACE_VERSION;
+	header.eventCount = GetEventCount();
+
+	uint64 bytesWritten = 0;
+
+	if (!fileHandle.Write(sizeof(header), &header, &bytesWritten) ||
+		(header.eventCount > 0 && !fileHandle.Write(header.eventCount * sizeof(Event), trace.events, &bytesWritten)))
+	{
+		NOUS_ERROR("AllocationTrace::Save() - Failed writing %s", path);
+		return false;
+	}
+
+	NOUS_INFO("Allocation trace saved to %s (%llu events)", path, header.eventCount);
+
+	return true;
+}
+
+bool AllocationTrace::Load(const char* path, std::vector<Event>& outEvents)
+{
+	FileHandle fileHandle;
+
+	if (!fileHandle.Open(path, FileMode::READ, true))
+	{
+		NOUS_ERROR("AllocationTrace::Load() - Couldn't open %s", path);
+		return false;
+	}
+
+	TraceFileHeader header = {};
+	uint64 bytesRead = 0;
+
+	if (!fileHandle.ReadBytes(sizeof(header), reinterpret_cast<char*>(&header), &bytesRead) ||
+		std::memcmp(header.magic, c_TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != c_TRACE_VERSION)
+	{
+		NOUS_ERROR("AllocationTrace::Load() - %s is not a valid allocation trace", path);
+		return false;
+	}
+
+	outEvents.resize(header.eventCount);
+
+	if (header.eventCount > 0 && !fileHandle.ReadBytes(header.eventCount * sizeof(Event), reinterpret_cast<char*>(outEvents.data()), &bytesRead))
+	{
+		NOUS_ERROR("AllocationTrace::Load() - %s is truncated", path);
+		outEvents.clear();
+		return false;
+	}
+
+	return true;
+}
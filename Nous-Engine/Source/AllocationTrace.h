@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Globals.h"
+#include "MemoryManager.h"
+
+#include <vector>
+
+// Records every MemoryManager allocation and free of a real session, so AllocatorBenchmark can replay it.
+// Events are appended lock-free into a preallocated buffer outside the MemoryManager; once it's full the
+// remaining events are dropped (and counted) instead of growing.
+
+namespace AllocationTrace
+{
+	enum class EventType : uint8
+	{
+		ALLOCATE = 0,
+		FREE
+	};
+
+	struct Event
+	{
+		uint64 timestamp;		// Nanoseconds since Start()
+		uint64 address;			// Identifies the block, a free matches the last allocation at the same address
+		uint64 size;
+		uint32 alignment;
+		uint16 threadIndex;		// Sequential index of the thread, in order of first appearance
+		uint8 tag;				// MemoryManager::MemoryTag
+		EventType type;
+	};
+
+	// Default buffer fits 4M events (128 MiB of address space, committed as it's written)
+	constexpr uint64 c_DEFAULT_TRACE_CAPACITY = 4 * 1024 * 1024;
+
+	/**
+	 * @brief Starts recording, discarding any previous trace.
+	 * @return false if the event buffer couldn't be reserved.
+	 */
+	bool Start(uint64 maxEvents = c_DEFAULT_TRACE_CAPACITY);
+
+	void Stop();
+
+	/**
+	 * @brief Releases the event buffer, the trace is lost.
+	 */
+	void Reset();
+
+	bool IsRecording();
+
+	/**
+	 * @brief Called by the MemoryManager, does nothing unless recording.
+	 */
+	void Record(EventType type, const void* address, uint64 size, uint64 alignment, MemoryManager::MemoryTag tag);
+
+	uint64 GetEventCount();
+	uint64 GetDroppedEventCount();
+
+	/**
+	 * @brief Writes the recorded events to a binary trace file. Call it after Stop().
+	 */
+	bool Save(const char* path);
+
+	bool Load(const char* path, std::vector<Event>& outEvents);
+}
@@ -0,0 +1,764 @@
+#include "AllocatorBenchmark.h"
+
+#include "DynamicAllocator.h"
+#include "LinearAllocator.h"
+#include "MemoryManager.h"
+#include "AllocationTrace.h"
+#include "Logger.h"
+
+#include "External/Parson/parson.h"
+
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+struct BenchmarkOperation
+{
+	uint32 slot;
+	uint64 size;
+	uint8 tag;
+	bool free;		// Frees the block in slot instead of allocating into it
+};
+
+struct BenchmarkWorkload
+{
+	const char* name;
+	std::vector<BenchmarkOperation> operations;
+	uint32 slotCount;
+};
+
+struct LatencyReport
+{
+	double p50;
+	double p99;
+	double p999;
+	double max;
+	double mean;
+};
+
+struct BenchmarkResult
+{
+	LatencyReport allocate;
+	LatencyReport free;
+
+	uint64 operations;
+	uint64 failures;
+	uint64 peakLiveBytes;		// Requested bytes alive at the peak
+	uint64 peakUsedBytes;		// Bytes the allocator had handed out at the peak (overhead and padding included)
+	float fragmentation;		// 1 - largest free block / free space, sampled at the peak
+	double totalMs;
+};
+
+static const uint64 c_BENCHMARK_HEAP_SIZE = MiB(128);
+static const uint32 c_BENCHMARK_SLOTS = 4096;
+static const uint32 c_BENCHMARK_OPERATIONS = 200000;
+static const uint32 c_PRODUCER_CONSUMER_QUEUE_SIZE = 1024;
+
+// ----------------------------------------------------------------------- //
+// Allocators under test
+// ----------------------------------------------------------------------- //
+
+class BenchmarkTarget
+{
+public:
+
+	virtual ~BenchmarkTarget() = default;
+
+	virtual const char* GetName() const = 0;
+
+	virtual void* Allocate(uint64 size, MemoryManager::MemoryTag tag) = 0;
+	virtual void Free(void* block, uint64 size, MemoryManager::MemoryTag tag) = 0;
+
+	virtual uint64 GetUsedBytes() const = 0;
+	virtual uint64 GetFreeSpace() const = 0;
+	virtual uint64 GetLargestFreeBlock() const = 0;
+
+	// Whether blocks can be allocated and freed from different threads
+	virtual bool IsThreadSafe() const = 0;
+};
+
+class DynamicAllocatorTarget : public BenchmarkTarget
+{
+public:
+
+	DynamicAllocatorTarget(DynamicAllocatorType type, bool threadSafe)
+		: type(type), threadSafe(threadSafe), memory(nullptr)
+	{
+		memory = malloc(DynamicAllocator::GetMemoryRequirement(c_BENCHMARK_HEAP_SIZE, type));
+
+		if (memory)
+		{
+			allocator.emplace(c_BENCHMARK_HEAP_SIZE, memory, type);
+		}
+	}
+
+	~DynamicAllocatorTarget() override
+	{
+		// The allocator lives in memory, it goes first
+		allocator.reset();
+		free(memory);
+	}
+
+	const char* GetName() const override
+	{
+		return (type == DynamicAllocatorType::TLSF) ? "TLSF" : "FREELIST";
+	}
+
+	void* Allocate(uint64 size, MemoryManager::MemoryTag) override
+	{
+		if (!threadSafe) return allocator->Allocate(size);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		return allocator->Allocate(size);
+	}
+
+	void Free(void* block, uint64 size, MemoryManager::MemoryTag) override
+	{
+		if (!threadSafe)
+		{
+			allocator->Free(block, size);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		allocator->Free(block, size);
+	}
+
+	uint64 GetUsedBytes() const override { return c_BENCHMARK_HEAP_SIZE - GetFreeSpace(); }
+
+	uint64 GetFreeSpace() const override
+	{
+		if (!threadSafe) return allocator->GetFreeSpace();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		return allocator->GetFreeSpace();
+	}
+
+	uint64 GetLargestFreeBlock() const override
+	{
+		if (!threadSafe) return allocator->GetLargestFreeBlock();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		return allocator->GetLargestFreeBlock();
+	}
+
+	bool IsThreadSafe() const override { return threadSafe; }
+
+	bool IsValid() const { return allocator.has_value(); }
+
+private:
+
+	DynamicAllocatorType type;
+	bool threadSafe;
+
+	void* memory;
+	std::optional<DynamicAllocator> allocator;
+	mutable std::mutex mutex;
+};
+
+// Frees are no-ops, the allocator is rewound when it runs out of space (counted as resets).
+// Baseline for what a pure bump allocator costs when lifetimes allow it.
+class LinearAllocatorTarget : public BenchmarkTarget
+{
+public:
+
+	LinearAllocatorTarget() : memory(malloc(c_BENCHMARK_HEAP_SIZE)), resets(0), peakOffset(0)
+	{
+		if (memory)
+		{
+			allocator.Create(c_BENCHMARK_HEAP_SIZE, memory);
+		}
+	}
+
+	~LinearAllocatorTarget() override
+	{
+		free(memory);
+	}
+
+	const char* GetName() const override { return "LINEAR"; }
+
+	void* Allocate(uint64 size, MemoryManager::MemoryTag) override
+	{
+		if (size > allocator.GetTotalSize()) return nullptr;
+
+		if (allocator.GetRemainingSize() < size + 16)
+		{
+			allocator.Reset();
+			resets++;
+		}
+
+		void* block = allocator.Allocate(size, 16);
+		peakOffset = std::max(peakOffset, allocator.GetAllocatedSize());
+
+		return block;
+	}
+
+	void Free(void*, uint64, MemoryManager::MemoryTag) override {}
+
+	uint64 GetUsedBytes() const override { return peakOffset; }
+	uint64 GetFreeSpace() const override { return allocator.GetRemainingSize(); }
+	uint64 GetLargestFreeBlock() const override { return allocator.GetRemainingSize(); }
+
+	bool IsThreadSafe() const override { return false; }
+
+	bool IsValid() const { return memory != nullptr; }
+	uint64 GetResetCount() const { return resets; }
+
+private:
+
+	void* memory;
+	LinearAllocator allocator;
+
+	uint64 resets;
+	uint64 peakOffset;
+};
+
+// The full engine path: thread caches, arenas and telemetry included.
+class MemoryManagerTarget : public BenchmarkTarget
+{
+public:
+
+	const char* GetName() const override { return "MEMORY_MANAGER"; }
+
+	void* Allocate(uint64 size, MemoryManager::MemoryTag tag) override
+	{
+		return MemoryManager::Allocate(size, tag, MemoryManager::AllocationFlags::UNINITIALIZED);
+	}
+
+	void Free(void* block, uint64 size, MemoryManager::MemoryTag tag) override
+	{
+		MemoryManager::Free(block, size, tag);
+	}
+
+	uint64 GetUsedBytes() const override
+	{
+		MemoryManager::EndFrame();
+
+		MemoryManager::MemorySnapshot snapshot;
+		MemoryManager::GetMemorySnapshot(&snapshot);
+
+		return snapshot.heapCapacity - snapshot.heapFreeSpace;
+	}
+
+	uint64 GetFreeSpace() const override
+	{
+		MemoryManager::MemorySnapshot snapshot;
+		MemoryManager::GetMemorySnapshot(&snapshot);
+
+		return snapshot.heapFreeSpace;
+	}
+
+	uint64 GetLargestFreeBlock() const override
+	{
+		MemoryManager::MemorySnapshot snapshot;
+		MemoryManager::GetMemorySnapshot(&snapshot);
+
+		return snapshot.heapLargestFreeBlock;
+	}
+
+	bool IsThreadSafe() const override { return true; }
+};
+
+// ----------------------------------------------------------------------- //
+// Workloads
+// ----------------------------------------------------------------------- //
+
+// Each operation picks a slot, frees whatever lives there and allocates a new block into it.
+template<typename SizeGenerator>
+static BenchmarkWorkload GenerateSlotWorkload(const char* name, uint64 seed, SizeGenerator&& generateSize)
+{
+	std::mt19937_64 generator(seed); // Fixed seed, every allocator replays the same operations
+	std::uniform_int_distribution<uint32> slotDistribution(0, c_BENCHMARK_SLOTS - 1);
+
+	BenchmarkWorkload workload = { name, {}, c_BENCHMARK_SLOTS };
+	workload.operations.reserve(c_BENCHMARK_OPERATIONS * 2);
+
+	std::vector<bool> occupied(c_BENCHMARK_SLOTS, false);
+
+	for (uint32 i = 0; i < c_BENCHMARK_OPERATIONS; ++i)
+	{
+		const uint32 slot = slotDistribution(generator);
+		const uint64 size = (generateSize(generator) + 15) & ~15ULL;
+		const uint8 tag = static_cast<uint8>(MemoryManager::MemoryTag::ARRAY);
+
+		if (occupied[slot])
+		{
+			workload.operations.push_back({ slot, 0, tag, true });
+		}
+
+		workload.operations.push_back({ slot, size, tag, false });
+		occupied[slot] = true;
+	}
+
+	return workload;
+}
+
+// Tiny blocks with a high turnover, the pattern of job, event and string allocations.
+static BenchmarkWorkload GenerateSmallObjectChurnWorkload()
+{
+	std::uniform_int_distribution<uint64> sizeDistribution(16, 256);
+
+	return GenerateSlotWorkload("small_object_churn", 0x4E4F5553,
+		[&sizeDistribution](std::mt19937_64& generator) { return sizeDistribution(generator); });
+}
+
+// Mostly small blocks with a tail of medium and large ones, so frees leave holes of every size behind.
+static BenchmarkWorkload GenerateFragmentationWorkload()
+{
+	std::uniform_int_distribution<uint32> classDistribution(0, 99);
+	std::uniform_int_distribution<uint64> smallDistribution(16, 256);
+	std::uniform_int_distribution<uint64> mediumDistribution(256, KiB(16));
+	std::uniform_int_distribution<uint64> largeDistribution(KiB(16), KiB(512));
+
+	return GenerateSlotWorkload("large_block_fragmentation", 0x4E4F5554,
+		[&](std::mt19937_64& generator)
+		{
+			const uint32 sizeClass = classDistribution(generator);
+
+			if (sizeClass < 70) return smallDistribution(generator);
+			if (sizeClass < 95) return mediumDistribution(generator);
+
+			return largeDistribution(generator);
+		});
+}
+
+// Turns a recorded trace into slot operations, each live address gets its own slot.
+// Frees of blocks allocated before the recording started are dropped.
+static BenchmarkWorkload GenerateTraceWorkload(const std::vector<AllocationTrace::Event>& events)
+{
+	BenchmarkWorkload workload = { "recorded_trace", {}, 0 };
+	workload.operations.reserve(events.size());
+
+	std::unordered_map<uint64, uint32> liveSlots;
+	std::vector<uint32> freeSlots;
+
+	for (const AllocationTrace::Event& event : events)
+	{
+		if (event.type == AllocationTrace::EventType::ALLOCATE)
+		{
+			uint32 slot = 0;
+
+			if (!freeSlots.empty())
+			{
+				slot = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			else
+			{
+				slot = workload.slotCount++;
+			}
+
+			// Over-aligned blocks pay for their padding like they do in the MemoryManager
+			const uint64 size = (event.alignment > 16) ? event.size + event.alignment : event.size;
+
+			liveSlots[event.address] = slot;
+			workload.operations.push_back({ slot, size, event.tag, false });
+		}
+		else
+		{
+			auto it = liveSlots.find(event.address);
+
+			if (it == liveSlots.end()) continue;
+
+			workload.operations.push_back({ it->second, 0, event.tag, true });
+
+			freeSlots.push_back(it->second);
+			liveSlots.erase(it);
+		}
+	}
+
+	return workload;
+}
+
+// ----------------------------------------------------------------------- //
+// Runners
+// ----------------------------------------------------------------------- //
+
+static LatencyReport ComputeLatencyReport(std::vector<double>& samples)
+{
+	LatencyReport report = {};
+
+	if (samples.empty()) return report;
+
+	std::sort(samples.begin(), samples.end());
+
+	auto percentile = [&samples](double p)
+		{
+			const size_t index = static_cast<size_t>(p * (samples.size() - 1));
+			return samples[index];
+		};
+
+	double sum = 0.0;
+
+	for (double sample : samples)
+	{
+		sum += sample;
+	}
+
+	report.p50 = percentile(0.50);
+	report.p99 = percentile(0.99);
+	report.p999 = percentile(0.999);
+	report.max = samples.back();
+	report.mean = sum / samples.size();
+
+	return report;
+}
+
+static double ElapsedNanoseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Records the allocator state whenever the live set reaches a new high (in 1% steps, so sampling stays cheap).
+static void SamplePeak(const BenchmarkTarget& target, uint64 liveBytes, uint64* sampledPeak, BenchmarkResult* result)
+{
+	if (liveBytes <= *sampledPeak + *sampledPeak / 100) return;
+
+	*sampledPeak = liveBytes;
+
+	// Used bytes first, the MemoryManager refreshes its heap figures there
+	result->peakUsedBytes = std::max(result->peakUsedBytes, target.GetUsedBytes());
+
+	const uint64 freeSpace = target.GetFreeSpace();
+	const uint64 largestFreeBlock = target.GetLargestFreeBlock();
+	result->fragmentation = (freeSpace > 0) ? 1.0f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeSpace) : 0.0f;
+}
+
+static BenchmarkResult RunWorkload(BenchmarkTarget& target, const BenchmarkWorkload& workload)
+{
+	BenchmarkResult result = {};
+
+	std::vector<void*> blocks(workload.slotCount, nullptr);
+	std::vector<uint64> sizes(workload.slotCount, 0);
+	std::vector<uint8> tags(workload.slotCount, 0);
+
+	std::vector<double> allocateSamples;
+	std::vector<double> freeSamples;
+
+	allocateSamples.reserve(workload.operations.size());
+	freeSamples.reserve(workload.operations.size());
+
+	uint64 liveBytes = 0;
+	uint64 sampledPeak = 0;
+
+	const auto workloadStart = std::chrono::steady_clock::now();
+
+	for (const BenchmarkOperation& operation : workload.operations)
+	{
+		const MemoryManager::MemoryTag tag = static_cast<MemoryManager::MemoryTag>(operation.tag);
+
+		if (operation.free)
+		{
+			void* block = blocks[operation.slot];
+
+			if (!block) continue; // Its allocation failed
+
+			const auto start = std::chrono::steady_clock::now();
+			target.Free(block, sizes[operation.slot], tag);
+			const auto end = std::chrono::steady_clock::now();
+
+			freeSamples.push_back(ElapsedNanoseconds(start, end));
+
+			liveBytes -= sizes[operation.slot];
+			blocks[operation.slot] = nullptr;
+
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		void* block = target.Allocate(operation.size, tag);
+		const auto end = std::chrono::steady_clock::now();
+
+		allocateSamples.push_back(ElapsedNanoseconds(start, end));
+
+		if (!block)
+		{
+			result.failures++;
+			continue;
+		}
+
+		blocks[operation.slot] = block;
+		sizes[operation.slot] = operation.size;
+		tags[operation.slot] = operation.tag;
+
+		liveBytes += operation.size;
+		result.peakLiveBytes = std::max(result.peakLiveBytes, liveBytes);
+
+		SamplePeak(target, liveBytes, &sampledPeak, &result);
+	}
+
+	result.totalMs = ElapsedNanoseconds(workloadStart, std::chrono::steady_clock::now()) / 1000000.0;
+
+	for (uint32 i = 0; i < workload.slotCount; ++i)
+	{
+		if (blocks[i]) target.Free(blocks[i], sizes[i], static_cast<MemoryManager::MemoryTag>(tags[i]));
+	}
+
+	result.operations = workload.operations.size();
+	result.allocate = ComputeLatencyReport(allocateSamples);
+	result.free = ComputeLatencyReport(freeSamples);
+
+	return result;
+}
+
+// One thread allocates, another one frees what it receives through a bounded single producer/consumer ring.
+static BenchmarkResult RunProducerConsumer(BenchmarkTarget& target)
+{
+	struct Message
+	{
+		void* block;
+		uint64 size;
+	};
+
+	BenchmarkResult result = {};
+
+	std::vector<uint64> sizes(c_BENCHMARK_OPERATIONS);
+	std::mt19937_64 generator(0x4E4F5555);
+	std::uniform_int_distribution<uint64> sizeDistribution(16, KiB(1));
+
+	for (uint64& size : sizes)
+	{
+		size = (sizeDistribution(generator) + 15) & ~15ULL;
+	}
+
+	std::unique_ptr<Message[]> ring(new Message[c_PRODUCER_CONSUMER_QUEUE_SIZE]);
+	std::atomic<uint64> head = 0; // Next message to consume
+	std::atomic<uint64> tail = 0; // Next message to produce
+	std::atomic<uint64> liveBytes = 0;
+
+	std::vector<double> allocateSamples;
+	std::vector<double> freeSamples;
+
+	allocateSamples.reserve(c_BENCHMARK_OPERATIONS);
+	freeSamples.reserve(c_BENCHMARK_OPERATIONS);
+
+	const MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::JOB;
+
+	const auto workloadStart = std::chrono::steady_clock::now();
+
+	std::thread consumer([&]()
+		{
+			for (uint32 i = 0; i < c_BENCHMARK_OPERATIONS; ++i)
+			{
+				const uint64 index = head.load(std::memory_order_relaxed);
+
+				while (tail.load(std::memory_order_acquire) == index)
+				{
+					std::this_thread::yield();
+				}
+
+				const Message message = ring[index % c_PRODUCER_CONSUMER_QUEUE_SIZE];
+				head.store(index + 1, std::memory_order_release);
+
+				if (!message.block) continue;
+
+				const auto start = std::chrono::steady_clock::now();
+				target.Free(message.block, message.size, tag);
+				const auto end = std::chrono::steady_clock::now();
+
+				freeSamples.push_back(ElapsedNanoseconds(start, end));
+				liveBytes.fetch_sub(message.size, std::memory_order_relaxed);
+			}
+		});
+
+	for (uint32 i = 0; i < c_BENCHMARK_OPERATIONS; ++i)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		void* block = target.Allocate(sizes[i], tag);
+		const auto end = std::chrono::steady_clock::now();
+
+		allocateSamples.push_back(ElapsedNanoseconds(start, end));
+
+		if (block)
+		{
+			const uint64 live = liveBytes.fetch_add(sizes[i], std::memory_order_relaxed) + sizes[i];
+			result.peakLiveBytes = std::max(result.peakLiveBytes, live);
+		}
+		else
+		{
+			result.failures++;
+		}
+
+		// Sampled from time to time, the footprint depends on how far the consumer lags behind
+		if (i % c_PRODUCER_CONSUMER_QUEUE_SIZE == 0)
+		{
+			result.peakUsedBytes = std::max(result.peakUsedBytes, target.GetUsedBytes());
+		}
+
+		const uint64 index = tail.load(std::memory_order_relaxed);
+
+		while (index - head.load(std::memory_order_acquire) >= c_PRODUCER_CONSUMER_QUEUE_SIZE)
+		{
+			std::this_thread::yield();
+		}
+
+		ring[index % c_PRODUCER_CONSUMER_QUEUE_SIZE] = { block, sizes[i] };
+		tail.store(index + 1, std::memory_order_release);
+	}
+
+	consumer.join();
+
+	result.totalMs = ElapsedNanoseconds(workloadStart, std::chrono::steady_clock::now()) / 1000000.0;
+	result.operations = c_BENCHMARK_OPERATIONS * 2ULL;
+	result.allocate = ComputeLatencyReport(allocateSamples);
+	result.free = ComputeLatencyReport(freeSamples);
+
+	return result;
+}
+
+// ----------------------------------------------------------------------- //
+// Reporting
+// ----------------------------------------------------------------------- //
+
+static JSON_Value* LatencyToJson(const LatencyReport& report)
+{
+	JSON_Value* value = json_value_init_object();
+	JSON_Object* object = json_value_get_object(value);
+
+	json_object_set_number(object, "p50", report.p50);
+	json_object_set_number(object, "p99", report.p99);
+	json_object_set_number(object, "p999", report.p999);
+	json_object_set_number(object, "max", report.max);
+	json_object_set_number(object, "mean", report.mean);
+
+	return value;
+}
+
+static void ReportResult(JSON_Array* results, const char* workloadName, const BenchmarkTarget& target, const BenchmarkResult& result)
+{
+	NOUS_INFO("AllocatorBenchmark [%s][%s] Allocate (ns): p50 %.0f | p99 %.0f | p99.9 %.0f | max %.0f",
+		workloadName, target.GetName(), result.allocate.p50, result.allocate.p99, result.allocate.p999, result.allocate.max);
+
+	NOUS_INFO("AllocatorBenchmark [%s][%s] Free (ns): p50 %.0f | p99 %.0f | p99.9 %.0f | max %.0f",
+		workloadName, target.GetName(), result.free.p50, result.free.p99, result.free.p999, result.free.max);
+
+	NOUS_INFO("AllocatorBenchmark [%s][%s] Failed allocations: %llu | Peak used: %llu bytes (live %llu) | Fragmentation: %.1f%%",
+		workloadName, target.GetName(), result.failures, result.peakUsedBytes, result.peakLiveBytes, result.fragmentation * 100.0f);
+
+	JSON_Value* value = json_value_init_object();
+	JSON_Object* object = json_value_get_object(value);
+
+	json_object_set_string(object, "allocator", target.GetName());
+	json_object_set_number(object, "operations", static_cast<double>(result.operations));
+	json_object_set_number(object, "totalMs", result.totalMs);
+	json_object_set_value(object, "allocateNs", LatencyToJson(result.allocate));
+	json_object_set_value(object, "freeNs", LatencyToJson(result.free));
+	json_object_set_number(object, "failedAllocations", static_cast<double>(result.failures));
+	json_object_set_number(object, "peakLiveBytes", static_cast<double>(result.peakLiveBytes));
+	json_object_set_number(object, "peakUsedBytes", static_cast<double>(result.peakUsedBytes));
+	json_object_set_number(object, "fragmentation", result.fragmentation);
+
+	json_array_append_value(results, value);
+}
+
+static JSON_Array* AddWorkloadReport(JSON_Array* workloads, const char* name, uint64 operations)
+{
+	JSON_Value* value = json_value_init_object();
+	JSON_Object* object = json_value_get_object(value);
+
+	json_object_set_string(object, "name", name);
+	json_object_set_number(object, "operations", static_cast<double>(operations));
+	json_object_set_value(object, "results", json_value_init_array());
+
+	json_array_append_value(workloads, value);
+
+	return json_object_get_array(object, "results");
+}
+
+// Runs a single-threaded workload against every allocator.
+static void BenchmarkWorkloadOnAllTargets(JSON_Array* workloads, const BenchmarkWorkload& workload)
+{
+	NOUS_INFO("AllocatorBenchmark: %s (%llu operations)", workload.name, static_cast<uint64>(workload.operations.size()));
+
+	JSON_Array* results = AddWorkloadReport(workloads, workload.name, workload.operations.size());
+
+	for (DynamicAllocatorType type : { DynamicAllocatorType::FREELIST, DynamicAllocatorType::TLSF })
+	{
+		DynamicAllocatorTarget target(type, false);
+
+		if (!target.IsValid())
+		{
+			NOUS_ERROR("AllocatorBenchmark: Failed to allocate the %s heap", target.GetName());
+			continue;
+		}
+
+		ReportResult(results, workload.name, target, RunWorkload(target, workload));
+	}
+
+	LinearAllocatorTarget linearTarget;
+
+	if (linearTarget.IsValid())
+	{
+		ReportResult(results, workload.name, linearTarget, RunWorkload(linearTarget, workload));
+		NOUS_INFO("AllocatorBenchmark [%s][LINEAR] Resets: %llu", workload.name, linearTarget.GetResetCount());
+	}
+
+	MemoryManagerTarget memoryManagerTarget;
+	ReportResult(results, workload.name, memoryManagerTarget, RunWorkload(memoryManagerTarget, workload));
+}
+
+void AllocatorBenchmark::RunBenchmarks(const char* outputPath, const char* tracePath)
+{
+	NOUS_INFO("-------------- Allocator Benchmark --------------");
+
+	JSON_Value* rootValue = json_value_init_object();
+	JSON_Object* rootObject = json_value_get_object(rootValue);
+
+	json_object_set_number(rootObject, "heapSize", static_cast<double>(c_BENCHMARK_HEAP_SIZE));
+	json_object_set_value(rootObject, "workloads", json_value_init_array());
+
+	JSON_Array* workloads = json_object_get_array(rootObject, "workloads");
+
+	BenchmarkWorkloadOnAllTargets(workloads, GenerateSmallObjectChurnWorkload());
+	BenchmarkWorkloadOnAllTargets(workloads, GenerateFragmentationWorkload());
+
+	// Cross-thread frees, only allocators that can be shared between threads take part
+	{
+		const char* name = "producer_consumer";
+
+		NOUS_INFO("AllocatorBenchmark: %s (%u operations)", name, c_BENCHMARK_OPERATIONS * 2);
+
+		JSON_Array* results = AddWorkloadReport(workloads, name, c_BENCHMARK_OPERATIONS * 2ULL);
+
+		for (DynamicAllocatorType type : { DynamicAllocatorType::FREELIST, DynamicAllocatorType::TLSF })
+		{
+			DynamicAllocatorTarget target(type, true);
+
+			if (target.IsValid())
+			{
+				ReportResult(results, name, target, RunProducerConsumer(target));
+			}
+		}
+
+		MemoryManagerTarget memoryManagerTarget;
+		ReportResult(results, name, memoryManagerTarget, RunProducerConsumer(memoryManagerTarget));
+	}
+
+	// Recorded session, replayed single-threaded in the recorded order
+	if (tracePath)
+	{
+		std::vector<AllocationTrace::Event> events;
+
+		if (AllocationTrace::Load(tracePath, events))
+		{
+			BenchmarkWorkloadOnAllTargets(workloads, GenerateTraceWorkload(events));
+		}
+	}
+
+	if (json_serialize_to_file_pretty(rootValue, outputPath) == JSONSuccess)
+	{
+		NOUS_INFO("AllocatorBenchmark: Report written to %s", outputPath);
+	}
+	else
+	{
+		NOUS_ERROR("AllocatorBenchmark: Failed to write the report to %s", outputPath);
+	}
+
+	json_value_free(rootValue);
+}
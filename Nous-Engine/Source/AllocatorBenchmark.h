@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Globals.h"
+
+namespace AllocatorBenchmark
+{
+	/// @brief Runs the synthetic workloads (small-object churn, large-block fragmentation and cross-thread
+	/// producer/consumer frees) against every allocator: DynamicAllocator (FREELIST and TLSF), LinearAllocator
+	/// and the MemoryManager. Latency percentiles, peak memory and fragmentation are logged and written as JSON.
+	/// @param outputPath: JSON report destination.
+	/// @param tracePath: Optional allocation trace (see AllocationTrace), replayed against every allocator too.
+	/// @note Run it with "--benchmark-allocators [output.json] [trace]".
+	void RunBenchmarks(const char* outputPath, const char* tracePath = nullptr);
+}
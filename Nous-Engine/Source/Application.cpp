@@ -20,6 +20,9 @@
 
 extern Application* External = nullptr;
 
+// Bytes moved by the relocatable heap compaction each frame
+static const uint64 c_RELOCATABLE_COMPACTION_BUDGET = KiB(512);
+
 Application::Application()
 {
 	External = this;
@@ -40,6 +43,12 @@ Application::Application()
 
     // ------------- MULTITHREADING ------------- //
     jobSystem = NOUS_NEW<NOUS_Multithreading::NOUS_JobSystem>(MemoryManager::MemoryTag::THREAD);
+
+    // ------------- FRAME MEMORY ------------- //
+    frameAllocator = NOUS_NEW<FrameAllocator>(MemoryManager::MemoryTag::FRAME_ALLOCATOR, MiB(4), 2);
+
+    // ------------- RELOCATABLE MEMORY ------------- //
+    relocatableHeap = NOUS_NEW<RelocatableHeap>(MemoryManager::MemoryTag::RESOURCE_MESH, GiB(4), RELOCATABLE_DEFAULT_MAX_HANDLES, MemoryManager::MemoryTag::RESOURCE_MESH);
 }
 
 Application::~Application()
@@ -71,6 +80,12 @@ Application::~Application()
 
     ModuleWindow* window = static_cast<ModuleWindow*>(listModules[0]);
     NOUS_DELETE<ModuleWindow>(window, MemoryManager::MemoryTag::APPLICATION);
+
+    // ------------- FRAME MEMORY ------------- //
+    NOUS_DELETE<FrameAllocator>(frameAllocator, MemoryManager::MemoryTag::FRAME_ALLOCATOR);
+
+    // ------------- RELOCATABLE MEMORY ------------- //
+    NOUS_DELETE<RelocatableHeap>(relocatableHeap, MemoryManager::MemoryTag::RESOURCE_MESH);
 }
 
 bool Application::Awake()
@@ -96,7 +111,7 @@ bool Application::Awake()
         }
     }
 
-    NOUS_INFO(MemoryManager::GetMemoryUsageStats());
+    NOUS_INFO("%s", MemoryManager::GetMemoryUsageStats().c_str());
 
     msTimer.Start();
 
@@ -122,6 +137,11 @@ UpdateStatus Application::PrepareUpdate()
     TimeManager::deltaTime = dt;
     TimeManager::frameCount++;
 
+    frameAllocator->BeginFrame();
+
+    // Main thread tasks queued by jobs during the previous frame
+    jobSystem->ExecuteMainThreadTasks();
+
     return ret;
 }
 
@@ -157,6 +177,9 @@ UpdateStatus Application::Update()
         }
     }
 
+    // Queue submissions requested by workers go out before the renderer begins the frame
+    jobSystem->ExecuteMainThreadTasks();
+
     NOUS_INFO("-------------- PostUpdate --------------");
 
     for (int i = 0; i < NUM_MODULES && ret == UPDATE_CONTINUE; ++i)
@@ -202,6 +225,12 @@ void Application::FinishUpdate()
 
     window->SetTitle(buffer);
 
+    jobSystem->ExecuteMainThreadTasks();
+
+    relocatableHeap->Compact(c_RELOCATABLE_COMPACTION_BUDGET);
+
+    MemoryManager::EndFrame();
+
     NOUS_DEBUG("-------------- Frame Finished --------------");
 
     // Adapt according to target FPS
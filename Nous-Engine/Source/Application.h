@@ -5,6 +5,8 @@
 #include "Timer.h"
 
 #include "NOUS_JobSystem.h"
+#include "FrameAllocator.h"
+#include "RelocatableHeap.h"
 
 constexpr uint8 NUM_MODULES = 8;
 
@@ -59,6 +61,12 @@ public:
 	// ------------- MULTITHREADING ------------- //
 	NOUS_Multithreading::NOUS_JobSystem* jobSystem;
 
+	// Scratch memory for the current frame, rewound every PrepareUpdate()
+	FrameAllocator* frameAllocator;
+
+	// Movable storage for large resource payloads, compacted a bit every FinishUpdate()
+	RelocatableHeap* relocatableHeap;
+
 private:
 
 	Module* listModules[NUM_MODULES];
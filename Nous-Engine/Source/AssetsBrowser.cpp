@@ -186,7 +186,7 @@ void AssetsBrowser::Draw()
                             std::system("compile-shaders.bat");
 
                             External->fileSystem->ImportDirectory("Assets");
-                        }, "Regenerate Library");
+                        }, "Regenerate Library", NOUS_Multithreading::NOUS_JobPriority::BACKGROUND);
                 }
 
                 if (ImGui::MenuItem("Add 10000 items"))
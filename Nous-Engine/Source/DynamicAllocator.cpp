@@ -3,40 +3,72 @@
 #include "MemoryManager.h"
 #include "Logger.h"
 
- uint64 DynamicAllocator::GetMemoryRequirement(uint64 totalSize)
+// User memory is padded so every engine hands out 16-byte aligned blocks.
+static const uint64 c_USER_MEMORY_ALIGNMENT = 16;
+
+uint64 DynamicAllocator::GetMemoryRequirement(uint64 totalSize, DynamicAllocatorType type)
+{
+    return GetControlRequirement(totalSize, type) + totalSize;
+}
+
+uint64 DynamicAllocator::GetControlRequirement(uint64 maxSize, DynamicAllocatorType type)
 {
-    const uint64 freelistReq = Freelist::GetMemoryRequirement(totalSize);
-    return sizeof(InternalState) + freelistReq + totalSize;
+    return sizeof(InternalState) + GetEngineRequirement(maxSize, type) + c_USER_MEMORY_ALIGNMENT;
 }
 
-DynamicAllocator::DynamicAllocator(uint64 totalSize, void* memory) {
+DynamicAllocator::DynamicAllocator(uint64 totalSize, void* memory, DynamicAllocatorType type, uint64 maxSize) {
     state_ = static_cast<InternalState*>(memory);
     new (state_) InternalState();
 
     state_->totalSize = totalSize;
+    state_->maxSize = std::max(totalSize, maxSize);
+    state_->type = type;
 
     char* memPtr = static_cast<char*>(memory);
 
-    // Calculate freelist requirement
-    const uint64 freelistReq = Freelist::GetMemoryRequirement(totalSize);
+    // Engine structures are sized for the maximum size so growing never moves them
+    const uint64 engineReq = GetEngineRequirement(state_->maxSize, type);
 
     // Memory layout correction
-    state_->freelistMemory = memPtr + sizeof(InternalState);
-    state_->userMemory = memPtr + sizeof(InternalState) + freelistReq;
-
-    // Initialize freelist in pre-allocated space
-    state_->freelist = new (&state_->freelistMemory) Freelist(
-        totalSize,
-        state_->freelistMemory
-    );
+    const uintptr_t userMemory = reinterpret_cast<uintptr_t>(memPtr + sizeof(InternalState) + engineReq);
+
+    state_->engineMemory = memPtr + sizeof(InternalState);
+    state_->userMemory = reinterpret_cast<void*>((userMemory + (c_USER_MEMORY_ALIGNMENT - 1)) & ~(c_USER_MEMORY_ALIGNMENT - 1));
+
+    // Initialize engine in pre-allocated space
+    switch (type)
+    {
+    case DynamicAllocatorType::FREELIST:
+
+        state_->freelist = new (&state_->engineMemory) Freelist(
+            totalSize,
+            state_->engineMemory,
+            state_->maxSize
+        );
+
+        break;
+
+    case DynamicAllocatorType::TLSF:
+
+        state_->tlsf = new (&state_->engineMemory) TLSFAllocator(
+            totalSize,
+            state_->engineMemory,
+            state_->userMemory
+        );
+
+        break;
+    }
 }
 
 DynamicAllocator::~DynamicAllocator()
 {
     if (state_)
     {
-        state_->freelist->~Freelist();
-        MemoryManager::ZeroMemory(state_, GetMemoryRequirement(state_->totalSize));
+        if (state_->freelist) state_->freelist->~Freelist();
+        if (state_->tlsf) state_->tlsf->~TLSFAllocator();
+
+        // User memory is left untouched, it may not even be accessible
+        MemoryManager::ZeroMemory(state_, sizeof(InternalState));
     }
 }
 
@@ -46,14 +78,20 @@ void* DynamicAllocator::Allocate(uint64 size)
 
     uint64 offset;
 
-    if (state_->freelist->Allocate(size, &offset)) 
+    const bool allocated = (state_->type == DynamicAllocatorType::TLSF) ?
+        state_->tlsf->Allocate(size, &offset) :
+        state_->freelist->Allocate(size, &offset);
+
+    if (allocated) 
     {
         return static_cast<char*>(state_->userMemory) + offset;
     }
 
-    // Handle allocation failure
+    // The owner is expected to Grow() and retry while there's room left
+    if (state_->totalSize < state_->maxSize) return nullptr;
+
+    // Out of memory, the caller decides how to degrade (the MemoryManager fails the request and raises memory pressure)
     NOUS_ERROR("DynamicAllocator::Allocate() failed. Requested: %llu bytes, Available: %llu bytes", size, GetFreeSpace());
-    NOUS_ASSERT_MSG(size < GetFreeSpace(), "Memory Manager has been initialized with insufficient memory.");
 
     return nullptr;
 }
@@ -74,10 +112,69 @@ bool DynamicAllocator::Free(void* block, uint64 size)
     }
 
     const uint64 offset = blockPtr - userMemStart;
-    return state_->freelist->Free(size, offset);
+
+    return (state_->type == DynamicAllocatorType::TLSF) ?
+        state_->tlsf->Free(size, offset) :
+        state_->freelist->Free(size, offset);
 }
 
 uint64 DynamicAllocator::GetFreeSpace() const
 {
-    return state_ ? state_->freelist->FreeSpace() : 0;
+    if (!state_) return 0;
+
+    return (state_->type == DynamicAllocatorType::TLSF) ? state_->tlsf->FreeSpace() : state_->freelist->FreeSpace();
+}
+
+uint64 DynamicAllocator::GetLargestFreeBlock() const
+{
+    if (!state_) return 0;
+
+    return (state_->type == DynamicAllocatorType::TLSF) ? state_->tlsf->LargestFreeBlock() : state_->freelist->LargestFreeBlock();
+}
+
+bool DynamicAllocator::Grow(uint64 newTotalSize)
+{
+    if (!state_ || newTotalSize <= state_->totalSize) return false;
+
+    if (newTotalSize > state_->maxSize)
+    {
+        NOUS_ERROR("DynamicAllocator::Grow() failed. Requested: %llu bytes, Maximum: %llu bytes", newTotalSize, state_->maxSize);
+        return false;
+    }
+
+    const bool grown = (state_->type == DynamicAllocatorType::TLSF) ?
+        state_->tlsf->Grow(newTotalSize) :
+        state_->freelist->Grow(newTotalSize);
+
+    if (grown)
+    {
+        state_->totalSize = newTotalSize;
+    }
+
+    return grown;
+}
+
+uint64 DynamicAllocator::GetTotalSize() const
+{
+    return state_ ? state_->totalSize : 0;
+}
+
+uint64 DynamicAllocator::GetMaxSize() const
+{
+    return state_ ? state_->maxSize : 0;
+}
+
+DynamicAllocatorType DynamicAllocator::GetType() const
+{
+    return state_ ? state_->type : DynamicAllocatorType::TLSF;
+}
+
+uint64 DynamicAllocator::GetEngineRequirement(uint64 totalSize, DynamicAllocatorType type)
+{
+    switch (type)
+    {
+        case DynamicAllocatorType::FREELIST:    return Freelist::GetMemoryRequirement(totalSize);
+        case DynamicAllocatorType::TLSF:        return TLSFAllocator::GetMemoryRequirement(totalSize);
+        default:                                return 0;
+    }
 }
@@ -1,20 +1,42 @@
 #pragma once
 
 #include "FreeList.h"
+#include "TLSFAllocator.h"
+
+// Engine used by the DynamicAllocator to track its free space.
+enum class DynamicAllocatorType
+{
+    FREELIST,   // Best-fit range tree (logarithmic time)
+    TLSF        // Two-level segregated fit (constant time)
+};
 
 class DynamicAllocator
 {
 public:
 
-    static uint64 GetMemoryRequirement(uint64 totalSize);
+    static uint64 GetMemoryRequirement(uint64 totalSize, DynamicAllocatorType type = DynamicAllocatorType::TLSF);
 
-    DynamicAllocator(uint64 totalSize, void* memory);
+    /// @param totalSize: Usable size on creation.
+    /// @param memory: Block of GetMemoryRequirement(maxSize) bytes. Only the control structures and the first
+    /// totalSize bytes of user memory have to be accessible, the rest can stay reserved until Grow().
+    /// @param maxSize: Size the allocator may reach through Grow(), defaults to totalSize.
+    DynamicAllocator(uint64 totalSize, void* memory, DynamicAllocatorType type = DynamicAllocatorType::TLSF, uint64 maxSize = 0);
     ~DynamicAllocator();
 
     void* Allocate(uint64 size);
     bool Free(void* block, uint64 size);
 
+    /// @brief Makes more user memory available, the caller must have made it accessible first.
+    bool Grow(uint64 newTotalSize);
+
     uint64 GetFreeSpace() const;
+    uint64 GetLargestFreeBlock() const;
+    uint64 GetTotalSize() const;
+    uint64 GetMaxSize() const;
+
+    /// @return Bytes from the start of the block to the user memory for an allocator created with maxSize.
+    static uint64 GetControlRequirement(uint64 maxSize, DynamicAllocatorType type = DynamicAllocatorType::TLSF);
+    DynamicAllocatorType GetType() const;
 
     // Non-copyable
     DynamicAllocator(const DynamicAllocator&) = delete;
@@ -25,16 +47,24 @@ private:
     struct InternalState 
     {
         uint64 totalSize;
-        void* freelistMemory;
+        uint64 maxSize;
+        DynamicAllocatorType type;
+        void* engineMemory;
         void* userMemory;
         Freelist* freelist;
+        TLSFAllocator* tlsf;
 
         InternalState() :
             totalSize(0),
-            freelistMemory(nullptr),
+            maxSize(0),
+            type(DynamicAllocatorType::TLSF),
+            engineMemory(nullptr),
             userMemory(nullptr),
-            freelist(nullptr) {}
+            freelist(nullptr),
+            tlsf(nullptr) {}
     };
 
+    static uint64 GetEngineRequirement(uint64 totalSize, DynamicAllocatorType type);
+
     InternalState* state_ = nullptr;
-};
\ No newline at end of file
+};
@@ -3,14 +3,26 @@
 #include "Globals.h"
 #include "MemoryManager.h"
 #include "Asserts.h"
-#include <string>
 
-#define DARRAY_DEFAULT_CAPACITY 1
+#include <string>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <initializer_list>
+
+#define DARRAY_DEFAULT_CAPACITY 0	// Nothing is allocated until the first element is added
+#define DARRAY_MIN_CAPACITY 8		// Capacity of the first allocation
 #define DARRAY_RESIZE_FACTOR 2
 #define DARRAY_FIELD_LENGTH 3
 
+// Growable array of T backed by the MemoryManager (DARRAY tag).
+// Only the first GetLength() slots hold constructed elements, the rest of the capacity is raw memory.
+// Trivially copyable types are relocated and bulk inserted with memcpy, other types are moved element by element.
+
 template<typename T>
-class DynamicArray 
+class DynamicArray
 {
 public:
 
@@ -21,6 +33,10 @@ public:
 
 	// Constructor from other Dynamic Array
 	DynamicArray(const DynamicArray<T>& other);
+	DynamicArray(DynamicArray<T>&& other) noexcept;
+
+	DynamicArray<T>& operator=(const DynamicArray<T>& other);
+	DynamicArray<T>& operator=(DynamicArray<T>&& other) noexcept;
 
 	~DynamicArray();
 
@@ -28,77 +44,136 @@ public:
 
 	void Push(const T* valuePtr);
 	void Push(const T& value);
-	void InsertAt(uint64 index, T* valuePtr);
+	void Push(T&& value);
+
+	// Constructs the new element in place, returns a reference to it.
+	template<typename... Args>
+	T& Emplace(Args&&... args);
+
+	// Appends count elements in a single copy.
+	void PushRange(const T* values, uint64 count);
+
+	void InsertAt(uint64 index, const T& value);
+	void InsertAt(uint64 index, T&& value);
 
-	T* Pop();
-	T* PopAt(uint64 index);
+	// Removes the last element, moving it into outValue when given. Returns false if the array is empty.
+	bool Pop(T* outValue = nullptr);
+	// Removes the element at index keeping the order, moving it into outValue when given.
+	bool PopAt(uint64 index, T* outValue = nullptr);
 
+	// Destroys every element, the capacity is kept.
 	void Clear();
 
-	bool IsEmpty();
+	bool IsEmpty() const;
 	bool Contains(const T& value) const;
 	bool Remove(const T& value);
 
 	void CopyFrom(const DynamicArray<T>& other);
 
+	// Makes room for at least newCapacity elements, never shrinks.
+	void Reserve(uint64 newCapacity);
 	void SetCapacity(uint64 newCapacity);
+	// Value-initializes new elements when growing, destroys the trailing ones when shrinking.
 	void SetLength(uint64 newLength);
-	void SetStride(uint64 newStride);
 
 	uint64 GetCapacity() const;
 	uint64 GetLength() const;
 	uint64 GetStride() const;
 	T* GetElements() const;
 
-	// Overload operator[] (read only)
+	T& operator[](size_t index);
 	const T& operator[](size_t index) const;
 
+	// Iterators, allow range-based for loops
+	T* begin();
+	T* end();
+	const T* begin() const;
+	const T* end() const;
+
 private:
 
-	void Create(uint64 capacity, uint64 stride);
-	void Resize();
+	static constexpr bool c_TRIVIAL = std::is_trivially_copyable_v<T>;
+
+	static T* AllocateElements(uint64 count);
+	static void FreeElements(T* elements, uint64 count);
+
+	// Moves the live elements from source to the raw memory at destination.
+	static void Relocate(T* destination, T* source, uint64 count);
+
+	uint64 GetGrowCapacity(uint64 minCapacity) const;
+	void Reallocate(uint64 newCapacity);
 	void Destroy();
 
 	// ----------------------- \\
 
 	uint64 capacity;
 	uint64 length;
-	uint64 stride;
 
 	T* elements;
 };
 
 template<typename T>
 inline DynamicArray<T>::DynamicArray(uint64 capacity)
-	: capacity(capacity), length(0), stride(sizeof(T)), elements(nullptr)
+	: capacity(0), length(0), elements(nullptr)
 {
-	Create(capacity, stride);
+	Create(capacity);
 }
 
 // Constructor from other Dynamic Array
 template<typename T>
 inline DynamicArray<T>::DynamicArray(const DynamicArray<T>& other)
-	: capacity(other.capacity), length(other.length), stride(other.stride), elements(nullptr)
+	: capacity(0), length(0), elements(nullptr)
 {
-	Create(capacity, stride);
+	Create(other.length);
+	PushRange(other.elements, other.length);
+}
 
-	for (int i = 0; i < other.length; ++i)
-	{
-		Push(other[i]);
-	}
+template<typename T>
+inline DynamicArray<T>::DynamicArray(DynamicArray<T>&& other) noexcept
+	: capacity(other.capacity), length(other.length), elements(other.elements)
+{
+	other.capacity = 0;
+	other.length = 0;
+	other.elements = nullptr;
 }
 
 // Constructor for initializer list
 template<typename T>
 inline DynamicArray<T>::DynamicArray(std::initializer_list<T> init, uint64 capacity)
-	: capacity(capacity), length(0), stride(sizeof(T)), elements(nullptr)
+	: capacity(0), length(0), elements(nullptr)
 {
-	Create(capacity, stride);
+	Create(std::max<uint64>(capacity, init.size()));
+	PushRange(init.begin(), init.size());
+}
 
-	for (const T& item : init) 
+template<typename T>
+inline DynamicArray<T>& DynamicArray<T>::operator=(const DynamicArray<T>& other)
+{
+	if (this != &other)
 	{
-		Push(item);
+		CopyFrom(other);
 	}
+
+	return *this;
+}
+
+template<typename T>
+inline DynamicArray<T>& DynamicArray<T>::operator=(DynamicArray<T>&& other) noexcept
+{
+	if (this != &other)
+	{
+		Destroy();
+
+		capacity = other.capacity;
+		length = other.length;
+		elements = other.elements;
+
+		other.capacity = 0;
+		other.length = 0;
+		other.elements = nullptr;
+	}
+
+	return *this;
 }
 
 template<typename T>
@@ -108,179 +183,253 @@ inline DynamicArray<T>::~DynamicArray()
 }
 
 template<typename T>
-inline void DynamicArray<T>::Push(const T* valuePtr)
+inline void DynamicArray<T>::Create(uint64 capacity)
 {
-	// Resize if necessary
-	if (length >= capacity) {
-		Resize();
-	}
+	Destroy();
 
-	// Copy the value to the next available element
-	MemoryManager::CopyMemory(&elements[length], valuePtr, sizeof(T));
+	if (capacity > 0)
+	{
+		elements = AllocateElements(capacity);
+		this->capacity = capacity;
+	}
+}
 
-	// Increase the length
-	length++;
+template<typename T>
+inline void DynamicArray<T>::Push(const T* valuePtr)
+{
+	Emplace(*valuePtr);
 }
 
 template<typename T>
 inline void DynamicArray<T>::Push(const T& value)
 {
-	// Resize if necessary
-	if (length >= capacity) {
-		Resize();
-	}
-
-	// Copy the value to the next available element
-	MemoryManager::CopyMemory(&elements[length], &value, sizeof(T));
+	Emplace(value);
+}
 
-	// Increase the length
-	length++;
+template<typename T>
+inline void DynamicArray<T>::Push(T&& value)
+{
+	Emplace(std::move(value));
 }
 
 template<typename T>
-inline void DynamicArray<T>::Resize()
+template<typename... Args>
+inline T& DynamicArray<T>::Emplace(Args&&... args)
 {
-	// Calculate the new capacity
-	uint64 newCapacity = capacity * DARRAY_RESIZE_FACTOR;
+	// The length only grows once the element exists, a throwing constructor leaves the array as it was
+	if (length < capacity)
+	{
+		T* element = new(&elements[length]) T(std::forward<Args>(args)...);
+		length++;
 
-	// Allocate a new array with increased capacity
-	T* newElements = NOUS_NEW_ARRAY<T>(newCapacity, MemoryManager::MemoryTag::DARRAY);
+		return *element;
+	}
 
-	// Copy existing elements to the new array
-	MemoryManager::CopyMemory(newElements, elements, length * stride);
-	
-	// Free the old array
-	NOUS_DELETE_ARRAY(elements, capacity, MemoryManager::MemoryTag::DARRAY);
+	// Construct the new element before moving the old ones, args may reference an element of this array
+	const uint64 newCapacity = GetGrowCapacity(length + 1);
+	T* newElements = AllocateElements(newCapacity);
+
+	try
+	{
+		new(&newElements[length]) T(std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		FreeElements(newElements, newCapacity);
+		throw;
+	}
+
+	Relocate(newElements, elements, length);
+	FreeElements(elements, capacity);
 
-	// Update the internal state
 	elements = newElements;
 	capacity = newCapacity;
-}
 
-template<typename T>
-inline void DynamicArray<T>::Create(uint64 capacity)
-{
-	Create(capacity, sizeof(T));
+	return elements[length++];
 }
 
 template<typename T>
-inline void DynamicArray<T>::Create(uint64 capacity, uint64 stride)
+inline void DynamicArray<T>::PushRange(const T* values, uint64 count)
 {
-	this->capacity = capacity;
-	this->length = 0;
-	this->stride = stride;
+	if (count == 0) return;
 
-	elements = NOUS_NEW_ARRAY<T>(capacity, MemoryManager::MemoryTag::DARRAY);
-	MemoryManager::SetMemory(elements, 0, capacity * stride);
-}
+	NOUS_ASSERT_MSG(values < elements || values >= elements + capacity, "DynamicArray::PushRange() - Source range overlaps the array.");
 
-template<typename T>
-inline void DynamicArray<T>::Destroy()
-{
-	if (elements) 
+	Reserve(GetGrowCapacity(length + count));
+
+	if constexpr (c_TRIVIAL)
+	{
+		MemoryManager::CopyMemory(&elements[length], values, count * sizeof(T));
+	}
+	else
 	{
-		NOUS_DELETE_ARRAY(elements, capacity, MemoryManager::MemoryTag::DARRAY);
-		elements = nullptr;
+		std::uninitialized_copy(values, values + count, &elements[length]);
 	}
 
-	length = 0;
-	capacity = 0;
-	stride = 0;
+	length += count;
 }
 
 template<typename T>
-inline const T& DynamicArray<T>::operator[](size_t index) const
+inline void DynamicArray<T>::InsertAt(uint64 index, const T& value)
 {
-	return elements[index];
+	// Copy first, value may be an element that is about to be shifted
+	InsertAt(index, T(value));
 }
 
 template<typename T>
-inline void DynamicArray<T>::InsertAt(uint64 index, T* valuePtr)
+inline void DynamicArray<T>::InsertAt(uint64 index, T&& value)
 {
 	if (index > length) return;  // Index out of bounds
 
-	if (length >= capacity) {
-		Resize();
+	if (index == length)
+	{
+		Emplace(std::move(value));
+		return;
 	}
 
-	// Shift elements to the right
-	for (uint64 i = length; i > index; --i) {
-		MemoryManager::CopyMemory(&elements[i], &elements[i - 1], sizeof(T));
+	if (length >= capacity)
+	{
+		Reallocate(GetGrowCapacity(length + 1));
 	}
 
-	// Insert the new value
-	MemoryManager::CopyMemory(&elements[index], valuePtr, sizeof(T));
+	// Shift elements to the right
+	if constexpr (c_TRIVIAL)
+	{
+		std::memmove(&elements[index + 1], &elements[index], (length - index) * sizeof(T));
+		new(&elements[index]) T(std::move(value));
+	}
+	else
+	{
+		new(&elements[length]) T(std::move(elements[length - 1]));
+		std::move_backward(&elements[index], &elements[length - 1], &elements[length]);
+		elements[index] = std::move(value);
+	}
 
 	// Update length
 	length++;
 }
 
 template<typename T>
-inline T* DynamicArray<T>::Pop()
+inline bool DynamicArray<T>::Pop(T* outValue)
 {
-	if (length > 0) {
-		length--;
-		return &elements[length];  // Return a pointer to the popped element
+	if (length == 0) return false;  // Nothing to pop
+
+	length--;
+
+	if (outValue)
+	{
+		*outValue = std::move(elements[length]);
 	}
-	return nullptr;  // Return nullptr if the array is empty
+
+	std::destroy_at(&elements[length]);
+
+	return true;
 }
 
 template<typename T>
-inline T* DynamicArray<T>::PopAt(uint64 index)
+inline bool DynamicArray<T>::PopAt(uint64 index, T* outValue)
 {
-	if (index >= length) return nullptr;  // Index out of bounds
+	if (index >= length) return false;  // Index out of bounds
 
-	// Allocate memory for the value to be popped
-	T* poppedValue = NOUS_NEW<T>(MemoryManager::MemoryTag::DARRAY);
-	MemoryManager::CopyMemory(poppedValue, &elements[index], sizeof(T));  // Copy the value before shifting
+	if (outValue)
+	{
+		*outValue = std::move(elements[index]);
+	}
 
 	// Shift elements to the left
-	for (uint64 i = index; i < length - 1; ++i) {
-		MemoryManager::CopyMemory(&elements[i], &elements[i + 1], sizeof(T));
+	if constexpr (c_TRIVIAL)
+	{
+		std::memmove(&elements[index], &elements[index + 1], (length - index - 1) * sizeof(T));
+	}
+	else
+	{
+		std::move(&elements[index + 1], &elements[length], &elements[index]);
+		std::destroy_at(&elements[length - 1]);
 	}
 
 	length--;  // Update length
-	return poppedValue;  // Return a pointer to the copied (popped) value
+	return true;
 }
 
 template<typename T>
-inline void DynamicArray<T>::SetCapacity(uint64 newCapacity)
+inline void DynamicArray<T>::Clear()
 {
-	// If the new capacity is less than or equal to current capacity, do nothing
-	if (newCapacity <= capacity) return;
+	std::destroy_n(elements, length);
+	length = 0;
+}
 
-	// Allocate a new array with the requested capacity
-	T* newElements = NOUS_NEW_ARRAY<T>(newCapacity, MemoryManager::MemoryTag::DARRAY);
+template<typename T>
+inline bool DynamicArray<T>::IsEmpty() const
+{
+	return length == 0;
+}
 
-	// Copy existing elements to the new array
-	if (elements) {
-		MemoryManager::CopyMemory(newElements, elements, length * stride);
-		// Free the old array
-		NOUS_DELETE_ARRAY(elements, capacity, MemoryManager::MemoryTag::DARRAY);
+template<typename T>
+inline bool DynamicArray<T>::Contains(const T& value) const
+{
+	for (uint64 i = 0; i < length; ++i)
+	{
+		if (elements[i] == value)
+		{
+			return true;
+		}
 	}
+	return false;
+}
 
-	// Update the internal state
-	elements = newElements;
-	capacity = newCapacity;
+template<typename T>
+inline bool DynamicArray<T>::Remove(const T& value)
+{
+	for (uint64 i = 0; i < length; ++i)
+	{
+		if (elements[i] == value)
+		{
+			return PopAt(i);
+		}
+	}
+	return false;
 }
 
 template<typename T>
-inline void DynamicArray<T>::SetLength(uint64 newLength)
+void DynamicArray<T>::CopyFrom(const DynamicArray<T>& other)
+{
+	if (this == &other) return;
+
+	Clear();  // Clear the current array before copying
+	Reserve(other.length);
+	PushRange(other.elements, other.length);
+}
+
+template<typename T>
+inline void DynamicArray<T>::Reserve(uint64 newCapacity)
 {
-	// Ensure the new length does not exceed the current capacity
-	if (newLength > capacity) {
-		// Optionally resize if necessary
-		SetCapacity(newLength);
+	if (newCapacity > capacity)
+	{
+		Reallocate(newCapacity);
 	}
+}
 
-	// Update the length
-	length = newLength;
+template<typename T>
+inline void DynamicArray<T>::SetCapacity(uint64 newCapacity)
+{
+	Reserve(newCapacity);
 }
 
 template<typename T>
-inline void DynamicArray<T>::SetStride(uint64 newStride)
+inline void DynamicArray<T>::SetLength(uint64 newLength)
 {
-	this->stride = newStride;
+	if (newLength < length)
+	{
+		std::destroy(&elements[newLength], &elements[length]);
+	}
+	else if (newLength > length)
+	{
+		Reserve(newLength);
+		std::uninitialized_value_construct(&elements[length], &elements[newLength]);
+	}
+
+	// Update the length
+	length = newLength;
 }
 
 template<typename T>
@@ -298,7 +447,7 @@ inline uint64 DynamicArray<T>::GetLength() const
 template<typename T>
 inline uint64 DynamicArray<T>::GetStride() const
 {
-	return stride;
+	return sizeof(T);
 }
 
 template<typename T>
@@ -308,56 +457,101 @@ inline T* DynamicArray<T>::GetElements() const
 }
 
 template<typename T>
-inline void DynamicArray<T>::Clear()
+inline T& DynamicArray<T>::operator[](size_t index)
 {
-	length = 0;
+	return elements[index];
 }
 
 template<typename T>
-inline bool DynamicArray<T>::IsEmpty()
+inline const T& DynamicArray<T>::operator[](size_t index) const
 {
-	return length == 0;
+	return elements[index];
 }
 
 template<typename T>
-inline bool DynamicArray<T>::Contains(const T& value) const
+inline T* DynamicArray<T>::begin()
+{
+	return elements;
+}
+
+template<typename T>
+inline T* DynamicArray<T>::end()
+{
+	return elements + length;
+}
+
+template<typename T>
+inline const T* DynamicArray<T>::begin() const
+{
+	return elements;
+}
+
+template<typename T>
+inline const T* DynamicArray<T>::end() const
 {
-	for (uint64 i = 0; i < length; ++i) 
+	return elements + length;
+}
+
+template<typename T>
+inline T* DynamicArray<T>::AllocateElements(uint64 count)
+{
+	// Raw storage, elements are constructed as they are added
+	return static_cast<T*>(MemoryManager::AllocateAligned(count * sizeof(T), alignof(T),
+		MemoryManager::MemoryTag::DARRAY, MemoryManager::AllocationFlags::UNINITIALIZED));
+}
+
+template<typename T>
+inline void DynamicArray<T>::FreeElements(T* elements, uint64 count)
+{
+	if (elements)
 	{
-		if (elements[i] == value) 
-		{
-			return true;
-		}
+		MemoryManager::FreeAligned(elements, count * sizeof(T), alignof(T), MemoryManager::MemoryTag::DARRAY);
 	}
-	return false;
 }
 
 template<typename T>
-inline bool DynamicArray<T>::Remove(const T& value)
+inline void DynamicArray<T>::Relocate(T* destination, T* source, uint64 count)
 {
-	for (uint64 i = 0; i < length; ++i) 
+	if (count == 0) return;
+
+	if constexpr (c_TRIVIAL)
 	{
-		if (elements[i] == value) 
-		{  
-			NOUS_DELETE(PopAt(i), MemoryManager::MemoryTag::DARRAY);
-			return true;  
-		}
+		MemoryManager::CopyMemory(destination, source, count * sizeof(T));
+	}
+	else
+	{
+		std::uninitialized_move_n(source, count, destination);
+		std::destroy_n(source, count);
 	}
-	return false;
 }
 
 template<typename T>
-void DynamicArray<T>::CopyFrom(const DynamicArray<T>& other) 
+inline uint64 DynamicArray<T>::GetGrowCapacity(uint64 minCapacity) const
 {
-	Clear();  // Clear the current array before copying
+	if (minCapacity <= capacity) return capacity;
 
-	// Ensure the current array has enough capacity
-	if (capacity < other.length) {
-		SetCapacity(other.length);  // Resize if necessary
-	}
+	// Geometric growth keeps repeated pushes amortized O(1)
+	return std::max(std::max<uint64>(capacity * DARRAY_RESIZE_FACTOR, DARRAY_MIN_CAPACITY), minCapacity);
+}
 
-	// Copy each element from the other array
-	for (uint64 i = 0; i < other.length; ++i) {
-		Push(other[i]);  // Use Push to insert elements into this array
-	}
-}
\ No newline at end of file
+template<typename T>
+inline void DynamicArray<T>::Reallocate(uint64 newCapacity)
+{
+	T* newElements = AllocateElements(newCapacity);
+
+	Relocate(newElements, elements, length);
+	FreeElements(elements, capacity);
+
+	elements = newElements;
+	capacity = newCapacity;
+}
+
+template<typename T>
+inline void DynamicArray<T>::Destroy()
+{
+	Clear();
+	FreeElements(elements, capacity);
+
+	elements = nullptr;
+	capacity = 0;
+}
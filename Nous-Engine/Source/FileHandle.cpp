@@ -153,8 +153,8 @@ bool FileHandle::ReadAllBytes(char** outBytes, uint64* outBytesRead)
         return false;
     }
 
-    // Allocate memory for the file content
-    *outBytes = NOUS_NEW_ARRAY<char>(static_cast<uint64>(fileSize), MemoryManager::MemoryTag::FILE);
+    // Allocate memory for the file content, it's fully overwritten by the read
+    *outBytes = NOUS_NEW_ARRAY_UNINIT<char>(static_cast<uint64>(fileSize), MemoryManager::MemoryTag::FILE);
 
     if (!(*outBytes))
     {
@@ -0,0 +1,83 @@
+#include "FrameAllocator.h"
+
+#include "MemoryManager.h"
+
+FrameAllocator::FrameAllocator(uint64 capacityPerFrame, uint32 frameCount)
+    : memory(nullptr), capacityPerFrame(0), frameCount(0), currentFrame(0), frameIndex(0), peakSize(0)
+{
+    NOUS_ASSERT_MSG(frameCount > 0 && frameCount <= FRAME_ALLOCATOR_MAX_FRAMES, "FrameAllocator - Invalid frame count.");
+
+    // Keep every frame buffer on its own cache lines
+    this->capacityPerFrame = (capacityPerFrame + (MemoryManager::c_CACHE_LINE_SIZE - 1)) & ~(MemoryManager::c_CACHE_LINE_SIZE - 1);
+    this->frameCount = frameCount;
+
+    memory = MemoryManager::AllocateAligned(this->capacityPerFrame * frameCount, MemoryManager::c_CACHE_LINE_SIZE, MemoryManager::MemoryTag::FRAME_ALLOCATOR);
+
+    if (memory == nullptr)
+    {
+        NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__);
+        throw std::bad_alloc(); // Handle allocation failure
+    }
+
+    for (uint32 i = 0; i < frameCount; ++i)
+    {
+        frames[i].Create(this->capacityPerFrame, static_cast<uint8*>(memory) + i * this->capacityPerFrame);
+    }
+}
+
+FrameAllocator::~FrameAllocator()
+{
+    if (memory)
+    {
+        MemoryManager::FreeAligned(memory, capacityPerFrame * frameCount, MemoryManager::c_CACHE_LINE_SIZE, MemoryManager::MemoryTag::FRAME_ALLOCATOR);
+        memory = nullptr;
+    }
+}
+
+void FrameAllocator::BeginFrame()
+{
+    peakSize = std::max(peakSize, frames[currentFrame].GetAllocatedSize());
+
+    currentFrame = (currentFrame + 1) % frameCount;
+    frames[currentFrame].Reset();
+
+    frameIndex++;
+}
+
+void* FrameAllocator::Allocate(uint64 size, uint64 alignment)
+{
+    return frames[currentFrame].Allocate(size, alignment);
+}
+
+FrameAllocator::Marker FrameAllocator::GetMarker() const
+{
+    return frames[currentFrame].GetMarker();
+}
+
+void FrameAllocator::FreeToMarker(Marker marker)
+{
+    // Track the peak before rewinding, scoped allocations would otherwise never show up
+    peakSize = std::max(peakSize, frames[currentFrame].GetAllocatedSize());
+
+    frames[currentFrame].FreeToMarker(marker);
+}
+
+uint64 FrameAllocator::GetFrameIndex() const
+{
+    return frameIndex;
+}
+
+uint64 FrameAllocator::GetCapacityPerFrame() const
+{
+    return capacityPerFrame;
+}
+
+uint64 FrameAllocator::GetAllocatedSize() const
+{
+    return frames[currentFrame].GetAllocatedSize();
+}
+
+uint64 FrameAllocator::GetPeakSize() const
+{
+    return peakSize;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Globals.h"
+#include "LinearAllocator.h"
+
+#include <type_traits>
+
+#define FRAME_ALLOCATOR_MAX_FRAMES 4
+
+// Per-frame scratch memory built on LinearAllocator.
+// Each frame gets its own linear buffer, BeginFrame() moves to the next buffer and rewinds it, so
+// anything allocated during a frame stays valid for (frameCount - 1) more frames (e.g. while the GPU
+// or a late job still reads it) and is released all at once without individual frees.
+// Destructors are never run, only trivially destructible types can be created through New().
+// Not thread-safe: meant to be used from the main thread (modules update and render packet building).
+
+class FrameAllocator
+{
+public:
+
+    using Marker = uint64;
+
+    // Frees everything allocated inside its scope when it goes out of scope.
+    class ScopedMarker
+    {
+    public:
+
+        explicit ScopedMarker(FrameAllocator& allocator) : allocator(allocator), marker(allocator.GetMarker()) {}
+        ~ScopedMarker() { allocator.FreeToMarker(marker); }
+
+        ScopedMarker(const ScopedMarker&) = delete;
+        ScopedMarker& operator=(const ScopedMarker&) = delete;
+
+    private:
+
+        FrameAllocator& allocator;
+        Marker marker;
+    };
+
+    FrameAllocator(uint64 capacityPerFrame, uint32 frameCount = 2);
+    ~FrameAllocator();
+
+    // Advances to the next frame buffer and rewinds it. Called once per frame by the Application.
+    void BeginFrame();
+
+    void* Allocate(uint64 size, uint64 alignment = 16);
+
+    // Default-constructs count elements of T, returns nullptr if the frame buffer is exhausted.
+    template<typename T>
+    T* AllocateArray(uint64 count);
+
+    template<typename T, typename... Args>
+    T* New(Args&&... args);
+
+    Marker GetMarker() const;
+    void FreeToMarker(Marker marker);
+
+    uint64 GetFrameIndex() const;
+    uint64 GetCapacityPerFrame() const;
+    uint64 GetAllocatedSize() const;
+    uint64 GetPeakSize() const;
+
+    // Disable copy/move to prevent accidental misuse
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+    FrameAllocator(FrameAllocator&&) = delete;
+    FrameAllocator& operator=(FrameAllocator&&) = delete;
+
+private:
+
+    LinearAllocator frames[FRAME_ALLOCATOR_MAX_FRAMES];
+
+    void* memory;
+    uint64 capacityPerFrame;
+    uint32 frameCount;
+    uint32 currentFrame;
+
+    uint64 frameIndex;
+    uint64 peakSize;
+};
+
+template<typename T>
+inline T* FrameAllocator::AllocateArray(uint64 count)
+{
+    static_assert(std::is_trivially_destructible_v<T>, "FrameAllocator never runs destructors.");
+
+    T* block = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+
+    if (block)
+    {
+        for (uint64 i = 0; i < count; ++i)
+        {
+            new(block + i) T();
+        }
+    }
+
+    return block;
+}
+
+template<typename T, typename... Args>
+inline T* FrameAllocator::New(Args&&... args)
+{
+    static_assert(std::is_trivially_destructible_v<T>, "FrameAllocator never runs destructors.");
+
+    void* block = Allocate(sizeof(T), alignof(T));
+
+    return block ? new(block) T(std::forward<Args>(args)...) : nullptr;
+}
@@ -3,199 +3,353 @@
 #include "MemoryManager.h"
 #include "Logger.h"
 
-uint64 Freelist::GetMemoryRequirement(uint64 totalSize) 
+// ----------------------------------------------------------------------- //
+// Treap helpers, shared by the offset-ordered and the size-ordered trees.
+// ----------------------------------------------------------------------- //
+
+struct OffsetOrder
+{
+    static Freelist::Node*& Left(Freelist::Node* node) { return node->offsetLeft; }
+    static Freelist::Node*& Right(Freelist::Node* node) { return node->offsetRight; }
+
+    static bool Less(const Freelist::Node* a, const Freelist::Node* b)
+    {
+        return a->offset < b->offset;
+    }
+};
+
+struct SizeOrder
+{
+    static Freelist::Node*& Left(Freelist::Node* node) { return node->sizeLeft; }
+    static Freelist::Node*& Right(Freelist::Node* node) { return node->sizeRight; }
+
+    static bool Less(const Freelist::Node* a, const Freelist::Node* b)
+    {
+        return (a->size < b->size) || (a->size == b->size && a->offset < b->offset);
+    }
+};
+
+// Joins two treaps where every key in "left" is smaller than every key in "right".
+template<typename Order>
+static Freelist::Node* TreapMerge(Freelist::Node* left, Freelist::Node* right)
+{
+    if (!left) return right;
+    if (!right) return left;
+
+    if (left->priority > right->priority)
+    {
+        Order::Right(left) = TreapMerge<Order>(Order::Right(left), right);
+        return left;
+    }
+
+    Order::Left(right) = TreapMerge<Order>(left, Order::Left(right));
+    return right;
+}
+
+// Splits a treap in the nodes ordered before "key" and the rest.
+template<typename Order>
+static void TreapSplit(Freelist::Node* root, const Freelist::Node* key, Freelist::Node** outLeft, Freelist::Node** outRight)
+{
+    if (!root)
+    {
+        *outLeft = nullptr;
+        *outRight = nullptr;
+        return;
+    }
+
+    if (Order::Less(root, key))
+    {
+        TreapSplit<Order>(Order::Right(root), key, &Order::Right(root), outRight);
+        *outLeft = root;
+    }
+    else
+    {
+        TreapSplit<Order>(Order::Left(root), key, outLeft, &Order::Left(root));
+        *outRight = root;
+    }
+}
+
+template<typename Order>
+static Freelist::Node* TreapInsert(Freelist::Node* root, Freelist::Node* node)
 {
-    const uint64 maxEntries = totalSize / (sizeof(void*) * sizeof(Node));
-    return sizeof(InternalState) + (sizeof(Node) * maxEntries);
+    Order::Left(node) = nullptr;
+    Order::Right(node) = nullptr;
+
+    Freelist::Node* left = nullptr;
+    Freelist::Node* right = nullptr;
+
+    TreapSplit<Order>(root, node, &left, &right);
+
+    return TreapMerge<Order>(TreapMerge<Order>(left, node), right);
 }
 
-Freelist::Freelist(uint64 totalSize, void* memory)
+template<typename Order>
+static Freelist::Node* TreapErase(Freelist::Node* root, Freelist::Node* node)
+{
+    if (!root) return nullptr;
+
+    if (root == node)
+    {
+        Freelist::Node* merged = TreapMerge<Order>(Order::Left(root), Order::Right(root));
+
+        Order::Left(node) = nullptr;
+        Order::Right(node) = nullptr;
+
+        return merged;
+    }
+
+    if (Order::Less(node, root))
+    {
+        Order::Left(root) = TreapErase<Order>(Order::Left(root), node);
+    }
+    else
+    {
+        Order::Right(root) = TreapErase<Order>(Order::Right(root), node);
+    }
+
+    return root;
+}
+
+static uint64 AlignOffset(uint64 offset, uint64 alignment)
+{
+    return ((offset + alignment - 1) / alignment) * alignment;
+}
+
+// ----------------------------------------------------------------------- //
+
+uint64 Freelist::GetMemoryRequirement(uint64 totalSize)
+{
+    return sizeof(InternalState) + (sizeof(Node) * GetMaxEntries(totalSize));
+}
+
+Freelist::Freelist(uint64 totalSize, void* memory, uint64 maxSize)
 {
     state_ = reinterpret_cast<InternalState*>(memory);
     new (state_) InternalState();
 
     state_->nodes = reinterpret_cast<Node*>(reinterpret_cast<char*>(memory) + sizeof(InternalState));
-    state_->maxEntries = totalSize / (sizeof(void*) * sizeof(Node));
+    state_->maxEntries = GetMaxEntries(std::max(totalSize, maxSize));
     state_->totalSize = totalSize;
 
-    // Initialize first node
-    state_->head = &state_->nodes[0];
-    state_->head->offset = 0;
-    state_->head->size = totalSize;
-    state_->head->next = nullptr;
-
-    // Initialize remaining nodes
-    for (uint64 i = 1; i < state_->maxEntries; ++i) 
-    {
-        state_->nodes[i] = Node();
-    }
+    Clear();
 }
 
-Freelist::~Freelist() 
+Freelist::~Freelist()
 {
-    if (state_) 
+    if (state_)
     {
-        MemoryManager::ZeroMemory(state_, GetMemoryRequirement(state_->totalSize));
+        // Nodes past the fresh mark were never touched
+        MemoryManager::ZeroMemory(state_, sizeof(InternalState) + sizeof(Node) * (state_->maxEntries - state_->freshNodes));
     }
 }
 
 bool Freelist::Allocate(uint64 size, uint64* outOffset)
 {
-    if (!outOffset || !state_) return false;
+    return Allocate(size, 1, outOffset);
+}
+
+bool Freelist::Allocate(uint64 size, uint64 alignment, uint64* outOffset)
+{
+    if (!outOffset || !state_ || size == 0) return false;
 
-    Node* current = state_->head;
-    Node* previous = nullptr;
+    if (alignment == 0) alignment = 1;
 
-    while (current) 
+    uint64 alignedOffset = 0;
+    Node* node = FindBestFit(size, alignment, &alignedOffset);
+
+    if (!node)
     {
-        if (current->size == size) 
-        {
-            *outOffset = current->offset;
-            if (previous) 
-            {
-                previous->next = current->next;
-                ReturnNode(current);
-            }
-            else 
-            {
-                Node* old_head = state_->head;
-                state_->head = current->next;
-                ReturnNode(old_head);
-            }
+        // Log warning about insufficient space
+        NOUS_WARN("Freelist::Allocate(). WARNING: Insufficient Space");
+        return false;
+    }
 
-            return true;
+    const uint64 rangeEnd = node->offset + node->size;
+    const uint64 leading = alignedOffset - node->offset;
+    const uint64 trailing = rangeEnd - (alignedOffset + size);
 
-        }
-        else if (current->size > size) 
+    // Both a leading and a trailing gap remain, the range has to be split in two
+    if (leading > 0 && trailing > 0 && !HasFreeNode())
+    {
+        NOUS_WARN("Freelist::Allocate(). WARNING: Out of nodes");
+        return false;
+    }
+
+    state_->sizeRoot = TreapErase<SizeOrder>(state_->sizeRoot, node);
+
+    if (leading > 0)
+    {
+        // The node keeps its offset, so its place in the offset tree doesn't change
+        node->size = leading;
+        state_->sizeRoot = TreapInsert<SizeOrder>(state_->sizeRoot, node);
+
+        if (trailing > 0)
         {
-            *outOffset = current->offset;
-            current->size -= size;
-            current->offset += size;
-            return true;
+            Node* trailingNode = GetNode();
+            trailingNode->offset = alignedOffset + size;
+            trailingNode->size = trailing;
+            InsertRange(trailingNode);
         }
-
-        previous = current;
-        current = current->next;
+    }
+    else if (trailing > 0)
+    {
+        // Shrinking from the front keeps the node between the same neighbours
+        node->offset = alignedOffset + size;
+        node->size = trailing;
+        state_->sizeRoot = TreapInsert<SizeOrder>(state_->sizeRoot, node);
+    }
+    else
+    {
+        state_->offsetRoot = TreapErase<OffsetOrder>(state_->offsetRoot, node);
+        state_->rangeCount--;
+        ReturnNode(node);
     }
 
-    // Log warning about insufficient space
-    NOUS_WARN("Freelist::Allocate(). WARNING: Insufficient Space");
+    state_->freeSpace -= size;
+    *outOffset = alignedOffset;
 
-    return false;
+    return true;
 }
 
-bool Freelist::Free(uint64 size, uint64 offset) 
+bool Freelist::Free(uint64 size, uint64 offset)
 {
     if (!state_ || size == 0) return false;
 
-    if (!state_->head) 
+    Node* previous = FindPrevious(offset);
+    Node* next = FindNext(offset);
+
+    const bool overlapsPrevious = previous && (previous->offset + previous->size > offset);
+    const bool overlapsNext = next && (offset + size > next->offset);
+
+    if (overlapsPrevious || overlapsNext || offset + size > state_->totalSize)
     {
-        Node* newNode = GetNode();
-        newNode->offset = offset;
-        newNode->size = size;
-        state_->head = newNode;
-        return true;
+        // Log warning about possible corruption
+        NOUS_WARN("Freelist::Free(). WARNING: Possible Memory Corruption.");
+        return false;
     }
 
-    Node* current = state_->head;
-    Node* previous = nullptr;
+    const bool mergePrevious = previous && (previous->offset + previous->size == offset);
+    const bool mergeNext = next && (offset + size == next->offset);
 
-    while (current) 
+    if (mergePrevious)
     {
-        if (current->offset == offset) 
-        {
-            current->size += size;
-            MergeWithNext(current);
+        state_->sizeRoot = TreapErase<SizeOrder>(state_->sizeRoot, previous);
+        previous->size += size;
 
-            return true;
-        }
-        else if (current->offset > offset) 
+        if (mergeNext)
         {
-            Node* new_node = GetNode();
-            new_node->offset = offset;
-            new_node->size = size;
+            EraseRange(next);
+            previous->size += next->size;
+            ReturnNode(next);
+        }
 
-            if (previous) 
-            {
-                previous->next = new_node;
-            }
-            else 
-            {
-                state_->head = new_node;
-            }
+        state_->sizeRoot = TreapInsert<SizeOrder>(state_->sizeRoot, previous);
+    }
+    else if (mergeNext)
+    {
+        // Growing backwards keeps the node between the same neighbours
+        state_->sizeRoot = TreapErase<SizeOrder>(state_->sizeRoot, next);
+        next->offset = offset;
+        next->size += size;
+        state_->sizeRoot = TreapInsert<SizeOrder>(state_->sizeRoot, next);
+    }
+    else
+    {
+        Node* newNode = GetNode();
 
-            new_node->next = current;
+        if (!newNode)
+        {
+            NOUS_WARN("Freelist::Free(). WARNING: Out of nodes");
+            return false;
+        }
 
-            MergeWithNext(new_node);
+        newNode->offset = offset;
+        newNode->size = size;
+        InsertRange(newNode);
+    }
 
-            if (previous) 
-            {
-                MergeWithNext(previous);
-            }
-                
-            return true;
-        }
+    state_->freeSpace += size;
 
-        previous = current;
-        current = current->next;
+    return true;
+}
+
+bool Freelist::Grow(uint64 newSize)
+{
+    if (!state_ || newSize <= state_->totalSize || GetMaxEntries(newSize) > state_->maxEntries)
+    {
+        return false;
     }
 
-    // Log warning about possible corruption
-    NOUS_WARN("Freelist::Free(). WARNING: Possible Memory Corruption.");
+    const uint64 oldSize = state_->totalSize;
+    state_->totalSize = newSize;
+
+    // The new tail is released like any other range, merging with a trailing free range
+    if (!Free(newSize - oldSize, oldSize))
+    {
+        state_->totalSize = oldSize;
+        return false;
+    }
 
-    return false;
+    return true;
 }
 
 void Freelist::Clear()
 {
     if (!state_) return;
 
-    for (uint64 i = 1; i < state_->maxEntries; ++i) 
-    {
-        state_->nodes[i] = Node();
-    }
+    ResetNodes();
 
-    state_->head->offset = 0;
-    state_->head->size = state_->totalSize;
-    state_->head->next = nullptr;
+    Node* head = GetNode();
+    head->offset = 0;
+    head->size = state_->totalSize;
+
+    InsertRange(head);
+
+    state_->freeSpace = state_->totalSize;
 }
 
 uint64 Freelist::FreeSpace() const
 {
-    if (!state_) return 0;
+    return state_ ? state_->freeSpace : 0;
+}
 
-    uint64 total = 0;
-    Node* current = state_->head;
+uint64 Freelist::LargestFreeBlock() const
+{
+    if (!state_ || !state_->sizeRoot) return 0;
 
-    while (current) 
+    Node* current = state_->sizeRoot;
+
+    while (current->sizeRight)
     {
-        total += current->size;
-        current = current->next;
+        current = current->sizeRight;
     }
 
-    return total;
+    return current->size;
 }
 
-bool Freelist::Resize(uint64 newSize, uint64* memoryRequirement, void* newMemory, void** outOldMemory) 
+uint64 Freelist::GetFreeRangeCount() const
 {
-    if (!memoryRequirement || state_->totalSize > newSize) 
+    return state_ ? state_->rangeCount : 0;
+}
+
+bool Freelist::Resize(uint64 newSize, uint64* memoryRequirement, void* newMemory, void** outOldMemory)
+{
+    if (!memoryRequirement || state_->totalSize > newSize)
     {
         return false;
     }
 
     // Calculate new memory requirements
-    uint64_t maxEntries = newSize / (sizeof(void*) * sizeof(Node));
-    *memoryRequirement = sizeof(InternalState) + (sizeof(Node) * maxEntries);
+    *memoryRequirement = GetMemoryRequirement(newSize);
 
     // If just querying memory requirement, return early
-    if (!newMemory) 
+    if (!newMemory)
     {
         return true;
     }
 
     // Prepare old state and calculate size difference
     InternalState* oldState = state_;
-    uint64_t sizeDiff = newSize - oldState->totalSize;
 
     // Set output for old memory block (caller must free this)
     *outOldMemory = reinterpret_cast<void*>(oldState);
@@ -203,95 +357,231 @@ bool Freelist::Resize(uint64 newSize, uint64* memoryRequirement, void* newMemory
     // Initialize new memory block
     MemoryManager::ZeroMemory(newMemory, *memoryRequirement);
     state_ = reinterpret_cast<InternalState*>(newMemory);
+    new (state_) InternalState();
+
     state_->nodes = reinterpret_cast<Node*>(reinterpret_cast<char*>(newMemory) + sizeof(InternalState));
-    state_->maxEntries = maxEntries;
+    state_->maxEntries = GetMaxEntries(newSize);
     state_->totalSize = newSize;
+    state_->seed = oldState->seed;
+
+    ResetNodes();
+
+    // Replicate the old ranges in offset order, the old block stays valid until the caller frees it
+    InternalState* newState = state_;
+    Node* last = nullptr;
+
+    state_ = oldState;
+    Node* oldCurrent = FindNext(0);
+    state_ = newState;
 
-    // Invalidate all nodes except the first
-    for (uint64_t i = 1; i < state_->maxEntries; ++i) 
+    while (oldCurrent)
     {
-        state_->nodes[i].offset = INVALID_ID;
-        state_->nodes[i].size = INVALID_ID;
-        state_->nodes[i].next = nullptr;
+        // The last range is inserted once we know whether it grows with the expansion
+        if (last) InsertRange(last);
+
+        last = GetNode();
+        last->offset = oldCurrent->offset;
+        last->size = oldCurrent->size;
+
+        state_ = oldState;
+        oldCurrent = FindNext(oldCurrent->offset + 1);
+        state_ = newState;
     }
 
-    state_->head = &state_->nodes[0];
+    const uint64 sizeDiff = newSize - oldState->totalSize;
 
-    // Copy old nodes to new memory
-    if (!oldState->head) 
+    if (last && last->offset + last->size == oldState->totalSize)
     {
-        // Entire old list was allocated: create new head at the expanded space
-        state_->head->offset = oldState->totalSize;
-        state_->head->size = sizeDiff;
-        state_->head->next = nullptr;
+        last->size += sizeDiff;
+        InsertRange(last);
     }
-    else 
+    else
     {
-        Node* newCurrent = state_->head;
-        Node* oldCurrent = oldState->head;
+        if (last) InsertRange(last);
 
-        while (oldCurrent) 
+        if (sizeDiff > 0)
         {
-            // Replicate the node in the new memory
-            newCurrent->offset = oldCurrent->offset;
-            newCurrent->size = oldCurrent->size;
-            newCurrent->next = nullptr;
-
-            // Handle expansion at the end of the old list
-            if (!oldCurrent->next && (oldCurrent->offset + oldCurrent->size == oldState->totalSize)) 
-            {
-                newCurrent->size += sizeDiff;
-            }
-
-            // Move to next node if available
-            if (oldCurrent->next) 
-            {
-                newCurrent->next = GetNode();
-
-                newCurrent = newCurrent->next;
-                oldCurrent = oldCurrent->next;
-            }
-            else 
-            {
-                break;
-            }
+            Node* tail = GetNode();
+            tail->offset = oldState->totalSize;
+            tail->size = sizeDiff;
+            InsertRange(tail);
         }
     }
 
+    state_->freeSpace = oldState->freeSpace + sizeDiff;
+
     return true;
 }
 
+// ----------------------------------------------------------------------- //
+
+uint64 Freelist::GetMaxEntries(uint64 totalSize)
+{
+    return std::max<uint64>(totalSize / (sizeof(void*) * sizeof(Node)), 1);
+}
+
+void Freelist::ResetNodes()
+{
+    state_->offsetRoot = nullptr;
+    state_->sizeRoot = nullptr;
+    state_->unusedNodes = nullptr;
+    state_->rangeCount = 0;
+
+    // Nodes are handed out lazily, a big pool doesn't touch its memory up front
+    state_->freshNodes = state_->maxEntries;
+}
+
 Freelist::Node* Freelist::GetNode()
 {
-    for (uint64 i = 1; i < state_->maxEntries; ++i) 
+    Node* node = state_->unusedNodes;
+
+    if (node)
     {
-        if (state_->nodes[i].offset == INVALID_ID) 
+        state_->unusedNodes = node->next;
+    }
+    else if (state_->freshNodes > 0)
+    {
+        // Lowest index first, the pool fills front to back
+        node = &state_->nodes[state_->maxEntries - state_->freshNodes--];
+        *node = Node();
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    // Xorshift keeps the treap priorities random without pulling in <random>
+    uint32 x = state_->seed ? state_->seed : 0x9E3779B9;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state_->seed = x;
+
+    node->offset = 0;
+    node->size = 0;
+    node->next = nullptr;
+    node->priority = x;
+
+    return node;
+}
+
+bool Freelist::HasFreeNode() const
+{
+    return state_->unusedNodes != nullptr || state_->freshNodes > 0;
+}
+
+void Freelist::ReturnNode(Node* node)
+{
+    *node = Node();
+
+    node->next = state_->unusedNodes;
+    state_->unusedNodes = node;
+}
+
+void Freelist::InsertRange(Node* node)
+{
+    state_->offsetRoot = TreapInsert<OffsetOrder>(state_->offsetRoot, node);
+    state_->sizeRoot = TreapInsert<SizeOrder>(state_->sizeRoot, node);
+    state_->rangeCount++;
+}
+
+void Freelist::EraseRange(Node* node)
+{
+    state_->offsetRoot = TreapErase<OffsetOrder>(state_->offsetRoot, node);
+    state_->sizeRoot = TreapErase<SizeOrder>(state_->sizeRoot, node);
+    state_->rangeCount--;
+}
+
+Freelist::Node* Freelist::FindBestFit(uint64 size, uint64 alignment, uint64* outAlignedOffset) const
+{
+    // Smallest range with at least "size" bytes
+    Node* candidate = nullptr;
+
+    for (Node* current = state_->sizeRoot; current; )
+    {
+        if (current->size >= size)
         {
-            state_->nodes[i].offset = 0;
-            state_->nodes[i].size = 0;
+            candidate = current;
+            current = current->sizeLeft;
+        }
+        else
+        {
+            current = current->sizeRight;
+        }
+    }
+
+    // Walk up in size order until the alignment padding fits too. Any range of at least size + alignment - 1
+    // bytes always fits, so only the k ranges sized in [size, size + alignment - 1) can be skipped, each one
+    // costing an O(log n) successor search: O((k + 1) log n) overall. k is 0 without alignment (DynamicAllocator)
+    // or when the offsets are already aligned. At worst k is every free range, bounded by GetMaxEntries()
+    // (one node per 512 bytes managed), so callers needing large alignments should round their sizes up.
+    while (candidate)
+    {
+        const uint64 alignedOffset = AlignOffset(candidate->offset, alignment);
 
-            return &state_->nodes[i];
+        if (alignedOffset + size <= candidate->offset + candidate->size)
+        {
+            *outAlignedOffset = alignedOffset;
+            return candidate;
         }
+
+        Node* successor = nullptr;
+
+        for (Node* current = state_->sizeRoot; current; )
+        {
+            if (SizeOrder::Less(candidate, current))
+            {
+                successor = current;
+                current = current->sizeLeft;
+            }
+            else
+            {
+                current = current->sizeRight;
+            }
+        }
+
+        candidate = successor;
     }
 
     return nullptr;
 }
 
-void Freelist::ReturnNode(Node* node) 
+Freelist::Node* Freelist::FindPrevious(uint64 offset) const
 {
-    node->offset = INVALID_ID;
-    node->size = INVALID_ID;
-    node->next = nullptr;
+    Node* result = nullptr;
+
+    for (Node* current = state_->offsetRoot; current; )
+    {
+        if (current->offset < offset)
+        {
+            result = current;
+            current = current->offsetRight;
+        }
+        else
+        {
+            current = current->offsetLeft;
+        }
+    }
+
+    return result;
 }
 
-void Freelist::MergeWithNext(Node* node) 
+Freelist::Node* Freelist::FindNext(uint64 offset) const
 {
-    if (node->next && (node->offset + node->size == node->next->offset)) 
-    {
-        node->size += node->next->size;
+    Node* result = nullptr;
 
-        Node* rubbish = node->next;
-        node->next = rubbish->next;
-        ReturnNode(rubbish);
+    for (Node* current = state_->offsetRoot; current; )
+    {
+        if (current->offset >= offset)
+        {
+            result = current;
+            current = current->offsetLeft;
+        }
+        else
+        {
+            current = current->offsetRight;
+        }
     }
+
+    return result;
 }
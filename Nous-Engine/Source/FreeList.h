@@ -2,39 +2,57 @@
 
 #include "Globals.h"
 
+// Range allocator used to sub-allocate offsets inside a block it doesn't own (e.g. GPU buffers).
+// Free ranges are indexed twice: a size-ordered tree for best-fit searches and an offset-ordered
+// tree to coalesce neighbours on free. Both are treaps built on a preallocated node pool (one node
+// per 512 bytes managed), so operations run in O(log n) expected and never touch the memory being
+// managed. Aligned allocations may skip ranges too small for the padding, see FindBestFit().
+
 class Freelist
 {
 public:
 
-    // The #pragma pack directive is used in C and C++ to control the alignment of structure members in memory.
-    // 1 sets the new packing alignment to byte-aligned (no padding between structure members).
-    // This means the struct will occupy exactly 24 bytes on a 64-bit system .
-    // (8 bytes for offset + 8 bytes for size + 8 bytes for next).
-    // Without this pragma, the compiler might insert padding bytes for alignment optimization.
-
-#pragma pack(push, 1)
     struct Node 
     {
         uint64 offset;
         uint64 size;
+
+        // Offset-ordered tree
+        Node* offsetLeft;
+        Node* offsetRight;
+
+        // Size-ordered tree, keyed by (size, offset)
+        Node* sizeLeft;
+        Node* sizeRight;
+
+        // Link inside the pool of unused nodes
         Node* next;
 
-        Node() : offset(INVALID_ID), size(INVALID_ID), next(nullptr) {}
+        uint32 priority;
+
+        Node() : offset(INVALID_ID), size(INVALID_ID), offsetLeft(nullptr), offsetRight(nullptr),
+            sizeLeft(nullptr), sizeRight(nullptr), next(nullptr), priority(0) {}
     };
-#pragma pack(pop)
 
     static uint64 GetMemoryRequirement(uint64 totalSize);
 
-    Freelist(uint64 totalSize, void* memory);
+    /// @param maxSize: Size the list may reach through Grow(), memory must hold GetMemoryRequirement(maxSize).
+    Freelist(uint64 totalSize, void* memory, uint64 maxSize = 0);
     ~Freelist();
 
     bool Allocate(uint64 size, uint64* outOffset);
+    bool Allocate(uint64 size, uint64 alignment, uint64* outOffset);
     bool Free(uint64 size, uint64 offset);
 
     bool Resize(uint64 newSize, uint64* memoryRequirement, void* newMemory, void** outOldMemory);
+
+    /// @brief Extends the managed range in place, up to the maxSize given on construction.
+    bool Grow(uint64 newSize);
     void Clear();
 
     uint64 FreeSpace() const;
+    uint64 LargestFreeBlock() const;
+    uint64 GetFreeRangeCount() const;
 
 private:
 
@@ -42,16 +60,34 @@ private:
     {
         uint64 totalSize;
         uint64 maxEntries;
-        Node* head;
+        uint64 freshNodes;  // Nodes never handed out yet, taken from the end of the pool on demand
+        uint64 freeSpace;
+        uint64 rangeCount;
+        uint32 seed;
+
+        Node* offsetRoot;
+        Node* sizeRoot;
+        Node* unusedNodes;
         Node* nodes;
 
-        InternalState() : totalSize(0), maxEntries(0), head(nullptr), nodes(nullptr) {}
+        InternalState() : totalSize(0), maxEntries(0), freshNodes(0), freeSpace(0), rangeCount(0), seed(0),
+            offsetRoot(nullptr), sizeRoot(nullptr), unusedNodes(nullptr), nodes(nullptr) {}
     };
 
-    Node* GetNode();
+    static uint64 GetMaxEntries(uint64 totalSize);
+
+    void ResetNodes();
 
+    Node* GetNode();
+    bool HasFreeNode() const;
     void ReturnNode(Node* node);
-    void MergeWithNext(Node* node);
+
+    void InsertRange(Node* node);
+    void EraseRange(Node* node);
+
+    Node* FindBestFit(uint64 size, uint64 alignment, uint64* outAlignedOffset) const;
+    Node* FindPrevious(uint64 offset) const;
+    Node* FindNext(uint64 offset) const; // First range starting at or after offset
 
     InternalState* state_ = nullptr;
-};
\ No newline at end of file
+};
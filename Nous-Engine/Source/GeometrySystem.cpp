@@ -13,7 +13,7 @@ bool NOUS_GeometrySystem::Initialize()
     // Invalidate all geometries in the array.
     uint32 count = geometrySystemState.config.maxGeometryCount;
 
-    geometrySystemState.registeredGeometries = NOUS_NEW_ARRAY<GeometryReference>(count, MemoryManager::MemoryTag::ARRAY);
+    geometrySystemState.registeredGeometries = NOUS_NEW_ARRAY_UNINIT<GeometryReference>(count, MemoryManager::MemoryTag::ARRAY);
 
     for (uint32 i = 0; i < count; ++i) 
     {
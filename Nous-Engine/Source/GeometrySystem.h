@@ -25,9 +25,9 @@ struct GeometryConfig
 
 struct GeometryReference
 {
-    uint64 referenceCount;
+    uint64 referenceCount = 0;
     ResourceMesh geometry;
-    bool autoRelease;
+    bool autoRelease = false;
 };
 
 struct GeometrySystemState
@@ -15,6 +15,9 @@
 #include "Assimp.h"
 #define ASSIMP_LOAD_FLAGS (aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices | aiProcess_CalcTangentSpace)
 
+// Vertices converted per job, small meshes stay on the importing thread
+const uint64 c_VERTEX_CONVERSION_GRAIN_SIZE = 16384;
+
 void ProcessNode(aiNode* node, const aiScene* scene, Resource*& outMesh);
 void ProcessMesh(aiMesh* mesh, const aiScene* scene, Resource*& outMesh);
 
@@ -106,6 +109,12 @@ bool ImporterMesh::Load(const std::string& libraryPath, Resource* outResource)
 
     uint64 bytesRead = 0;
 
+    RelocatableHeap* heap = External->relocatableHeap;
+
+    // Requesting a loaded resource reloads it, the previous copy would leak otherwise
+    if (mesh->vertexData.IsValid()) heap->Free(mesh->vertexData);
+    if (mesh->indexData.IsValid()) heap->Free(mesh->indexData);
+
     // ------------------ VERTICES ------------------ //
 
     uint64 vertexCount = 0;
@@ -116,10 +125,14 @@ bool ImporterMesh::Load(const std::string& libraryPath, Resource* outResource)
         ret = false;
     }
 
-    mesh->vertices.resize(vertexCount);
+    mesh->vertexData = heap->Allocate(vertexCount * sizeof(Vertex3D));
+    mesh->vertexCount = vertexCount;
+
+    // Pinned until the geometry is uploaded, compaction can't move it meanwhile
+    Vertex3D* vertices = static_cast<Vertex3D*>(heap->Pin(mesh->vertexData));
 
     // Read vertex data
-    if (!fileHandle.ReadBytes(vertexCount * sizeof(Vertex3D), reinterpret_cast<char*>(mesh->vertices.data()), &bytesRead))
+    if (vertices == nullptr || !fileHandle.ReadBytes(vertexCount * sizeof(Vertex3D), reinterpret_cast<char*>(vertices), &bytesRead))
     {
         ret = false;
     }
@@ -134,18 +147,26 @@ bool ImporterMesh::Load(const std::string& libraryPath, Resource* outResource)
         ret = false;
     }
 
-    mesh->indices.resize(indexCount);
+    mesh->indexData = heap->Allocate(indexCount * sizeof(uint32));
+    mesh->indexCount = indexCount;
+
+    uint32* indices = static_cast<uint32*>(heap->Pin(mesh->indexData));
 
     // Read index data
-    if (!fileHandle.ReadBytes(indexCount * sizeof(uint32), reinterpret_cast<char*>(mesh->indices.data()), &bytesRead))
+    if (indices == nullptr || !fileHandle.ReadBytes(indexCount * sizeof(uint32), reinterpret_cast<char*>(indices), &bytesRead))
     {
         ret = false;
     }
 
     fileHandle.Close();
 
-    ret = External->renderer->rendererFrontend->CreateGeometry(mesh->vertices.size(), mesh->vertices.data(),
-        mesh->indices.size(), mesh->indices.data(), mesh);
+    if (ret)
+    {
+        ret = External->renderer->rendererFrontend->CreateGeometry(vertexCount, vertices, indexCount, indices, mesh);
+    }
+
+    if (vertices != nullptr) heap->Unpin(mesh->vertexData);
+    if (indices != nullptr) heap->Unpin(mesh->indexData);
 
     return ret;
 }
@@ -174,6 +195,12 @@ bool ImporterMesh::Unload(Resource* inResource)
     mesh->vertices.clear();
     mesh->indices.clear();
 
+    if (mesh->vertexData.IsValid()) External->relocatableHeap->Free(mesh->vertexData);
+    if (mesh->indexData.IsValid()) External->relocatableHeap->Free(mesh->indexData);
+
+    mesh->vertexCount = 0;
+    mesh->indexCount = 0;
+
     return true;
 }
 
@@ -194,49 +221,56 @@ void ProcessNode(aiNode* node, const aiScene* scene, Resource*& outMesh)
 void ProcessMesh(aiMesh* mesh, const aiScene* scene, Resource*& outMesh)
 {
     // Vertices
-    for (uint32 i = 0; i < mesh->mNumVertices; ++i)
-    {
-        Vertex3D vertex;
-
-        // Position
-        vertex.position =
-        {
-            mesh->mVertices[i].x,
-            mesh->mVertices[i].y,
-            mesh->mVertices[i].z
-        };
+    nous::vector<Vertex3D, MemoryManager::MemoryTag::RESOURCE_MESH>& vertices = down_cast<ResourceMesh*>(outMesh)->vertices;
 
-        // Color
-        if (mesh->HasVertexColors(0))
-        {
-            vertex.color =
-            {
-                mesh->mColors[0][i].r,
-                mesh->mColors[0][i].g,
-                mesh->mColors[0][i].b
-            };
-        }
-        else
-        {
-            vertex.color = { 1.0f, 1.0f, 1.0f };
-        }
+    const uint64 firstVertex = vertices.size();
+    vertices.resize(firstVertex + mesh->mNumVertices);
 
-        // Texture Coords
-        if (mesh->HasTextureCoords(0))
+    // Each vertex converts independently, every range writes its own slice of the array
+    External->jobSystem->ParallelFor(0, mesh->mNumVertices, c_VERTEX_CONVERSION_GRAIN_SIZE, [mesh, &vertices, firstVertex](uint64 first, uint64 last)
         {
-            vertex.texCoord =
+            for (uint64 i = first; i < last; ++i)
             {
-                mesh->mTextureCoords[0][i].x,
-                mesh->mTextureCoords[0][i].y
-            };
-        }
-        else
-        {
-            vertex.texCoord = { 0.0f, 0.0f };
-        }
-
-        down_cast<ResourceMesh*>(outMesh)->vertices.emplace_back(vertex);
-    }
+                Vertex3D& vertex = vertices[firstVertex + i];
+
+                // Position
+                vertex.position =
+                {
+                    mesh->mVertices[i].x,
+                    mesh->mVertices[i].y,
+                    mesh->mVertices[i].z
+                };
+
+                // Color
+                if (mesh->HasVertexColors(0))
+                {
+                    vertex.color =
+                    {
+                        mesh->mColors[0][i].r,
+                        mesh->mColors[0][i].g,
+                        mesh->mColors[0][i].b
+                    };
+                }
+                else
+                {
+                    vertex.color = { 1.0f, 1.0f, 1.0f };
+                }
+
+                // Texture Coords
+                if (mesh->HasTextureCoords(0))
+                {
+                    vertex.texCoord =
+                    {
+                        mesh->mTextureCoords[0][i].x,
+                        mesh->mTextureCoords[0][i].y
+                    };
+                }
+                else
+                {
+                    vertex.texCoord = { 0.0f, 0.0f };
+                }
+            }
+        });
 
     // Indices
     if (mesh->HasFaces())
@@ -0,0 +1,159 @@
+#include "JobProfilerWindow.h"
+
+#include "NOUS_JobProfiler.h"
+
+JobProfiler::JobProfiler(const char* title, bool start_open)
+    : IEditorWindow(title, nullptr, start_open)
+{
+    Init();
+}
+
+void JobProfiler::Init()
+{
+
+}
+
+void JobProfiler::Draw()
+{
+    if (!*p_open) return;
+
+    ImGui::SetNextWindowSize(ImVec2(750, 500), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin(title, p_open))
+    {
+        auto& profiler = NOUS_Multithreading::NOUS_JobProfiler::Get();
+
+        // Aggregating copies every ring buffer, twice a second is enough to follow it live
+        static NOUS_Multithreading::NOUS_JobProfile profile;
+        static double lastBuildTime = -1.0;
+
+        const bool recording = profiler.IsRecording();
+
+        if (ImGui::Button(recording ? "Stop Recording" : "Start Recording"))
+        {
+            recording ? profiler.Stop() : profiler.Start();
+            lastBuildTime = -1.0;
+        }
+
+        ImGui::SameLine();
+        if (ImGui::Button("Export Chrome Trace"))
+        {
+            profiler.ExportChromeTrace("job_trace.json"); // Opens in chrome://tracing or ui.perfetto.dev
+        }
+
+        if (lastBuildTime < 0.0 || (recording && ImGui::GetTime() - lastBuildTime > 0.5))
+        {
+            profile = profiler.BuildProfile();
+            lastBuildTime = ImGui::GetTime();
+        }
+
+        const double duration = (profile.endTime > profile.startTime) ? (profile.endTime - profile.startTime) / 1e6 : 0.0;
+
+        ImGui::SameLine(0.0f, 20.0f);
+        ImGui::Text("Recorded: %.2f ms, %llu jobs (%llu overwritten)", duration, profile.eventCount, profile.overwrittenEvents);
+
+        ImGui::Separator();
+
+        // Per thread table
+        if (ImGui::BeginTable("JobProfilerThreads", 6,
+            ImGuiTableFlags_Borders |
+            ImGuiTableFlags_RowBg |
+            ImGuiTableFlags_Resizable))
+        {
+            ImGui::TableSetupColumn("Thread", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Jobs", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Stolen", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Busy (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("Avg Wait (us)", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            ImGui::TableSetupColumn("Utilization", ImGuiTableColumnFlags_WidthFixed, 150.0f);
+            ImGui::TableHeadersRow();
+
+            for (const auto& thread : profile.threads)
+            {
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", thread.name.c_str());
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%llu", thread.executedJobs);
+
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%llu", thread.stolenJobs);
+
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.2f", thread.busyTime / 1e6);
+
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%.1f", thread.totalWaitTime / 1e3 / thread.executedJobs);
+
+                ImGui::TableSetColumnIndex(5);
+                std::string utilizationText = std::to_string(static_cast<int>(thread.utilization * 100.0f)) + "%";
+                ImGui::ProgressBar(thread.utilization, ImVec2(-1, 0), utilizationText.c_str());
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::Separator();
+
+        // Per job name table, the histogram goes from < 1 us to 2^18 us and above
+        if (ImGui::BeginTable("JobProfilerJobs", 8,
+            ImGuiTableFlags_Borders |
+            ImGuiTableFlags_RowBg |
+            ImGuiTableFlags_Resizable |
+            ImGuiTableFlags_ScrollY))
+        {
+            ImGui::TableSetupColumn("Job", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Total (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("Avg (us)", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Max (us)", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Avg Wait (us)", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            ImGui::TableSetupColumn("Max Wait (us)", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            ImGui::TableSetupColumn("Durations", ImGuiTableColumnFlags_WidthFixed, 160.0f);
+            ImGui::TableHeadersRow();
+
+            for (const auto& job : profile.jobs)
+            {
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", job.name.c_str());
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%llu", job.count);
+
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.2f", job.totalTime / 1e6);
+
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.1f", job.totalTime / 1e3 / job.count);
+
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%.1f", job.maxTime / 1e3);
+
+                ImGui::TableSetColumnIndex(5);
+                ImGui::Text("%.1f", job.totalWaitTime / 1e3 / job.count);
+
+                ImGui::TableSetColumnIndex(6);
+                ImGui::Text("%.1f", job.maxWaitTime / 1e3);
+
+                ImGui::TableSetColumnIndex(7);
+                float histogram[NOUS_Multithreading::c_JOB_HISTOGRAM_BUCKETS];
+
+                for (uint32 i = 0; i < NOUS_Multithreading::c_JOB_HISTOGRAM_BUCKETS; ++i)
+                {
+                    histogram[i] = static_cast<float>(job.histogram[i]);
+                }
+
+                ImGui::PushID(job.name.c_str());
+                ImGui::PlotHistogram("##Durations", histogram, NOUS_Multithreading::c_JOB_HISTOGRAM_BUCKETS, 0,
+                    nullptr, 0.0f, FLT_MAX, ImVec2(-1, 20));
+                ImGui::PopID();
+            }
+
+            ImGui::EndTable();
+        }
+    }
+    ImGui::End();
+}
\ No newline at end of file
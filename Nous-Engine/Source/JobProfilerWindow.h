@@ -0,0 +1,13 @@
+#pragma once
+
+#include "IEditorWindow.inl"
+
+class JobProfiler : public IEditorWindow
+{
+public:
+
+    explicit JobProfiler(const char* title, bool start_open = true);
+
+    void Init() override;
+    void Draw() override;
+};
\ No newline at end of file
@@ -26,35 +26,67 @@ void JobQueue::Draw()
     if (ImGui::Begin(title, p_open))
     {
         const auto& threadPool = External->jobSystem->GetThreadPool();
-        const auto& jobQueue = threadPool.GetJobQueue();
+        const auto& threads = threadPool.GetThreads();
 
-        // New Job Queue table
-        if (ImGui::BeginTable("JobQueue", 1,
+        for (uint32 i = 0; i < static_cast<uint32>(NOUS_Multithreading::NOUS_JobPriority::COUNT); ++i)
+        {
+            const auto priority = static_cast<NOUS_Multithreading::NOUS_JobPriority>(i);
+
+            if (i > 0) ImGui::SameLine(0.0f, 20.0f);
+            ImGui::Text("%s: %llu", NOUS_Multithreading::GetJobPriorityName(priority), threadPool.GetQueuedJobCount(priority));
+        }
+
+        ImGui::Text("Background Workers: %u / %u", threadPool.GetActiveBackgroundWorkers(), threadPool.GetMaxBackgroundWorkers());
+        ImGui::SameLine(0.0f, 20.0f);
+        ImGui::Text("Main Thread Tasks: %llu", External->jobSystem->GetPendingMainThreadTasks());
+        ImGui::SameLine(0.0f, 20.0f);
+        ImGui::Text("Parked Polls: %llu", External->jobSystem->GetParkedMainThreadPolls());
+
+        ImGui::Text("Spinning Workers: %u", threadPool.GetSpinningWorkers());
+        ImGui::SameLine(0.0f, 20.0f);
+        ImGui::Text("Parked Workers: %u", threadPool.GetParkedWorkers());
+        ImGui::SameLine(0.0f, 20.0f);
+        ImGui::Text("Wakeups: %llu", threadPool.GetWakeupCount());
+
+        // Jobs live in lock-free deques that workers keep changing, so only their counters are shown
+        if (ImGui::BeginTable("JobQueue", 4,
             ImGuiTableFlags_Borders |
             ImGuiTableFlags_RowBg |
             ImGuiTableFlags_ScrollY))
         {
-            ImGui::TableSetupColumn(std::format("Job Name ({} pending jobs)", jobQueue.size()).c_str(), ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn(std::format("Queue ({} pending jobs)", threadPool.GetQueuedJobCount()).c_str(), ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Pending", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("Executed", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("Stolen", ImGuiTableColumnFlags_WidthFixed, 80.0f);
             ImGui::TableHeadersRow();
 
-            // Create a copy of the queue for safe iteration
-            std::queue<NOUS_Multithreading::NOUS_Job*> tempQueue = jobQueue;
+            const NOUS_Multithreading::NOUS_JobQueueStats injectionStats = threadPool.GetInjectionQueueStats();
+
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("Injection Queue");
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%llu", injectionStats.pendingJobs);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::TextDisabled("-");
+            ImGui::TableSetColumnIndex(3);
+            ImGui::TextDisabled("-");
 
-            while (!tempQueue.empty())
+            for (uint32 i = 0; i < threads.size(); ++i)
             {
-                NOUS_Multithreading::NOUS_Job* job = tempQueue.front();
-                tempQueue.pop();
+                const NOUS_Multithreading::NOUS_JobQueueStats stats = threadPool.GetWorkerQueueStats(i);
 
                 ImGui::TableNextRow();
                 ImGui::TableSetColumnIndex(0);
-
-                if (job) {
-                    ImGui::Text("%s", job->GetName().c_str());
-                }
-                else {
-                    ImGui::TextDisabled("(null job)");
-                }
+                ImGui::Text("%s", threads[i]->GetName().c_str());
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%llu", stats.pendingJobs);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%llu", stats.executedJobs);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%llu", stats.stolenJobs);
             }
+
             ImGui::EndTable();
         }
     }
@@ -0,0 +1,197 @@
+#include "JobSystemBenchmark.h"
+
+#include "NOUS_JobSystem.h"
+#include "NOUS_CpuTopology.h"
+#include "Logger.h"
+
+#include "External/Parson/parson.h"
+
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+struct FanOutWorkload
+{
+	const char* name;
+	uint32 jobCount;
+	uint32 idleMicroseconds;	// Main thread work between batches, workers run out of jobs meanwhile
+};
+
+struct LatencyReport
+{
+	double p50;
+	double p99;
+	double p999;
+	double max;
+	double mean;
+};
+
+static const uint32 c_BENCHMARK_ITERATIONS = 2000;
+static const uint32 c_WARMUP_ITERATIONS = 100;
+
+static const FanOutWorkload c_FAN_OUT_WORKLOADS[] =
+{
+	{ "burst_8", 8, 0 },
+	{ "burst_64", 64, 0 },
+	{ "burst_512", 512, 0 },
+	{ "frame_8", 8, 2000 },
+	{ "frame_64", 64, 2000 },
+	{ "frame_512", 512, 2000 },
+};
+
+static LatencyReport ComputeLatencyReport(std::vector<double>& samples)
+{
+	LatencyReport report = {};
+
+	if (samples.empty()) return report;
+
+	std::sort(samples.begin(), samples.end());
+
+	auto percentile = [&samples](double p)
+		{
+			const size_t index = static_cast<size_t>(p * (samples.size() - 1));
+			return samples[index];
+		};
+
+	double sum = 0.0;
+
+	for (double sample : samples)
+	{
+		sum += sample;
+	}
+
+	report.p50 = percentile(0.50);
+	report.p99 = percentile(0.99);
+	report.p999 = percentile(0.999);
+	report.max = samples.back();
+	report.mean = sum / samples.size();
+
+	return report;
+}
+
+// Busy, like the rest of a frame would keep the main thread
+static void SimulateFrameWork(uint32 microseconds)
+{
+	const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(microseconds);
+
+	while (std::chrono::steady_clock::now() < end);
+}
+
+static double RunFanOut(NOUS_Multithreading::NOUS_JobSystem& jobSystem, const FanOutWorkload& workload)
+{
+	std::vector<NOUS_Multithreading::NOUS_JobHandle> handles(workload.jobCount);
+	std::atomic<uint32> executedJobs = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (uint32 i = 0; i < workload.jobCount; ++i)
+	{
+		handles[i] = jobSystem.SubmitJob([&executedJobs]() { executedJobs.fetch_add(1, std::memory_order_relaxed); },
+			"Benchmark Fan Out", NOUS_Multithreading::NOUS_JobPriority::CRITICAL);
+	}
+
+	NOUS_Multithreading::NOUS_JobHandle fanIn = jobSystem.SubmitJob([]() {}, "Benchmark Fan In",
+		NOUS_Multithreading::NOUS_JobPriority::CRITICAL, handles.data(), workload.jobCount);
+
+	jobSystem.Wait(fanIn);
+
+	const auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static JSON_Value* RunWorkload(NOUS_Multithreading::NOUS_JobSystem& jobSystem, const FanOutWorkload& workload)
+{
+	std::vector<double> samples;
+	samples.reserve(c_BENCHMARK_ITERATIONS);
+
+	uint64 firstWakeup = 0;
+
+	for (uint32 i = 0; i < c_WARMUP_ITERATIONS + c_BENCHMARK_ITERATIONS; ++i)
+	{
+		if (i == c_WARMUP_ITERATIONS) firstWakeup = jobSystem.GetThreadPool().GetWakeupCount();
+
+		SimulateFrameWork(workload.idleMicroseconds);
+
+		const double latency = RunFanOut(jobSystem, workload);
+
+		if (i >= c_WARMUP_ITERATIONS) samples.push_back(latency);
+	}
+
+	// Parked workers woken up per batch, the kernel wakeups the submitters paid for
+	const double wakeups = static_cast<double>(jobSystem.GetThreadPool().GetWakeupCount() - firstWakeup) / c_BENCHMARK_ITERATIONS;
+
+	const LatencyReport report = ComputeLatencyReport(samples);
+
+	const uint32 maxSpinningWorkers = jobSystem.GetThreadPool().GetMaxSpinningWorkers();
+
+	NOUS_INFO("JobSystemBenchmark [%s, %u spinning] Fan-out/fan-in (us): p50 %.1f | p99 %.1f | p99.9 %.1f | max %.1f | mean %.1f | %.2f wakeups",
+		workload.name, maxSpinningWorkers, report.p50, report.p99, report.p999, report.max, report.mean, wakeups);
+
+	JSON_Value* value = json_value_init_object();
+	JSON_Object* object = json_value_get_object(value);
+
+	json_object_set_string(object, "name", workload.name);
+	json_object_set_number(object, "jobs", workload.jobCount);
+	json_object_set_number(object, "idleUs", workload.idleMicroseconds);
+	json_object_set_number(object, "maxSpinningWorkers", maxSpinningWorkers);
+	json_object_dotset_number(object, "latencyUs.p50", report.p50);
+	json_object_dotset_number(object, "latencyUs.p99", report.p99);
+	json_object_dotset_number(object, "latencyUs.p999", report.p999);
+	json_object_dotset_number(object, "latencyUs.max", report.max);
+	json_object_dotset_number(object, "latencyUs.mean", report.mean);
+	json_object_set_number(object, "wakeupsPerBatch", wakeups);
+
+	return value;
+}
+
+void JobSystemBenchmark::RunBenchmarks(const char* outputPath, uint32 workerCount)
+{
+	NOUS_INFO("-------------- Job System Benchmark --------------");
+	const uint32 logicalCores = NOUS_Multithreading::NOUS_CpuTopology::Get().GetLogicalCoreCount();
+
+	NOUS_INFO("JobSystemBenchmark: %u workers, %u logical cores, %u iterations per workload", workerCount, logicalCores, 
+		c_BENCHMARK_ITERATIONS);
+
+	JSON_Value* rootValue = json_value_init_object();
+	JSON_Object* rootObject = json_value_get_object(rootValue);
+
+	json_object_set_number(rootObject, "workers", workerCount);
+	json_object_set_number(rootObject, "logicalCores", logicalCores);
+	json_object_set_value(rootObject, "workloads", json_value_init_array());
+
+	JSON_Array* workloads = json_object_get_array(rootObject, "workloads");
+
+	{
+		NOUS_Multithreading::NOUS_JobSystem jobSystem(workerCount);
+		NOUS_Multithreading::NOUS_ThreadPool& threadPool = jobSystem.GetThreadPool();
+
+		// Spinning is off on single-core machines, elsewhere every workload also runs without it to compare
+		const uint32 defaultSpinningWorkers = threadPool.GetMaxSpinningWorkers();
+
+		std::vector<uint32> spinConfigurations = { defaultSpinningWorkers };
+		if (defaultSpinningWorkers > 0) spinConfigurations.push_back(0);
+
+		for (const uint32 maxSpinningWorkers : spinConfigurations)
+		{
+			threadPool.SetMaxSpinningWorkers(maxSpinningWorkers);
+
+			for (const FanOutWorkload& workload : c_FAN_OUT_WORKLOADS)
+			{
+				json_array_append_value(workloads, RunWorkload(jobSystem, workload));
+			}
+		}
+	}
+
+	if (json_serialize_to_file_pretty(rootValue, outputPath) == JSONSuccess)
+	{
+		NOUS_INFO("JobSystemBenchmark: Report written to %s", outputPath);
+	}
+	else
+	{
+		NOUS_ERROR("JobSystemBenchmark: Failed to write the report to %s", outputPath);
+	}
+
+	json_value_free(rootValue);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Globals.h"
+
+namespace JobSystemBenchmark
+{
+	/// @brief Measures fan-out/fan-in latency of frame-critical jobs: the main thread submits a batch of tiny
+	/// CRITICAL jobs plus one depending on all of them, and waits for that last one. Batches run back to back
+	/// (workers still awake) and separated by simulated frame work (workers going idle in between).
+	/// Latency percentiles are logged and written as JSON. On multi-core machines every workload runs twice,
+	/// with the pool's default spinning workers and with none, so the spin path can be compared against parking.
+	/// @param outputPath: JSON report destination.
+	/// @param workerCount: Worker threads of the job system under test.
+	/// @note Run it with "--benchmark-jobs [output.json] [workers]".
+	void RunBenchmarks(const char* outputPath, uint32 workerCount);
+}
\ No newline at end of file
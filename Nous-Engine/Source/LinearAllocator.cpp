@@ -38,7 +38,7 @@ LinearAllocator::~LinearAllocator()
 void LinearAllocator::Create(uint64 capacity, void* preAllocatedMemory) 
 {
     this->capacity = capacity;
-    this->offset = offset;
+    this->offset = 0;
     this->memory = preAllocatedMemory;
     this->ownsMemory = (preAllocatedMemory == nullptr);
 
@@ -73,6 +73,26 @@ void* LinearAllocator::Allocate(uint64 size)
     return block;  
 }
 
+void* LinearAllocator::Allocate(uint64 size, uint64 alignment)
+{
+    NOUS_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment must be a power of two.");
+
+    // Align the actual address, the backing memory may not be aligned to the requested boundary
+    const uintptr_t current = reinterpret_cast<uintptr_t>(memory) + offset;
+    const uint64 padding = ((current + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1)) - current;
+
+    if (offset + padding + size > capacity)
+    {
+        NOUS_ERROR("LinearAllocator::Allocate - Tried to allocate %lluB, only %lluB remaining.", size + padding, GetRemainingSize());
+
+        return nullptr; // Out of memory
+    }
+
+    offset += padding;
+
+    return Allocate(size);
+}
+
 void LinearAllocator::FreeAll()
 {
     MemoryManager::Free(memory, capacity, MemoryManager::MemoryTag::LINEAR_ALLOCATOR);
@@ -81,17 +101,34 @@ void LinearAllocator::FreeAll()
     offset = 0;
 }
 
-inline uint64 LinearAllocator::GetTotalSize() const 
+void LinearAllocator::Reset()
+{
+    offset = 0;
+}
+
+uint64 LinearAllocator::GetMarker() const
+{
+    return offset;
+}
+
+void LinearAllocator::FreeToMarker(uint64 marker)
+{
+    NOUS_ASSERT_MSG(marker <= offset, "LinearAllocator::FreeToMarker - Marker is past the current offset.");
+
+    offset = marker;
+}
+
+uint64 LinearAllocator::GetTotalSize() const 
 { 
     return capacity; 
 }
 
-inline uint64 LinearAllocator::GetAllocatedSize() const 
+uint64 LinearAllocator::GetAllocatedSize() const 
 { 
     return offset; 
 }
 
-inline uint64 LinearAllocator::GetRemainingSize() const 
+uint64 LinearAllocator::GetRemainingSize() const 
 { 
     return capacity - offset; 
 }
@@ -14,8 +14,16 @@ public:
     void Create(uint64 capacity, void* preAllocatedMemory = nullptr);
 
     void* Allocate(uint64 size);
+    void* Allocate(uint64 size, uint64 alignment);
     void FreeAll();
 
+    // Rewinds the allocator without releasing its memory
+    void Reset();
+
+    // Markers allow freeing everything allocated after a given point
+    uint64 GetMarker() const;
+    void FreeToMarker(uint64 marker);
+
     // Getters for debugging or inspection
     uint64 GetTotalSize() const;
     uint64 GetAllocatedSize() const;
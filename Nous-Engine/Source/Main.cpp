@@ -3,6 +3,9 @@
 #include "Logger.h"
 #include "Asserts.h"
 #include "MemoryManager.h"
+#include "AllocatorBenchmark.h"
+#include "JobSystemBenchmark.h"
+#include "AllocationTrace.h"
 
 #include "NOUS_Multithreading.h"
 
@@ -27,13 +30,47 @@ int main(int argc, char** argv)
 {
 	startupTimer.Start();
 
-	// Specify the amount of memory available for the project
-	MemoryManager::InitializeMemory(MiB(300));
+	// Default arena sizes (see MemoryManager::MemoryConfig), more is committed on demand from each reserved address range
+	MemoryManager::InitializeMemory();
 
 	NOUS_Multithreading::RegisterMainThread();
 
 	InitializeLogging();
 
+	// --benchmark-allocators [output.json] [trace]
+	if (argc > 1 && strcmp(argv[1], "--benchmark-allocators") == 0)
+	{
+		AllocatorBenchmark::RunBenchmarks(argc > 2 ? argv[2] : "allocator_benchmark.json", argc > 3 ? argv[3] : nullptr);
+
+		NOUS_Multithreading::UnregisterMainThread();
+		ShutdownLogging();
+		MemoryManager::ShutdownMemory();
+
+		return EXIT_SUCCESS;
+	}
+
+	// --benchmark-jobs [output.json] [workers]
+	if (argc > 1 && strcmp(argv[1], "--benchmark-jobs") == 0)
+	{
+		JobSystemBenchmark::RunBenchmarks(argc > 2 ? argv[2] : "job_benchmark.json", 
+			argc > 3 ? static_cast<uint32>(atoi(argv[3])) : NOUS_Multithreading::c_MAX_HARDWARE_THREADS);
+
+		NOUS_Multithreading::UnregisterMainThread();
+		ShutdownLogging();
+		MemoryManager::ShutdownMemory();
+
+		return EXIT_SUCCESS;
+	}
+
+	// --record-allocations <trace>, the trace is saved on exit and can be replayed by the allocator benchmark
+	const char* allocationTracePath = nullptr;
+
+	if (argc > 2 && strcmp(argv[1], "--record-allocations") == 0)
+	{
+		allocationTracePath = argv[2];
+		AllocationTrace::Start();
+	}
+
 	NOUS_INFO("Starting engine '%s'....", TITLE);
 
 	int mainReturn = EXIT_FAILURE;
@@ -114,7 +151,14 @@ int main(int argc, char** argv)
 
 	NOUS_Multithreading::UnregisterMainThread();
 
-	NOUS_INFO(MemoryManager::GetMemoryUsageStats());
+	if (allocationTracePath)
+	{
+		AllocationTrace::Stop();
+		AllocationTrace::Save(allocationTracePath);
+		AllocationTrace::Reset();
+	}
+
+	NOUS_INFO("%s", MemoryManager::GetMemoryUsageStats().c_str());
 
 	ShutdownLogging();
 
@@ -15,7 +15,7 @@ bool NOUS_MaterialSystem::Initialize()
     // Invalidate all geometries in the array.
     uint32 count = state.config.MAX_MATERIAL_COUNT;
 
-    state.registeredMaterials = NOUS_NEW_ARRAY<MaterialReference>(count, MemoryManager::MemoryTag::ARRAY);
+    state.registeredMaterials = NOUS_NEW_ARRAY_UNINIT<MaterialReference>(count, MemoryManager::MemoryTag::ARRAY);
 
     for (uint32 i = 0; i < count; ++i)
     {
@@ -23,9 +23,9 @@ namespace NOUS_MaterialSystem
 
 	struct MaterialReference 
 	{
-		uint64 referenceCount;
+		uint64 referenceCount = 0;
 		ResourceMaterial material;
-		bool autoRelease;
+		bool autoRelease = false;
 	};
 
 	struct MaterialSystemState
@@ -3,100 +3,622 @@
 #include "Logger.h"
 #include "Asserts.h"
 #include "DynamicAllocator.h"
+#include "VirtualMemory.h"
+#include "AllocationTrace.h"
 
 #ifdef _PROFILING
 #include "Tracy.h"
 #endif // _PROFILING
 
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <bit>
+#include <cinttypes>
+#include <cstring>
 
-static std::mutex memoryMutex;
+// Each tag gets its own cache line, threads allocating under different tags don't contend.
+struct alignas(MemoryManager::c_CACHE_LINE_SIZE) TagStats
+{
+	std::atomic<uint64> bytes;
+	std::atomic<uint64> peakBytes;
+	std::atomic<uint64> liveAllocations;
+	std::atomic<uint64> totalAllocations;
+	std::atomic<uint64> failedAllocations;
 
-struct MemoryStats 
+	std::atomic<uint64> softLimit;
+	std::atomic<uint64> hardLimit;
+
+	// Highest MemoryPressure raised since the last EndFrame()
+	std::atomic<uint32> pendingPressure;
+};
+
+struct FrameStats
 {
-	uint64 totalAllocated;
-	uint64 totalAllocations;
-	uint64 taggedAllocations[static_cast<uint64>(MemoryManager::MemoryTag::MAX)];
+	std::atomic<uint64> allocations;
+	std::atomic<uint64> allocatedBytes;
+	std::atomic<uint64> frees;
+	std::atomic<uint64> freedBytes;
 };
 
-struct MemorySystemConfig 
+struct MemoryStats 
 {
-	MemoryStats stats;
+	std::atomic<uint64> totalAllocated;
+	std::atomic<uint64> totalAllocations;
+	std::atomic<uint64> peakAllocated;
 
-	uint64 totalAllocationSize;
-	uint64 allocatorRequirement;
+	TagStats tags[static_cast<uint64>(MemoryManager::MemoryTag::MAX)];
+
+	std::atomic<uint64> sizeHistogram[MemoryManager::c_SIZE_HISTOGRAM_BUCKETS];
+
+	// Running counters for the current frame, moved to lastFrame by EndFrame()
+	alignas(MemoryManager::c_CACHE_LINE_SIZE) FrameStats currentFrame;
+	alignas(MemoryManager::c_CACHE_LINE_SIZE) FrameStats lastFrame;
+	std::atomic<uint64> frameIndex;
+
+	std::atomic<uint64> arenaFreeSpace[static_cast<uint64>(MemoryManager::MemoryArena::MAX)];
+	std::atomic<uint64> arenaLargestFreeBlock[static_cast<uint64>(MemoryManager::MemoryArena::MAX)];
+	std::atomic<uint64> arenaCapacity[static_cast<uint64>(MemoryManager::MemoryArena::MAX)];
+
+	std::atomic<uint64> externalCommitted;
+};
+
+// Separate heap for a group of tags, laid out in its own reserved address range.
+struct MemoryArenaState
+{
+	uint64 totalAllocationSize;		// Usable heap size, grows on demand up to reserveSize
+	uint64 reserveSize;
+	uint64 allocatorRequirement;	// Reserved address range (control structures + reserveSize)
+	uint64 controlSize;				// Bytes before the user memory
+	uint64 committedSize;			// Bytes of the reserved range already committed
 
 	DynamicAllocator* allocator;
 	void* allocatorBlock;
 };
 
+struct MemorySystemConfig 
+{
+	MemoryStats stats;
+
+	MemoryArenaState arenas[static_cast<uint64>(MemoryManager::MemoryArena::MAX)];
+	bool useHugePages;
+};
+
 static const char* memoryTagStrings[static_cast<uint64>(MemoryManager::MemoryTag::MAX)] = 
 {
-	"UNKNOWN			",
-	"THREAD			",
-	"ARRAY			",
-	"DARRAY			",
-	"DICT			",
-	"RING_QUEUE		",
-	"BST			",
-	"STRING			",
-	"APPLICATION		",
-	"JOB			",
-	"TEXTURE			",
-	"MATERIAL_INSTANCE	",
-	"RENDERER		",
-	"GAME			",
-	"TRANSFORM		",
-	"ENTITY			",
-	"ENTITY_NODE		",
-	"SCENE			",
-	"INPUT			",
-	"LINEAR_ALLOC		",
-	"FILE			",
-	"RESOURCE_MESH		",
-	"RESOURCE_TEXTURE	",
-	"RESOURCE_MATERIAL	"
+	"UNKNOWN",
+	"THREAD",
+	"ARRAY",
+	"DARRAY",
+	"DICT",
+	"RING_QUEUE",
+	"BST",
+	"STRING",
+	"APPLICATION",
+	"JOB",
+	"TEXTURE",
+	"MATERIAL_INSTANCE",
+	"RENDERER",
+	"GAME",
+	"TRANSFORM",
+	"ENTITY",
+	"ENTITY_NODE",
+	"SCENE",
+	"INPUT",
+	"LINEAR_ALLOC",
+	"FILE",
+	"RESOURCE_MESH",
+	"RESOURCE_TEXTURE",
+	"RESOURCE_MATERIAL",
+	"POOL_ALLOC",
+	"FRAME_ALLOC"
+};
+
+static const char* memoryArenaStrings[static_cast<uint64>(MemoryManager::MemoryArena::MAX)] =
+{
+	"GENERAL",
+	"RESOURCE",
+	"TRANSIENT"
+};
+
+// Arena serving each tag, must follow the MemoryTag order.
+static const MemoryManager::MemoryArena memoryTagArenas[static_cast<uint64>(MemoryManager::MemoryTag::MAX)] =
+{
+	MemoryManager::MemoryArena::GENERAL,	// UNKNOWN
+	MemoryManager::MemoryArena::GENERAL,	// THREAD
+	MemoryManager::MemoryArena::GENERAL,	// ARRAY
+	MemoryManager::MemoryArena::GENERAL,	// DARRAY
+	MemoryManager::MemoryArena::GENERAL,	// DICT
+	MemoryManager::MemoryArena::GENERAL,	// RING_QUEUE
+	MemoryManager::MemoryArena::GENERAL,	// BST
+	MemoryManager::MemoryArena::TRANSIENT,	// STRING
+	MemoryManager::MemoryArena::GENERAL,	// APPLICATION
+	MemoryManager::MemoryArena::GENERAL,	// JOB
+	MemoryManager::MemoryArena::RESOURCE,	// TEXTURE
+	MemoryManager::MemoryArena::RESOURCE,	// MATERIAL_INSTANCE
+	MemoryManager::MemoryArena::GENERAL,	// RENDERER
+	MemoryManager::MemoryArena::GENERAL,	// GAME
+	MemoryManager::MemoryArena::GENERAL,	// TRANSFORM
+	MemoryManager::MemoryArena::GENERAL,	// ENTITY
+	MemoryManager::MemoryArena::GENERAL,	// ENTITY_NODE
+	MemoryManager::MemoryArena::GENERAL,	// SCENE
+	MemoryManager::MemoryArena::GENERAL,	// INPUT
+	MemoryManager::MemoryArena::TRANSIENT,	// LINEAR_ALLOCATOR
+	MemoryManager::MemoryArena::TRANSIENT,	// FILE
+	MemoryManager::MemoryArena::RESOURCE,	// RESOURCE_MESH
+	MemoryManager::MemoryArena::RESOURCE,	// RESOURCE_TEXTURE
+	MemoryManager::MemoryArena::RESOURCE,	// RESOURCE_MATERIAL
+	MemoryManager::MemoryArena::GENERAL,	// POOL_ALLOCATOR
+	MemoryManager::MemoryArena::GENERAL		// FRAME_ALLOCATOR
 };
 
 static struct MemorySystemConfig config;
 
-void MemoryManager::InitializeMemory(uint64 preAllocatedMemorySize)
+// One lock per arena, threads working on different arenas don't contend.
+static std::mutex arenaMutexes[static_cast<uint64>(MemoryManager::MemoryArena::MAX)];
+
+// ----------------------------------------------------------------------- //
+// Budgets & memory pressure
+// ----------------------------------------------------------------------- //
+
+static const uint32 c_MAX_PRESSURE_CALLBACKS = 32;
+
+struct PressureCallback
 {
-	ZeroMemory(&config, sizeof(config));
+	MemoryManager::MemoryTag tag;
+	MemoryManager::PFN_OnMemoryPressure callback;
+	void* listener;
+};
+
+// Kept apart from config, subsystems may register before InitializeMemory() resets it.
+static PressureCallback pressureCallbacks[c_MAX_PRESSURE_CALLBACKS];
+static uint32 pressureCallbackCount = 0;
+static std::mutex pressureMutex;
+
+static void RaisePressure(MemoryManager::MemoryTag tag, MemoryManager::MemoryPressure pressure)
+{
+	std::atomic<uint32>& pending = config.stats.tags[static_cast<uint64>(tag)].pendingPressure;
+	uint32 current = pending.load(std::memory_order_relaxed);
+
+	while (static_cast<uint32>(pressure) > current && !pending.compare_exchange_weak(current, static_cast<uint32>(pressure), std::memory_order_relaxed)) {}
+}
+
+// Refuses allocations that would take the tag past its hard budget.
+// Concurrent allocations are checked against the same count, so the budget may be overshot by in-flight requests.
+static bool CheckBudget(uint64 size, MemoryManager::MemoryTag tag)
+{
+	TagStats& tagStats = config.stats.tags[static_cast<uint64>(tag)];
+	const uint64 hardLimit = tagStats.hardLimit.load(std::memory_order_relaxed);
+
+	if (hardLimit == 0 || tagStats.bytes.load(std::memory_order_relaxed) + size <= hardLimit) return true;
+
+	NOUS_ERROR("MemoryManager::Allocate() - %s hard budget reached, %" PRIu64 " bytes refused (%" PRIu64 "/%" PRIu64 " used)", 
+		memoryTagStrings[static_cast<uint64>(tag)], size, tagStats.bytes.load(std::memory_order_relaxed), hardLimit);
+
+	tagStats.failedAllocations.fetch_add(1, std::memory_order_relaxed);
+	RaisePressure(tag, MemoryManager::MemoryPressure::HARD_LIMIT);
+
+	return false;
+}
 
-	config.totalAllocationSize = preAllocatedMemorySize;
+static void OnAllocationFailure(uint64 size, MemoryManager::MemoryTag tag)
+{
+	NOUS_ERROR("MemoryManager::Allocate() - %s arena out of memory, %" PRIu64 " bytes refused (%s)", 
+		memoryArenaStrings[static_cast<uint64>(MemoryManager::GetMemoryArena(tag))], size, memoryTagStrings[static_cast<uint64>(tag)]);
 
-	// 1. Get memory requirement FIRST
-	config.allocatorRequirement = DynamicAllocator::GetMemoryRequirement(config.totalAllocationSize);
+	config.stats.tags[static_cast<uint64>(tag)].failedAllocations.fetch_add(1, std::memory_order_relaxed);
+	RaisePressure(tag, MemoryManager::MemoryPressure::HARD_LIMIT);
+}
 
-	// 2. Allocate single block for entire system
-	config.allocatorBlock = malloc(config.allocatorRequirement);
+// Thread InitializeMemory() ran on, the only one pressure callbacks run on
+static std::thread::id mainThreadID;
+static thread_local bool dispatchingPressure = false;
+
+// Lets the tag's callbacks release memory right away so a refused allocation can be retried, instead of waiting
+// for EndFrame(). Only on the main thread, callbacks aren't safe to run concurrently with it, and never from
+// inside a callback. Other threads keep the pressure raised for EndFrame().
+// @return true if a callback ran.
+static bool ReleaseUnderPressure(MemoryManager::MemoryTag tag)
+{
+	if (dispatchingPressure || std::this_thread::get_id() != mainThreadID) return false;
+
+	PressureCallback callbacks[c_MAX_PRESSURE_CALLBACKS];
+	uint32 callbackCount = 0;
 
-	if (!config.allocatorBlock) 
 	{
-		NOUS_FATAL("Memory system allocation failed");
-		return;
+		std::lock_guard<std::mutex> lock(pressureMutex);
+
+		for (uint32 i = 0; i < pressureCallbackCount; ++i)
+		{
+			if (pressureCallbacks[i].tag == tag) callbacks[callbackCount++] = pressureCallbacks[i];
+		}
 	}
 
-	// 3. Construct allocator using placement new
-	config.allocator = new (&config.allocatorBlock) DynamicAllocator(
-		config.totalAllocationSize,
-		config.allocatorBlock
+	if (callbackCount == 0) return false;
+
+	dispatchingPressure = true;
+
+	for (uint32 i = 0; i < callbackCount; ++i)
+	{
+		callbacks[i].callback(tag, MemoryManager::MemoryPressure::HARD_LIMIT, callbacks[i].listener);
+	}
+
+	dispatchingPressure = false;
+
+	return true;
+}
+
+// Runs on the main thread from EndFrame(), callbacks are free to allocate, free or (un)register.
+static void DispatchPressure()
+{
+	PressureCallback callbacks[c_MAX_PRESSURE_CALLBACKS];
+	uint32 callbackCount = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(pressureMutex);
+
+		callbackCount = pressureCallbackCount;
+		std::copy(pressureCallbacks, pressureCallbacks + callbackCount, callbacks);
+	}
+
+	for (uint64 i = 0; i < static_cast<uint64>(MemoryManager::MemoryTag::MAX); ++i)
+	{
+		const MemoryManager::MemoryPressure pressure = static_cast<MemoryManager::MemoryPressure>(config.stats.tags[i].pendingPressure.exchange(0, std::memory_order_relaxed));
+
+		if (pressure == MemoryManager::MemoryPressure::NONE) continue;
+
+		const MemoryManager::MemoryTag tag = static_cast<MemoryManager::MemoryTag>(i);
+
+		NOUS_WARN("Memory pressure on %s (%s): %" PRIu64 " bytes allocated", memoryTagStrings[i], 
+			(pressure == MemoryManager::MemoryPressure::HARD_LIMIT) ? "hard limit" : "soft limit", config.stats.tags[i].bytes.load(std::memory_order_relaxed));
+
+		for (uint32 j = 0; j < callbackCount; ++j)
+		{
+			if (callbacks[j].tag == tag)
+			{
+				callbacks[j].callback(tag, pressure, callbacks[j].listener);
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------------------- //
+// Heap growth
+// ----------------------------------------------------------------------- //
+
+// Minimum amount of memory committed per growth, so growing stays rare.
+static const uint64 c_HEAP_GROWTH_STEP = MiB(32);
+
+// Commits more of the arena's reserved range and hands it to its allocator. The arena mutex must be held.
+static bool GrowHeap(MemoryArenaState& arena, uint64 requestedSize)
+{
+	if (arena.totalAllocationSize >= arena.reserveSize) return false;
+
+	// Extra page covers block headers and alignment padding of the request
+	const uint64 growth = std::max(requestedSize + MemoryManager::c_PAGE_SIZE, c_HEAP_GROWTH_STEP);
+	const uint64 newSize = std::min(VirtualMemory::AlignToPage(arena.totalAllocationSize + growth), arena.reserveSize);
+
+	const uint64 committedEnd = std::min(VirtualMemory::AlignToPage(arena.controlSize + newSize), arena.allocatorRequirement);
+
+	if (committedEnd > arena.committedSize)
+	{
+		char* commitStart = static_cast<char*>(arena.allocatorBlock) + arena.committedSize;
+
+		if (!VirtualMemory::Commit(commitStart, committedEnd - arena.committedSize, config.useHugePages)) return false;
+
+		arena.committedSize = committedEnd;
+	}
+
+	if (!arena.allocator->Grow(newSize)) return false;
+
+	arena.totalAllocationSize = newSize;
+
+	NOUS_DEBUG("Memory arena %s grown to %" PRIu64 " bytes", memoryArenaStrings[&arena - config.arenas], newSize);
+
+	return true;
+}
+
+// Allocates from the arena's allocator, growing the arena once if it's full. The arena mutex must be held.
+static void* AllocateFromHeap(MemoryArenaState& arena, uint64 size)
+{
+	void* block = arena.allocator->Allocate(size);
+
+	if (!block && GrowHeap(arena, size))
+	{
+		block = arena.allocator->Allocate(size);
+	}
+
+	return block;
+}
+
+// Finds the arena whose address range holds block, MAX if none does.
+// Frees are routed by address rather than by tag, so a block freed with a different tag still reaches its arena.
+static uint64 FindArena(const void* block)
+{
+	const char* address = static_cast<const char*>(block);
+
+	for (uint64 i = 0; i < static_cast<uint64>(MemoryManager::MemoryArena::MAX); ++i)
+	{
+		const MemoryArenaState& arena = config.arenas[i];
+		const char* start = static_cast<const char*>(arena.allocatorBlock);
+
+		if (arena.allocator && address >= start && address < start + arena.allocatorRequirement)
+		{
+			return i;
+		}
+	}
+
+	return static_cast<uint64>(MemoryManager::MemoryArena::MAX);
+}
+
+// ----------------------------------------------------------------------- //
+// Thread-local allocation caches
+// ----------------------------------------------------------------------- //
+
+// Every block is rounded up to this many bytes before reaching the DynamicAllocator.
+static const uint64 c_ALLOCATION_ALIGNMENT = 16;
+
+// Blocks up to this size are served from per-thread magazines (one magazine per 16-byte size class).
+static const uint64 c_MAX_CACHED_SIZE = 256;
+static const uint64 c_SIZE_CLASS_COUNT = c_MAX_CACHED_SIZE / c_ALLOCATION_ALIGNMENT;
+
+// Magazine capacity and the amount of blocks moved from/to the DynamicAllocator per lock acquisition.
+static const uint32 c_MAGAZINE_CAPACITY = 64;
+static const uint32 c_MAGAZINE_BATCH = 32;
+
+static uint64 AlignSize(uint64 size)
+{
+	return (size + (c_ALLOCATION_ALIGNMENT - 1)) & ~(c_ALLOCATION_ALIGNMENT - 1);
+}
+
+struct ThreadCache
+{
+	struct Magazine
+	{
+		void* blocks[c_MAGAZINE_CAPACITY];
+		uint32 count;
+	};
+
+	// Blocks of different arenas never mix, each arena has its own set of magazines.
+	Magazine magazines[static_cast<uint64>(MemoryManager::MemoryArena::MAX)][c_SIZE_CLASS_COUNT];
+
+	ThreadCache() 
+	{
+		MemoryManager::ZeroMemory(magazines, sizeof(magazines));
+	}
+
+	// Blocks still cached when a thread exits are handed back to the arenas.
+	~ThreadCache()
+	{
+		Flush();
+	}
+
+	void* Pop(uint64 arena, uint64 sizeClass)
+	{
+		Magazine& magazine = magazines[arena][sizeClass];
+
+		if (magazine.count == 0)
+		{
+			Refill(arena, sizeClass);
+
+			if (magazine.count == 0) return nullptr;
+		}
+
+		return magazine.blocks[--magazine.count];
+	}
+
+	void Push(uint64 arena, uint64 sizeClass, void* block)
+	{
+		Magazine& magazine = magazines[arena][sizeClass];
+
+		if (magazine.count == c_MAGAZINE_CAPACITY)
+		{
+			Drain(arena, sizeClass, c_MAGAZINE_BATCH);
+		}
+
+		magazine.blocks[magazine.count++] = block;
+	}
+
+	void Flush()
+	{
+		for (uint64 arena = 0; arena < static_cast<uint64>(MemoryManager::MemoryArena::MAX); ++arena)
+		{
+			for (uint64 i = 0; i < c_SIZE_CLASS_COUNT; ++i)
+			{
+				Drain(arena, i, magazines[arena][i].count);
+			}
+		}
+	}
+
+private:
+
+	void Refill(uint64 arena, uint64 sizeClass)
+	{
+		Magazine& magazine = magazines[arena][sizeClass];
+		const uint64 blockSize = (sizeClass + 1) * c_ALLOCATION_ALIGNMENT;
+
+		std::lock_guard<std::mutex> lock(arenaMutexes[arena]);
+
+		if (!config.arenas[arena].allocator) return;
+
+		while (magazine.count < c_MAGAZINE_BATCH)
+		{
+			void* block = AllocateFromHeap(config.arenas[arena], blockSize);
+
+			if (!block) break;
+
+			magazine.blocks[magazine.count++] = block;
+		}
+	}
+
+	void Drain(uint64 arena, uint64 sizeClass, uint32 amount)
+	{
+		Magazine& magazine = magazines[arena][sizeClass];
+		const uint64 blockSize = (sizeClass + 1) * c_ALLOCATION_ALIGNMENT;
+
+		if (amount == 0) return;
+
+		std::lock_guard<std::mutex> lock(arenaMutexes[arena]);
+
+		for (uint32 i = 0; i < amount && magazine.count > 0; ++i)
+		{
+			void* block = magazine.blocks[--magazine.count];
+
+			// The allocator is gone after ShutdownMemory(), its backing block has already been released.
+			if (config.arenas[arena].allocator) 
+			{
+				config.arenas[arena].allocator->Free(block, blockSize);
+			}
+		}
+	}
+};
+
+static thread_local ThreadCache threadCache;
+
+// Counters only read by snapshots, batched per thread so allocating threads don't fight over the same cache lines.
+// Byte counts stay global, budgets and peaks need them exact. Folded into config.stats every c_TELEMETRY_BATCH 
+// events, when the thread exits, and for the calling thread by EndFrame(), GetMemorySnapshot() and ShutdownMemory().
+static const uint32 c_TELEMETRY_BATCH = 64;
+
+struct ThreadTelemetry
+{
+	// Deltas, a thread freeing blocks other threads allocated goes below 0 and wraps around
+	uint64 liveAllocations = 0;
+	uint64 tagLiveAllocations[static_cast<uint64>(MemoryManager::MemoryTag::MAX)] = {};
+	uint64 tagTotalAllocations[static_cast<uint64>(MemoryManager::MemoryTag::MAX)] = {};
+
+	uint64 sizeHistogram[MemoryManager::c_SIZE_HISTOGRAM_BUCKETS] = {};
+
+	uint64 frameAllocations = 0;
+	uint64 frameAllocatedBytes = 0;
+	uint64 frameFrees = 0;
+	uint64 frameFreedBytes = 0;
+
+	uint32 pendingEvents = 0;
+
+	~ThreadTelemetry()
+	{
+		Flush();
+	}
+
+	void OnEvent()
+	{
+		if (++pendingEvents == c_TELEMETRY_BATCH) Flush();
+	}
+
+	void Flush()
+	{
+		if (pendingEvents == 0) return;
+
+		MemoryStats& stats = config.stats;
+
+		stats.totalAllocations.fetch_add(liveAllocations, std::memory_order_relaxed);
+
+		for (uint64 i = 0; i < static_cast<uint64>(MemoryManager::MemoryTag::MAX); ++i)
+		{
+			if (tagLiveAllocations[i] != 0) stats.tags[i].liveAllocations.fetch_add(tagLiveAllocations[i], std::memory_order_relaxed);
+			if (tagTotalAllocations[i] != 0) stats.tags[i].totalAllocations.fetch_add(tagTotalAllocations[i], std::memory_order_relaxed);
+		}
+
+		for (uint32 i = 0; i < MemoryManager::c_SIZE_HISTOGRAM_BUCKETS; ++i)
+		{
+			if (sizeHistogram[i] != 0) stats.sizeHistogram[i].fetch_add(sizeHistogram[i], std::memory_order_relaxed);
+		}
+
+		stats.currentFrame.allocations.fetch_add(frameAllocations, std::memory_order_relaxed);
+		stats.currentFrame.allocatedBytes.fetch_add(frameAllocatedBytes, std::memory_order_relaxed);
+		stats.currentFrame.frees.fetch_add(frameFrees, std::memory_order_relaxed);
+		stats.currentFrame.freedBytes.fetch_add(frameFreedBytes, std::memory_order_relaxed);
+
+		*this = ThreadTelemetry();
+	}
+};
+
+static thread_local ThreadTelemetry threadTelemetry;
+
+// Reserves the arena's address range and builds its allocator over it.
+static bool InitializeArena(MemoryArenaState& arena, const MemoryManager::ArenaConfig& arenaConfig, DynamicAllocatorType allocatorType)
+{
+	arena.reserveSize = VirtualMemory::AlignToPage(std::max(arenaConfig.reserveSize, arenaConfig.initialSize));
+	arena.totalAllocationSize = std::min(VirtualMemory::AlignToPage(arenaConfig.initialSize), arena.reserveSize);
+
+	// 1. Get memory requirement FIRST, the allocator is laid out for the whole reserve
+	arena.controlSize = DynamicAllocator::GetControlRequirement(arena.reserveSize, allocatorType);
+	arena.allocatorRequirement = VirtualMemory::AlignToPage(arena.controlSize + arena.reserveSize);
+
+	// 2. Reserve the address range for the entire arena, nothing is backed by physical memory yet
+	arena.allocatorBlock = VirtualMemory::Reserve(arena.allocatorRequirement);
+
+	if (!arena.allocatorBlock) 
+	{
+		NOUS_FATAL("Memory arena allocation failed");
+		return false;
+	}
+
+	// 3. Commit the control structures and the initial heap, pages are only backed once touched
+	arena.committedSize = std::min(VirtualMemory::AlignToPage(arena.controlSize + arena.totalAllocationSize), arena.allocatorRequirement);
+
+	if (!VirtualMemory::Commit(arena.allocatorBlock, arena.committedSize, config.useHugePages))
+	{
+		NOUS_FATAL("Memory arena commit failed");
+		return false;
+	}
+
+	// 4. Construct allocator using placement new
+	arena.allocator = new (&arena.allocatorBlock) DynamicAllocator(
+		arena.totalAllocationSize,
+		arena.allocatorBlock,
+		allocatorType,
+		arena.reserveSize
 	);
 
-	NOUS_DEBUG("Memory system initialized with %llu bytes", config.totalAllocationSize);
+	return true;
+}
+
+void MemoryManager::InitializeMemory(const MemoryConfig& memoryConfig)
+{
+	ZeroMemory(&config, sizeof(config));
+
+	mainThreadID = std::this_thread::get_id();
+
+	config.useHugePages = memoryConfig.useHugePages;
+
+	for (uint64 i = 0; i < static_cast<uint64>(MemoryTag::MAX); ++i)
+	{
+		SetMemoryBudget(static_cast<MemoryTag>(i), memoryConfig.budgets[i]);
+	}
+
+	for (uint64 i = 0; i < static_cast<uint64>(MemoryArena::MAX); ++i)
+	{
+		MemoryArenaState& arena = config.arenas[i];
+
+		if (!InitializeArena(arena, memoryConfig.arenas[i], memoryConfig.allocatorType)) return;
+
+		config.stats.arenaCapacity[i].store(arena.totalAllocationSize, std::memory_order_relaxed);
+
+		NOUS_DEBUG("Memory arena %s initialized with %" PRIu64 " bytes (%" PRIu64 " bytes reserved)", memoryArenaStrings[i], arena.totalAllocationSize, arena.reserveSize);
+	}
 }
 
 void MemoryManager::ShutdownMemory()
 {
-	if (config.allocator) 
+	// Worker threads flushed their caches and counters on exit, only the calling thread may still hold some.
+	threadCache.Flush();
+	threadTelemetry.Flush();
+
+	for (uint64 i = 0; i < static_cast<uint64>(MemoryArena::MAX); ++i)
 	{
-		// Explicit destructor call
-		config.allocator->~DynamicAllocator();
-		free(config.allocatorBlock);
+		MemoryArenaState& arena = config.arenas[i];
+
+		if (arena.allocator) 
+		{
+			// Explicit destructor call
+			arena.allocator->~DynamicAllocator();
+			VirtualMemory::Release(arena.allocatorBlock, arena.allocatorRequirement);
 
-		config.allocatorBlock = nullptr;
-		config.allocator = nullptr;
+			arena.allocatorBlock = nullptr;
+			arena.allocator = nullptr;
+		}
 	}
 
 	// ----------------------------------------------------------------------- //
@@ -107,39 +629,169 @@ void MemoryManager::ShutdownMemory()
 	for (uint32 i = 0; i < static_cast<uint64>(MemoryTag::MAX); ++i)
 	{
 		tag = static_cast<MemoryTag>(i);
-		amount = static_cast<float>(config.stats.taggedAllocations[i]);
+		amount = static_cast<float>(config.stats.tags[i].bytes);
 		
 		NOUS_ASSERT_MSG(amount == 0.0f, "Memory Leaks Detected!");
 	}
 
 	NOUS_ASSERT(config.stats.totalAllocations == 0);
 	NOUS_ASSERT(config.stats.totalAllocated == 0);
+	NOUS_ASSERT(config.stats.externalCommitted == 0);
 
 	// ----------------------------------------------------------------------- //
 }
 
-void* MemoryManager::Allocate(uint64 size, MemoryTag tag = MemoryTag::UNKNOWN)
+// Takes a block of (already 16-byte aligned) size from the thread cache or the arena serving tag.
+static void* AcquireBlock(uint64 alignedSize, MemoryManager::MemoryTag tag)
 {
-	std::lock_guard<std::mutex> lock(memoryMutex);
+	const uint64 arena = static_cast<uint64>(MemoryManager::GetMemoryArena(tag));
+	void* block = nullptr;
+
+	// Small blocks come from the calling thread's cache, which only locks when it needs a refill.
+	if (alignedSize > 0 && alignedSize <= c_MAX_CACHED_SIZE)
+	{
+		block = threadCache.Pop(arena, alignedSize / c_ALLOCATION_ALIGNMENT - 1);
+	}
 
-	if (tag == MemoryTag::UNKNOWN) 
+	if (!block)
+	{
+		std::lock_guard<std::mutex> lock(arenaMutexes[arena]);
+		block = AllocateFromHeap(config.arenas[arena], alignedSize);
+	}
+
+	return block;
+}
+
+static void ReleaseBlock(void* block, uint64 alignedSize)
+{
+	const uint64 arena = FindArena(block);
+
+	if (arena == static_cast<uint64>(MemoryManager::MemoryArena::MAX))
+	{
+		NOUS_ERROR("MemoryManager::Free() ERROR: Block doesn't belong to any memory arena");
+		return;
+	}
+
+	// Blocks freed from another thread simply migrate into this thread's cache.
+	if (alignedSize > 0 && alignedSize <= c_MAX_CACHED_SIZE)
+	{
+		threadCache.Push(arena, alignedSize / c_ALLOCATION_ALIGNMENT - 1, block);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(arenaMutexes[arena]);
+	config.arenas[arena].allocator->Free(block, alignedSize);
+}
+
+static void UpdatePeak(std::atomic<uint64>& peak, uint64 value)
+{
+	uint64 current = peak.load(std::memory_order_relaxed);
+
+	while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+static uint32 GetSizeHistogramBucket(uint64 size)
+{
+	const uint32 bucket = (size <= 16) ? 0 : static_cast<uint32>(std::bit_width((size - 1) >> 4));
+	return std::min(bucket, MemoryManager::c_SIZE_HISTOGRAM_BUCKETS - 1);
+}
+
+static void TrackAllocation(uint64 size, MemoryManager::MemoryTag tag)
+{
+	if (tag == MemoryManager::MemoryTag::UNKNOWN) 
 	{
 		NOUS_WARN("Memory Allocation called using MEMORY_TAG_UNKNOWN.");
 	}
 
-	config.stats.totalAllocated += size;
-	config.stats.totalAllocations++;
-	config.stats.taggedAllocations[static_cast<uint64>(tag)] += size;
+	TagStats& tagStats = config.stats.tags[static_cast<uint64>(tag)];
+
+	const uint64 total = config.stats.totalAllocated.fetch_add(size, std::memory_order_relaxed) + size;
+	const uint64 tagged = tagStats.bytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+	UpdatePeak(config.stats.peakAllocated, total);
+	UpdatePeak(tagStats.peakBytes, tagged);
+
+	// Only the allocation crossing the soft limit raises pressure, not every allocation above it
+	const uint64 softLimit = tagStats.softLimit.load(std::memory_order_relaxed);
+
+	if (softLimit > 0 && tagged > softLimit && tagged - size <= softLimit)
+	{
+		RaisePressure(tag, MemoryManager::MemoryPressure::SOFT_LIMIT);
+	}
+
+	const uint64 tagIndex = static_cast<uint64>(tag);
+
+	threadTelemetry.liveAllocations++;
+	threadTelemetry.tagLiveAllocations[tagIndex]++;
+	threadTelemetry.tagTotalAllocations[tagIndex]++;
+	threadTelemetry.sizeHistogram[GetSizeHistogramBucket(size)]++;
+	threadTelemetry.frameAllocations++;
+	threadTelemetry.frameAllocatedBytes += size;
+	threadTelemetry.OnEvent();
+}
+
+static void TrackFree(uint64 size, MemoryManager::MemoryTag tag)
+{
+	if (tag == MemoryManager::MemoryTag::UNKNOWN)
+	{
+		NOUS_WARN("Memory Free called using MEMORY_TAG_UNKNOWN.");
+	}
+
+	TagStats& tagStats = config.stats.tags[static_cast<uint64>(tag)];
+
+	config.stats.totalAllocated.fetch_sub(size, std::memory_order_relaxed);
+	tagStats.bytes.fetch_sub(size, std::memory_order_relaxed);
+
+	threadTelemetry.liveAllocations--;
+	threadTelemetry.tagLiveAllocations[static_cast<uint64>(tag)]--;
+	threadTelemetry.frameFrees++;
+	threadTelemetry.frameFreedBytes += size;
+	threadTelemetry.OnEvent();
+}
+
+// Budget check, then a block of alignedSize from the tag's arena. nullptr if either refuses.
+static void* TryAcquireBlock(uint64 size, uint64 alignedSize, MemoryManager::MemoryTag tag)
+{
+	if (!CheckBudget(size, tag)) return nullptr;
+
+	void* block = AcquireBlock(alignedSize, tag);
 
+	if (!block) OnAllocationFailure(size, tag);
+
+	return block;
+}
+
+// A refused allocation is retried once after the tag's pressure callbacks released what they could.
+static void* AcquireBlockUnderPressure(uint64 size, uint64 alignedSize, MemoryManager::MemoryTag tag)
+{
+	void* block = TryAcquireBlock(size, alignedSize, tag);
+
+	if (!block && ReleaseUnderPressure(tag))
+	{
+		block = TryAcquireBlock(size, alignedSize, tag);
+	}
+
+	return block;
+}
+
+void* MemoryManager::Allocate(uint64 size, MemoryTag tag, AllocationFlags flags)
+{
 	//void* block = malloc(size);
 	
 	// ----------------- Memory Alignment ----------------- //
 	// Add 16-byte alignment
-	const uint64 alignment = 16;
-	const uint64 alignedSize = (size + (alignment - 1)) & ~(alignment - 1);
+	void* block = AcquireBlockUnderPressure(size, AlignSize(size), tag);
+
+	if (!block) return nullptr;
 
-	void* block = config.allocator->Allocate(alignedSize);
-	ZeroMemory(block, size);
+	TrackAllocation(size, tag);
+
+	if (!HasFlag(flags, AllocationFlags::UNINITIALIZED))
+	{
+		ZeroMemory(block, size);
+	}
+
+	AllocationTrace::Record(AllocationTrace::EventType::ALLOCATE, block, size, c_ALLOCATION_ALIGNMENT, tag);
 
 #ifdef _PROFILING
 	TracyAlloc(block, size);
@@ -148,18 +800,48 @@ void* MemoryManager::Allocate(uint64 size, MemoryTag tag = MemoryTag::UNKNOWN)
 	return block;
 }
 
-void MemoryManager::Free(void* block, uint64 size, MemoryTag tag = MemoryTag::UNKNOWN)
+void* MemoryManager::AllocateAligned(uint64 size, uint64 alignment, MemoryTag tag, AllocationFlags flags)
 {
-	std::lock_guard<std::mutex> lock(memoryMutex);
+	NOUS_ASSERT_MSG(alignment != 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two.");
 
-	if (tag == MemoryTag::UNKNOWN)
+	// Every block is already 16-byte aligned
+	if (alignment <= c_ALLOCATION_ALIGNMENT)
 	{
-		NOUS_WARN("Memory Free called using MEMORY_TAG_UNKNOWN.");
+		return Allocate(size, tag, flags);
+	}
+
+	// Over-allocate by the alignment and keep the original address right before the aligned block.
+	// Base blocks are 16-byte aligned, so there's always room for it within the padding.
+	char* base = static_cast<char*>(AcquireBlockUnderPressure(size, AlignSize(size + alignment), tag));
+
+	if (!base) return nullptr;
+
+	TrackAllocation(size, tag);
+
+	const uintptr_t aligned = (reinterpret_cast<uintptr_t>(base) + sizeof(void*) + (alignment - 1)) & ~(alignment - 1);
+	void* block = reinterpret_cast<void*>(aligned);
+
+	reinterpret_cast<void**>(block)[-1] = base;
+
+	if (!HasFlag(flags, AllocationFlags::UNINITIALIZED))
+	{
+		ZeroMemory(block, size);
 	}
 
-	config.stats.totalAllocated -= size;
-	config.stats.totalAllocations--;
-	config.stats.taggedAllocations[static_cast<uint64>(tag)] -= size;
+	AllocationTrace::Record(AllocationTrace::EventType::ALLOCATE, block, size, alignment, tag);
+
+#ifdef _PROFILING
+	TracyAlloc(block, size);
+#endif // _PROFILING
+
+	return block;
+}
+
+void MemoryManager::Free(void* block, uint64 size, MemoryTag tag = MemoryTag::UNKNOWN)
+{
+	TrackFree(size, tag);
+
+	AllocationTrace::Record(AllocationTrace::EventType::FREE, block, size, c_ALLOCATION_ALIGNMENT, tag);
 
 #ifdef _PROFILING
 	TracyFree(block);
@@ -168,9 +850,51 @@ void MemoryManager::Free(void* block, uint64 size, MemoryTag tag = MemoryTag::UN
 	//free(block);
 
 	// ----------------- Memory Alignment ----------------- //
-	const uint64 alignment = 16;
-	const uint64 alignedSize = (size + (alignment - 1)) & ~(alignment - 1);
-	config.allocator->Free(block, alignedSize);
+	ReleaseBlock(block, AlignSize(size));
+}
+
+void MemoryManager::FreeAligned(void* block, uint64 size, uint64 alignment, MemoryTag tag)
+{
+	if (alignment <= c_ALLOCATION_ALIGNMENT)
+	{
+		Free(block, size, tag);
+		return;
+	}
+
+	TrackFree(size, tag);
+
+	AllocationTrace::Record(AllocationTrace::EventType::FREE, block, size, alignment, tag);
+
+#ifdef _PROFILING
+	TracyFree(block);
+#endif // _PROFILING
+
+	void* base = reinterpret_cast<void**>(block)[-1];
+	ReleaseBlock(base, AlignSize(size + alignment));
+}
+
+bool MemoryManager::TrackExternalAllocation(uint64 size, MemoryTag tag)
+{
+	if (!CheckBudget(size, tag)) return false;
+
+	TrackAllocation(size, tag);
+
+	return true;
+}
+
+void MemoryManager::TrackExternalFree(uint64 size, MemoryTag tag)
+{
+	TrackFree(size, tag);
+}
+
+void MemoryManager::TrackExternalCommit(uint64 size)
+{
+	config.stats.externalCommitted.fetch_add(size, std::memory_order_relaxed);
+}
+
+void MemoryManager::TrackExternalDecommit(uint64 size)
+{
+	config.stats.externalCommitted.fetch_sub(size, std::memory_order_relaxed);
 }
 
 void* MemoryManager::ZeroMemory(void* block, uint64 size)
@@ -188,84 +912,268 @@ void* MemoryManager::SetMemory(void* destination, int32 value, uint64 size)
 	return std::memset(destination, value, size);
 }
 
-char* MemoryManager::GetMemoryUsageStats()
+// Picks the largest unit that keeps the amount above 1. Doubles keep byte counts past 16 MiB exact enough.
+static double FormatBytes(uint64 bytes, const char** outUnit)
 {
 	const uint64 GiB = 1024 * 1024 * 1024;
 	const uint64 MiB = 1024 * 1024;
 	const uint64 KiB = 1024;
 
+	if (bytes >= GiB) { *outUnit = "GiB"; return static_cast<double>(bytes) / GiB; }
+	if (bytes >= MiB) { *outUnit = "MiB"; return static_cast<double>(bytes) / MiB; }
+	if (bytes >= KiB) { *outUnit = "KiB"; return static_cast<double>(bytes) / KiB; }
+
+	*outUnit = "B";
+	return static_cast<double>(bytes);
+}
+
+std::string MemoryManager::GetMemoryUsageStats()
+{
+	MemorySnapshot snapshot;
+	GetMemorySnapshot(&snapshot);
+
 	char buffer[8000] = "System memory use (tagged):\n";
-	uint64 offset = strlen(buffer);
+	uint64 offset = std::strlen(buffer);
+
+	const char* unit = nullptr;
+	const char* peakUnit = nullptr;
+	double amount = 0.0;
+	double peakAmount = 0.0;
 
 	// Log total size allocated in appropriate units
-	char totalUnit[4] = "XiB";
-	float totalAmount = 1.0f;
+	amount = FormatBytes(snapshot.totalAllocated, &unit);
+	peakAmount = FormatBytes(snapshot.peakAllocated, &peakUnit);
+
+	offset += snprintf(buffer + offset, sizeof(buffer) - offset, "\nTotal size allocated: %.2f %s (peak %.2f %s)\n", amount, unit, peakAmount, peakUnit);
+
+	// Log total allocations
+	offset += snprintf(buffer + offset, sizeof(buffer) - offset, "Total allocations: %" PRIu64 "\n\n", snapshot.liveAllocations);
+
+	// Log allocations by tag
+	for (uint32 i = 0; i < static_cast<uint64>(MemoryTag::MAX) && offset < sizeof(buffer); ++i)
+	{
+		amount = FormatBytes(snapshot.tags[i].bytes, &unit);
+		peakAmount = FormatBytes(snapshot.tags[i].peakBytes, &peakUnit);
+
+		offset += snprintf(buffer + offset, sizeof(buffer) - offset, "%-20s: %.2f %s (peak %.2f %s)", memoryTagStrings[i], amount, unit, peakAmount, peakUnit);
+
+		if (snapshot.tags[i].budget.softLimit > 0 || snapshot.tags[i].budget.hardLimit > 0)
+		{
+			const char* softUnit = nullptr;
+			const char* hardUnit = nullptr;
+			const double soft = FormatBytes(snapshot.tags[i].budget.softLimit, &softUnit);
+			const double hard = FormatBytes(snapshot.tags[i].budget.hardLimit, &hardUnit);
+
+			offset += snprintf(buffer + offset, sizeof(buffer) - offset, " [budget %.2f %s / %.2f %s, %" PRIu64 " refused]", 
+				soft, softUnit, hard, hardUnit, snapshot.tags[i].failedAllocations);
+		}
+
+		offset += snprintf(buffer + offset, sizeof(buffer) - offset, "\n");
+ 	}
+
+	// Log arenas
+	offset += snprintf(buffer + offset, sizeof(buffer) - offset, "\nMemory arenas:\n");
+
+	for (uint32 i = 0; i < static_cast<uint64>(MemoryArena::MAX) && offset < sizeof(buffer); ++i)
+	{
+		const char* capacityUnit = nullptr;
+
+		amount = FormatBytes(snapshot.arenas[i].capacity - snapshot.arenas[i].freeSpace, &unit);
+		const double capacity = FormatBytes(snapshot.arenas[i].capacity, &capacityUnit);
+
+		offset += snprintf(buffer + offset, sizeof(buffer) - offset, "%-20s: %.2f %s used of %.2f %s (%.1f%% fragmented)\n", 
+			memoryArenaStrings[i], amount, unit, capacity, capacityUnit, snapshot.arenas[i].fragmentation * 100.0f);
+	}
+
+	amount = FormatBytes(snapshot.externalCommitted, &unit);
+
+	offset += snprintf(buffer + offset, sizeof(buffer) - offset, "%-20s: %.2f %s committed\n", "Outside arenas", amount, unit);
+
+	return std::string(buffer);
+}
+
+uint64 MemoryManager::GetMemoryAllocationCount()
+{
+	threadTelemetry.Flush();
+
+	return config.stats.totalAllocations;
+}
+
+void MemoryManager::EndFrame()
+{
+	FrameStats& current = config.stats.currentFrame;
+	FrameStats& last = config.stats.lastFrame;
+
+	// Other threads' counters land within c_TELEMETRY_BATCH events, the main thread's go into this frame
+	threadTelemetry.Flush();
+
+	last.allocations.store(current.allocations.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	last.allocatedBytes.store(current.allocatedBytes.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	last.frees.store(current.frees.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	last.freedBytes.store(current.freedBytes.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+
+	config.stats.frameIndex.fetch_add(1, std::memory_order_relaxed);
+
+	// Walking the allocators needs their locks, so readers only get the figures cached here once per frame
+	for (uint64 i = 0; i < static_cast<uint64>(MemoryArena::MAX); ++i)
+	{
+		MemoryArenaState& arena = config.arenas[i];
+
+		std::lock_guard<std::mutex> lock(arenaMutexes[i]);
+
+		if (arena.allocator)
+		{
+			config.stats.arenaFreeSpace[i].store(arena.allocator->GetFreeSpace(), std::memory_order_relaxed);
+			config.stats.arenaLargestFreeBlock[i].store(arena.allocator->GetLargestFreeBlock(), std::memory_order_relaxed);
+			config.stats.arenaCapacity[i].store(arena.totalAllocationSize, std::memory_order_relaxed);
+		}
+	}
+
+	DispatchPressure();
+}
+
+void MemoryManager::GetMemorySnapshot(MemorySnapshot* outSnapshot)
+{
+	if (!outSnapshot) return;
 
-	if (config.stats.totalAllocated >= GiB)
+	threadTelemetry.Flush();
+
+	const MemoryStats& stats = config.stats;
+
+	outSnapshot->frameIndex = stats.frameIndex.load(std::memory_order_relaxed);
+
+	outSnapshot->totalAllocated = stats.totalAllocated.load(std::memory_order_relaxed);
+	outSnapshot->peakAllocated = stats.peakAllocated.load(std::memory_order_relaxed);
+	outSnapshot->liveAllocations = stats.totalAllocations.load(std::memory_order_relaxed);
+
+	outSnapshot->frameAllocations = stats.lastFrame.allocations.load(std::memory_order_relaxed);
+	outSnapshot->frameAllocatedBytes = stats.lastFrame.allocatedBytes.load(std::memory_order_relaxed);
+	outSnapshot->frameFrees = stats.lastFrame.frees.load(std::memory_order_relaxed);
+	outSnapshot->frameFreedBytes = stats.lastFrame.freedBytes.load(std::memory_order_relaxed);
+
+	for (uint64 i = 0; i < static_cast<uint64>(MemoryTag::MAX); ++i)
 	{
-		totalUnit[0] = 'G';
-		totalAmount = config.stats.totalAllocated / static_cast<float>(GiB);
+		outSnapshot->tags[i].bytes = stats.tags[i].bytes.load(std::memory_order_relaxed);
+		outSnapshot->tags[i].peakBytes = stats.tags[i].peakBytes.load(std::memory_order_relaxed);
+		outSnapshot->tags[i].liveAllocations = stats.tags[i].liveAllocations.load(std::memory_order_relaxed);
+		outSnapshot->tags[i].totalAllocations = stats.tags[i].totalAllocations.load(std::memory_order_relaxed);
+		outSnapshot->tags[i].failedAllocations = stats.tags[i].failedAllocations.load(std::memory_order_relaxed);
+		outSnapshot->tags[i].budget.softLimit = stats.tags[i].softLimit.load(std::memory_order_relaxed);
+		outSnapshot->tags[i].budget.hardLimit = stats.tags[i].hardLimit.load(std::memory_order_relaxed);
 	}
-	else if (config.stats.totalAllocated >= MiB)
+
+	for (uint32 i = 0; i < c_SIZE_HISTOGRAM_BUCKETS; ++i)
 	{
-		totalUnit[0] = 'M';
-		totalAmount = config.stats.totalAllocated / static_cast<float>(MiB);
+		outSnapshot->sizeHistogram[i] = stats.sizeHistogram[i].load(std::memory_order_relaxed);
 	}
-	else if (config.stats.totalAllocated >= KiB)
+
+	outSnapshot->heapCapacity = 0;
+	outSnapshot->heapReserved = 0;
+	outSnapshot->heapFreeSpace = 0;
+	outSnapshot->heapLargestFreeBlock = 0;
+
+	for (uint64 i = 0; i < static_cast<uint64>(MemoryArena::MAX); ++i)
 	{
-		totalUnit[0] = 'K';
-		totalAmount = config.stats.totalAllocated / static_cast<float>(KiB);
+		ArenaUsage& arena = outSnapshot->arenas[i];
+
+		arena.capacity = stats.arenaCapacity[i].load(std::memory_order_relaxed);
+		arena.reserved = config.arenas[i].reserveSize;
+		arena.freeSpace = stats.arenaFreeSpace[i].load(std::memory_order_relaxed);
+		arena.largestFreeBlock = stats.arenaLargestFreeBlock[i].load(std::memory_order_relaxed);
+		arena.fragmentation = (arena.freeSpace > 0) ? static_cast<float>(1.0 - static_cast<double>(arena.largestFreeBlock) / arena.freeSpace) : 0.0f;
+
+		outSnapshot->heapCapacity += arena.capacity;
+		outSnapshot->heapReserved += arena.reserved;
+		outSnapshot->heapFreeSpace += arena.freeSpace;
+		outSnapshot->heapLargestFreeBlock = std::max(outSnapshot->heapLargestFreeBlock, arena.largestFreeBlock);
 	}
-	else
+
+	// Free space split across arenas isn't fragmentation, the total is weighted by each arena's free space instead
+	double weightedFragmentation = 0.0;
+
+	for (uint64 i = 0; i < static_cast<uint64>(MemoryArena::MAX); ++i)
 	{
-		totalUnit[0] = 'B';
-		totalUnit[1] = 0;
-		totalAmount = static_cast<float>(config.stats.totalAllocated);
+		weightedFragmentation += outSnapshot->arenas[i].fragmentation * static_cast<double>(outSnapshot->arenas[i].freeSpace);
 	}
 
-	snprintf(buffer + offset, 8000 - offset, "\nTotal size allocated: %.2f %s\n", totalAmount, totalUnit);
-	offset += strlen(buffer + offset);
+	outSnapshot->heapFragmentation = (outSnapshot->heapFreeSpace > 0) ? static_cast<float>(weightedFragmentation / outSnapshot->heapFreeSpace) : 0.0f;
 
-	// Log total allocations
-	snprintf(buffer + offset, 8000 - offset, "Total allocations: %llu\n\n", config.stats.totalAllocations);
-	offset += strlen(buffer + offset);
+	outSnapshot->externalCommitted = stats.externalCommitted.load(std::memory_order_relaxed);
+}
 
-	// Log allocations by tag
-	for (uint32 i = 0; i < static_cast<uint64>(MemoryTag::MAX); ++i)
+const char* MemoryManager::GetMemoryTagName(MemoryTag tag)
+{
+	return (tag < MemoryTag::MAX) ? memoryTagStrings[static_cast<uint64>(tag)] : "INVALID";
+}
+
+void MemoryManager::SetMemoryBudget(MemoryTag tag, const TagBudget& budget)
+{
+	if (tag >= MemoryTag::MAX) return;
+
+	NOUS_ASSERT_MSG(budget.hardLimit == 0 || budget.softLimit <= budget.hardLimit, "Soft budget above the hard budget.");
+
+	TagStats& tagStats = config.stats.tags[static_cast<uint64>(tag)];
+
+	tagStats.softLimit.store(budget.softLimit, std::memory_order_relaxed);
+	tagStats.hardLimit.store(budget.hardLimit, std::memory_order_relaxed);
+}
+
+MemoryManager::TagBudget MemoryManager::GetMemoryBudget(MemoryTag tag)
+{
+	TagBudget budget;
+
+	if (tag < MemoryTag::MAX)
+	{
+		budget.softLimit = config.stats.tags[static_cast<uint64>(tag)].softLimit.load(std::memory_order_relaxed);
+		budget.hardLimit = config.stats.tags[static_cast<uint64>(tag)].hardLimit.load(std::memory_order_relaxed);
+	}
+
+	return budget;
+}
+
+bool MemoryManager::RegisterPressureCallback(MemoryTag tag, PFN_OnMemoryPressure callback, void* listener)
+{
+	std::lock_guard<std::mutex> lock(pressureMutex);
+
+	if (pressureCallbackCount == c_MAX_PRESSURE_CALLBACKS)
 	{
-		char unit[4] = "XiB";
-		float amount = 1.0f;
+		NOUS_ERROR("MemoryManager::RegisterPressureCallback() - Callback table is full (%u)", c_MAX_PRESSURE_CALLBACKS);
+		return false;
+	}
 
-		if (config.stats.taggedAllocations[i] >= GiB)
-		{
-			unit[0] = 'G';
-			amount = config.stats.taggedAllocations[i] / static_cast<float>(GiB);
-		}
-		else if (config.stats.taggedAllocations[i] >= MiB)
-		{
-			unit[0] = 'M';
-			amount = config.stats.taggedAllocations[i] / static_cast<float>(MiB);
-		}
-		else if (config.stats.taggedAllocations[i] >= KiB)
-		{
-			unit[0] = 'K';
-			amount = config.stats.taggedAllocations[i] / static_cast<float>(KiB);
-		}
-		else 
+	pressureCallbacks[pressureCallbackCount++] = { tag, callback, listener };
+
+	return true;
+}
+
+void MemoryManager::UnregisterPressureCallback(MemoryTag tag, PFN_OnMemoryPressure callback, void* listener)
+{
+	std::lock_guard<std::mutex> lock(pressureMutex);
+
+	for (uint32 i = 0; i < pressureCallbackCount; ++i)
+	{
+		const PressureCallback& entry = pressureCallbacks[i];
+
+		if (entry.tag == tag && entry.callback == callback && entry.listener == listener)
 		{
-			unit[0] = 'B';
-			unit[1] = 0;
-			amount = static_cast<float>(config.stats.taggedAllocations[i]);
+			// Order doesn't matter, the last entry fills the gap
+			pressureCallbacks[i] = pressureCallbacks[--pressureCallbackCount];
+			return;
 		}
+	}
+}
 
-		int32 length = snprintf(buffer + offset, 8000, "%s: %.2f %s\n", memoryTagStrings[i], amount, unit);
-		offset += length;
- 	}
+uint64 MemoryManager::GetSizeHistogramBucketLimit(uint32 bucket)
+{
+	return (bucket + 1 < c_SIZE_HISTOGRAM_BUCKETS) ? (16ULL << bucket) : 0;
+}
 
-	return _strdup(buffer);
+MemoryManager::MemoryArena MemoryManager::GetMemoryArena(MemoryTag tag)
+{
+	return (tag < MemoryTag::MAX) ? memoryTagArenas[static_cast<uint64>(tag)] : MemoryArena::GENERAL;
 }
 
-uint64 MemoryManager::GetMemoryAllocationCount()
+const char* MemoryManager::GetMemoryArenaName(MemoryArena arena)
 {
-	return config.stats.totalAllocations;
+	return (arena < MemoryArena::MAX) ? memoryArenaStrings[static_cast<uint64>(arena)] : "INVALID";
 }
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Globals.h"
+#include "DynamicAllocator.h"
+
+#include <new>
+#include <type_traits>
 
 namespace MemoryManager 
 {
@@ -31,27 +35,233 @@ namespace MemoryManager
 		RESOURCE_MESH,
 		RESOURCE_TEXTURE,
 		RESOURCE_MATERIAL,
+		POOL_ALLOCATOR,
+		FRAME_ALLOCATOR,
+
+		MAX
+	};
+
+	// Allocation behaviour, can be combined
+	enum class AllocationFlags : uint32
+	{
+		NONE = 0,					// Block is zeroed
+		UNINITIALIZED = 1 << 0,		// Block keeps whatever it held, the caller overwrites it before use
+	};
+
+	constexpr AllocationFlags operator|(AllocationFlags a, AllocationFlags b)
+	{
+		return static_cast<AllocationFlags>(static_cast<uint32>(a) | static_cast<uint32>(b));
+	}
+
+	constexpr bool HasFlag(AllocationFlags flags, AllocationFlags flag)
+	{
+		return (static_cast<uint32>(flags) & static_cast<uint32>(flag)) != 0;
+	}
+
+	// Every tag is routed to an arena, a separate heap with its own address range, allocator and lock.
+	// Keeping long-lived systems, bulk resource data and short-lived buffers apart stops their interleaved
+	// lifetimes from fragmenting each other (e.g. textures reloaded on every scene load).
+	enum class MemoryArena
+	{
+		GENERAL = 0,	// Modules, systems and containers, mostly alive for the whole session
+		RESOURCE,		// Resource data (meshes, textures, materials), released in bulk on scene unload
+		TRANSIENT,		// Short-lived buffers (file reads, strings, scratch allocators)
 
 		MAX
 	};
 
-	void InitializeMemory(uint64 preAllocatedMemorySize);
+	struct ArenaConfig
+	{
+		uint64 initialSize;		// Committed at startup
+		uint64 reserveSize;		// Address space reserved, the arena grows on demand up to this size
+	};
+
+	// Per-tag limits in bytes, 0 = unlimited.
+	// Crossing the soft limit notifies the tag's pressure callbacks at the end of the frame, so subsystems can
+	// drop caches. An allocation that would cross the hard limit fails (returns nullptr) instead of being served.
+	struct TagBudget
+	{
+		uint64 softLimit = 0;
+		uint64 hardLimit = 0;
+	};
+
+	enum class MemoryPressure
+	{
+		NONE = 0,
+		SOFT_LIMIT,		// Soft budget crossed
+		HARD_LIMIT		// An allocation failed: hard budget reached or the tag's arena is exhausted
+	};
+
+	/**
+	 * @brief Called from EndFrame() (main thread) for tags under pressure. Should release whatever memory of
+	 * the tag can be rebuilt or reloaded later.
+	 * @note Also called from inside Allocate() when the main thread's allocation is refused, the allocation is
+	 * retried right after. It may run while the main thread holds locks of its own, so it shouldn't block on them.
+	 */
+	typedef void (*PFN_OnMemoryPressure)(MemoryTag tag, MemoryPressure pressure, void* listener);
+
+	struct MemoryConfig
+	{
+		DynamicAllocatorType allocatorType = DynamicAllocatorType::TLSF;
+		bool useHugePages = false;	// Hints the OS to back the arenas with transparent huge pages where supported
+
+		ArenaConfig arenas[static_cast<uint64>(MemoryArena::MAX)] =
+		{
+			{ MiB(64), GiB(4) },	// GENERAL
+			{ MiB(64), GiB(8) },	// RESOURCE
+			{ MiB(16), GiB(2) },	// TRANSIENT
+		};
+
+		TagBudget budgets[static_cast<uint64>(MemoryTag::MAX)] = {};
+	};
+
+	// Common alignments for AllocateAligned()
+	constexpr uint64 c_SIMD_ALIGNMENT = 32;		// AVX registers
+	constexpr uint64 c_CACHE_LINE_SIZE = 64;	// Padding for per-thread data (avoids false sharing)
+	constexpr uint64 c_PAGE_SIZE = KiB(4);		// Staging and I/O buffers
+
+	// Allocation sizes are binned in power of two buckets: <= 16B, <= 32B, ... and a last bucket for the rest.
+	constexpr uint32 c_SIZE_HISTOGRAM_BUCKETS = 16;
+
+	struct TagUsage
+	{
+		uint64 bytes;				// Currently allocated
+		uint64 peakBytes;			// High-water mark
+		uint64 liveAllocations;		// Blocks currently alive
+		uint64 totalAllocations;	// Blocks allocated since startup
+		uint64 failedAllocations;	// Refused by the hard budget or out of arena memory
+		TagBudget budget;
+	};
+
+	struct ArenaUsage
+	{
+		uint64 capacity;			// Committed, grows on demand
+		uint64 reserved;			// Maximum the arena can grow to
+		uint64 freeSpace;
+		uint64 largestFreeBlock;
+		float fragmentation;		// 1 - largest free block / free space
+	};
+
+	/**
+	 * @brief Point in time copy of the memory counters.
+	 * @note Counters are sampled one by one without locking, so totals may be off by in-flight allocations.
+	 * Allocation counts and the size histogram are batched per thread, other threads may owe a few of them.
+	 */
+	struct MemorySnapshot
+	{
+		uint64 frameIndex;
+
+		uint64 totalAllocated;
+		uint64 peakAllocated;
+		uint64 liveAllocations;
+
+		// Activity during the last completed frame
+		uint64 frameAllocations;
+		uint64 frameAllocatedBytes;
+		uint64 frameFrees;
+		uint64 frameFreedBytes;
+
+		TagUsage tags[static_cast<uint64>(MemoryTag::MAX)];
+
+		uint64 sizeHistogram[c_SIZE_HISTOGRAM_BUCKETS];
+
+		// Heap figures, refreshed once per frame by EndFrame()
+		ArenaUsage arenas[static_cast<uint64>(MemoryArena::MAX)];
+
+		// Totals across all arenas
+		uint64 heapCapacity;
+		uint64 heapReserved;
+		uint64 heapFreeSpace;
+		uint64 heapLargestFreeBlock;
+		float heapFragmentation;
+
+		// Pages committed outside the arenas by systems mapping their own memory (e.g. RelocatableHeap)
+		uint64 externalCommitted;
+	};
+
+	/**
+	 * @brief Reserves the address range of every arena and commits their initial size.
+	 * @note Arenas commit more pages when they run out, up to their reserve size.
+	 */
+	void InitializeMemory(const MemoryConfig& memoryConfig = MemoryConfig());
 
 	void ShutdownMemory();
 
-	void* Allocate(uint64 size, MemoryTag tag);
+	/**
+	 * @brief Allocates a 16-byte aligned block, zeroed unless flags say otherwise.
+	 * @return nullptr if the tag's hard budget or its arena refuses it. On the main thread the tag's pressure
+	 * callbacks run first and the allocation is retried once.
+	 */
+	void* Allocate(uint64 size, MemoryTag tag, AllocationFlags flags = AllocationFlags::NONE);
 
 	void Free(void* block, uint64 size, MemoryTag tag);
 
+	/**
+	 * @brief Allocates a block whose address is a multiple of alignment, zeroed unless flags say otherwise.
+	 * @note alignment must be a power of two. Blocks must be released with FreeAligned() and the same alignment.
+	 */
+	void* AllocateAligned(uint64 size, uint64 alignment, MemoryTag tag, AllocationFlags flags = AllocationFlags::NONE);
+
+	void FreeAligned(void* block, uint64 size, uint64 alignment, MemoryTag tag);
+
+	/**
+	 * @brief Accounts a block a system carved out of memory it maps itself (outside the arenas) under tag, so it
+	 * counts towards the tag's budget and shows up in the telemetry like any other allocation.
+	 * @return false if the tag's hard budget refuses it, nothing is accounted then. Pressure callbacks aren't run
+	 * synchronously, the caller may hold locks they need, they're left to EndFrame().
+	 */
+	bool TrackExternalAllocation(uint64 size, MemoryTag tag);
+
+	void TrackExternalFree(uint64 size, MemoryTag tag);
+
+	// Pages committed or decommitted by such a system, reported as MemorySnapshot::externalCommitted.
+	void TrackExternalCommit(uint64 size);
+	void TrackExternalDecommit(uint64 size);
+
 	void* ZeroMemory(void* block, uint64 size);
 
 	void* CopyMemory(void* destination, const void* source, uint64 size);
 
 	void* SetMemory(void* destination, int32 value, uint64 size);
 
-	char* GetMemoryUsageStats();
+	std::string GetMemoryUsageStats();
 
 	uint64 GetMemoryAllocationCount();
+
+	/**
+	 * @brief Closes the per-frame allocation counters, refreshes the heap fragmentation figures and notifies
+	 * the pressure callbacks of tags that crossed their budget.
+	 * @note Called once per frame by the Application.
+	 */
+	void EndFrame();
+
+	/**
+	 * @brief Fills outSnapshot with the current counters. Lock-free, safe to call every frame from any thread.
+	 */
+	void GetMemorySnapshot(MemorySnapshot* outSnapshot);
+
+	const char* GetMemoryTagName(MemoryTag tag);
+
+	void SetMemoryBudget(MemoryTag tag, const TagBudget& budget);
+
+	TagBudget GetMemoryBudget(MemoryTag tag);
+
+	/**
+	 * @brief Registers a callback notified when tag is under memory pressure. Several callbacks can listen to a tag.
+	 * @return false if the callback table is full.
+	 */
+	bool RegisterPressureCallback(MemoryTag tag, PFN_OnMemoryPressure callback, void* listener = nullptr);
+
+	void UnregisterPressureCallback(MemoryTag tag, PFN_OnMemoryPressure callback, void* listener = nullptr);
+
+	MemoryArena GetMemoryArena(MemoryTag tag);
+
+	const char* GetMemoryArenaName(MemoryArena arena);
+
+	/**
+	 * @return Upper size limit (inclusive) of a histogram bucket, 0 for the last (unbounded) bucket.
+	 */
+	uint64 GetSizeHistogramBucketLimit(uint32 bucket);
 }
 
 // Custom Memory Management Macros to monitorize allocations
@@ -61,6 +271,11 @@ template<typename T, typename... Args> \
 T* name(MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::UNKNOWN, Args&&... args) \
 { \
     void* memory = MemoryManager::Allocate(sizeof(T), tag); \
+    if (memory == nullptr) \
+    { \
+        NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__); \
+        throw std::bad_alloc(); \
+    } \
     auto ptr = new(memory) T(std::forward<Args>(args)...); \
     return ptr; \
 }
@@ -72,6 +287,8 @@ T* name(MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::UNKNOWN, Args&&
  * @param args: Constructor arguments for the object of type `T`.
  *
  * @return T*: A pointer to the newly constructed object of type `T`.
+ * @throws std::bad_alloc if the MemoryManager refuses the allocation, like NousAllocator. The same goes for every
+ * NOUS_NEW variant below.
  */
 CUSTOM_NEW(NOUS_NEW)
 
@@ -80,16 +297,25 @@ template<typename T> \
 T* name(size_t count, MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::UNKNOWN) \
 { \
     void* memory = MemoryManager::Allocate(sizeof(T) * count, tag); \
+    if (memory == nullptr) \
+    { \
+        NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__); \
+        throw std::bad_alloc(); \
+    } \
     auto ptr = static_cast<T*>(memory); \
-    for (size_t i = 0; i < count; ++i) \
+    if constexpr (!std::is_trivially_default_constructible_v<T>) \
     { \
-        new(&ptr[i]) T(); \
+        for (size_t i = 0; i < count; ++i) \
+        { \
+            new(&ptr[i]) T(); \
+        } \
     } \
     return ptr; \
 }
 
 /**
 * @brief Allocates memory for an array of objects of type T and constructs them.
+* @note Trivial types are left as zeroed memory, which is what value-initialization would produce.
 *
 * @param count: The number of elements to allocate.
 * @param tag: The memory tag used for tracking allocations. Defaults to `UNKNOWN`.
@@ -98,6 +324,96 @@ T* name(size_t count, MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::U
 */
 CUSTOM_NEW_ARRAY(NOUS_NEW_ARRAY)
 
+#define CUSTOM_NEW_ARRAY_UNINIT(name) \
+template<typename T> \
+T* name(size_t count, MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::UNKNOWN) \
+{ \
+    void* memory = MemoryManager::Allocate(sizeof(T) * count, tag, MemoryManager::AllocationFlags::UNINITIALIZED); \
+    if (memory == nullptr) \
+    { \
+        NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__); \
+        throw std::bad_alloc(); \
+    } \
+    auto ptr = static_cast<T*>(memory); \
+    if constexpr (!std::is_trivially_default_constructible_v<T>) \
+    { \
+        for (size_t i = 0; i < count; ++i) \
+        { \
+            new(&ptr[i]) T; \
+        } \
+    } \
+    return ptr; \
+}
+
+/**
+* @brief Allocates memory for an array of objects of type T without zeroing it.
+* @note Trivial types are left uninitialized, other types are default-initialized (constructors run, but members
+* without an initializer keep garbage). Meant for buffers that are overwritten right away. Free with NOUS_DELETE_ARRAY.
+*
+* @param count: The number of elements to allocate.
+* @param tag: The memory tag used for tracking allocations. Defaults to `UNKNOWN`.
+*
+* @return T*: A pointer to the first element in the newly allocated array.
+*/
+CUSTOM_NEW_ARRAY_UNINIT(NOUS_NEW_ARRAY_UNINIT)
+
+#define CUSTOM_NEW_ALIGNED(name) \
+template<typename T, typename... Args> \
+T* name(uint64 alignment, MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::UNKNOWN, Args&&... args) \
+{ \
+    void* memory = MemoryManager::AllocateAligned(sizeof(T), (alignment > alignof(T) ? alignment : alignof(T)), tag); \
+    if (memory == nullptr) \
+    { \
+        NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__); \
+        throw std::bad_alloc(); \
+    } \
+    auto ptr = new(memory) T(std::forward<Args>(args)...); \
+    return ptr; \
+}
+
+/**
+ * @brief Allocates memory aligned to the given boundary and constructs an object of type T.
+ *
+ * @param alignment: Power of two boundary (e.g. MemoryManager::c_CACHE_LINE_SIZE).
+ * @param tag: The memory tag used for tracking allocations. Defaults to `UNKNOWN`.
+ * @param args: Constructor arguments for the object of type `T`.
+ *
+ * @return T*: A pointer to the newly constructed object of type `T`.
+ */
+CUSTOM_NEW_ALIGNED(NOUS_NEW_ALIGNED)
+
+#define CUSTOM_NEW_ARRAY_ALIGNED(name) \
+template<typename T> \
+T* name(size_t count, uint64 alignment, MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::UNKNOWN) \
+{ \
+    void* memory = MemoryManager::AllocateAligned(sizeof(T) * count, (alignment > alignof(T) ? alignment : alignof(T)), tag); \
+    if (memory == nullptr) \
+    { \
+        NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__); \
+        throw std::bad_alloc(); \
+    } \
+    auto ptr = static_cast<T*>(memory); \
+    if constexpr (!std::is_trivially_default_constructible_v<T>) \
+    { \
+        for (size_t i = 0; i < count; ++i) \
+        { \
+            new(&ptr[i]) T(); \
+        } \
+    } \
+    return ptr; \
+}
+
+/**
+* @brief Allocates an array of objects of type T starting at the given boundary and constructs them.
+*
+* @param count: The number of elements to allocate.
+* @param alignment: Power of two boundary (e.g. MemoryManager::c_SIMD_ALIGNMENT).
+* @param tag: The memory tag used for tracking allocations. Defaults to `UNKNOWN`.
+*
+* @return T*: A pointer to the first element in the newly constructed array.
+*/
+CUSTOM_NEW_ARRAY_ALIGNED(NOUS_NEW_ARRAY_ALIGNED)
+
 #define CUSTOM_DELETE(name) \
 template<typename T> \
 void name(T*& ptr, MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::UNKNOWN) \
@@ -140,4 +456,50 @@ void name(T*& ptr, size_t count, MemoryManager::MemoryTag tag = MemoryManager::M
 * @param count: The number of elements in the array.
 * @param tag: The memory tag used for tracking deallocations. Defaults to `UNKNOWN`.
 */
-CUSTOM_DELETE_ARRAY(NOUS_DELETE_ARRAY)
\ No newline at end of file
+CUSTOM_DELETE_ARRAY(NOUS_DELETE_ARRAY)
+
+#define CUSTOM_DELETE_ALIGNED(name) \
+template<typename T> \
+void name(T*& ptr, uint64 alignment, MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::UNKNOWN) \
+{ \
+    if (ptr != nullptr) \
+    { \
+        ptr->~T(); \
+        MemoryManager::FreeAligned(ptr, sizeof(*ptr), (alignment > alignof(T) ? alignment : alignof(T)), tag); \
+        ptr = nullptr; \
+    } \
+}
+
+/**
+ * @brief Destructs an object created with NOUS_NEW_ALIGNED and deallocates the memory.
+ *
+ * @param ptr: A pointer to the object to be deleted.
+ * @param alignment: The alignment used when the object was created.
+ * @param tag: The memory tag used for tracking deallocations. Defaults to `UNKNOWN`.
+ */
+CUSTOM_DELETE_ALIGNED(NOUS_DELETE_ALIGNED)
+
+#define CUSTOM_DELETE_ARRAY_ALIGNED(name) \
+template<typename T> \
+void name(T*& ptr, size_t count, uint64 alignment, MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::UNKNOWN) \
+{ \
+    if (ptr != nullptr) \
+    { \
+        for (size_t i = 0; i < count; ++i) \
+        { \
+            ptr[i].~T(); \
+        } \
+        MemoryManager::FreeAligned(ptr, sizeof(T) * count, (alignment > alignof(T) ? alignment : alignof(T)), tag); \
+        ptr = nullptr; \
+    } \
+}
+
+/**
+* @brief Destructs an array created with NOUS_NEW_ARRAY_ALIGNED and deallocates the memory.
+*
+* @param ptr: A pointer to the array.
+* @param count: The number of elements in the array.
+* @param alignment: The alignment used when the array was created.
+* @param tag: The memory tag used for tracking deallocations. Defaults to `UNKNOWN`.
+*/
+CUSTOM_DELETE_ARRAY_ALIGNED(NOUS_DELETE_ARRAY_ALIGNED)
\ No newline at end of file
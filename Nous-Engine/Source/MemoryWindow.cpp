@@ -0,0 +1,169 @@
+#include "MemoryWindow.h"
+
+#include "MemoryManager.h"
+
+#include <cinttypes>
+
+Memory::Memory(const char* title, bool start_open)
+    : IEditorWindow(title, nullptr, start_open)
+{
+    Init();
+}
+
+void Memory::Init()
+{
+
+}
+
+void Memory::Draw()
+{
+    if (!*p_open) return;
+
+    ImGui::SetNextWindowSize(ImVec2(650, 500), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin(title, p_open))
+    {
+        static MemoryManager::MemorySnapshot snapshot;
+        MemoryManager::GetMemorySnapshot(&snapshot);
+
+        const double toMiB = 1.0 / (1024.0 * 1024.0);
+
+        // Heap overview section (all arenas)
+        ImGui::Text("Heap Overview");
+        ImGui::Separator();
+
+        ImGui::Columns(2);
+        ImGui::Text("Allocated: %.2f MiB (peak %.2f MiB)", snapshot.totalAllocated * toMiB, snapshot.peakAllocated * toMiB);
+        ImGui::Text("Live Allocations: %" PRIu64, snapshot.liveAllocations);
+        ImGui::Text("Capacity: %.2f MiB (%.2f MiB reserved)", snapshot.heapCapacity * toMiB, snapshot.heapReserved * toMiB);
+        ImGui::Text("Outside Arenas: %.2f MiB committed", snapshot.externalCommitted * toMiB);
+        ImGui::NextColumn();
+        ImGui::Text("Allocs / Frame: %" PRIu64 " (%.2f KiB)", snapshot.frameAllocations, snapshot.frameAllocatedBytes / 1024.0);
+        ImGui::Text("Frees / Frame: %" PRIu64 " (%.2f KiB)", snapshot.frameFrees, snapshot.frameFreedBytes / 1024.0);
+        ImGui::Text("Largest Free Block: %.2f MiB", snapshot.heapLargestFreeBlock * toMiB);
+        ImGui::Columns(1);
+
+        const float usage = (snapshot.heapCapacity > 0) ? static_cast<float>(1.0 - static_cast<double>(snapshot.heapFreeSpace) / snapshot.heapCapacity) : 0.0f;
+        std::string usageText = "Heap Usage: " + std::to_string(static_cast<int>(usage * 100.0f)) + "%";
+        ImGui::ProgressBar(usage, ImVec2(-1, 0), usageText.c_str());
+
+        std::string fragmentationText = "Fragmentation: " + std::to_string(static_cast<int>(snapshot.heapFragmentation * 100.0f)) + "%";
+        ImGui::ProgressBar(snapshot.heapFragmentation, ImVec2(-1, 0), fragmentationText.c_str());
+
+        ImGui::Separator();
+
+        // Per-arena table
+        if (ImGui::BeginTable("MemoryArenasTable", 5,
+            ImGuiTableFlags_Borders |
+            ImGuiTableFlags_RowBg |
+            ImGuiTableFlags_Resizable))
+        {
+            ImGui::TableSetupColumn("Arena", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Used (MiB)", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            ImGui::TableSetupColumn("Capacity (MiB)", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+            ImGui::TableSetupColumn("Largest Free (MiB)", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+            ImGui::TableSetupColumn("Fragmentation", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+            ImGui::TableHeadersRow();
+
+            for (uint32 i = 0; i < static_cast<uint32>(MemoryManager::MemoryArena::MAX); ++i)
+            {
+                const MemoryManager::ArenaUsage& arena = snapshot.arenas[i];
+
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", MemoryManager::GetMemoryArenaName(static_cast<MemoryManager::MemoryArena>(i)));
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.2f", (arena.capacity - arena.freeSpace) * toMiB);
+
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.2f", arena.capacity * toMiB);
+
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.2f", arena.largestFreeBlock * toMiB);
+
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%d%%", static_cast<int>(arena.fragmentation * 100.0f));
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::Separator();
+
+        // Allocation size histogram
+        float histogram[MemoryManager::c_SIZE_HISTOGRAM_BUCKETS];
+
+        for (uint32 i = 0; i < MemoryManager::c_SIZE_HISTOGRAM_BUCKETS; ++i)
+        {
+            histogram[i] = static_cast<float>(snapshot.sizeHistogram[i]);
+        }
+
+        ImGui::PlotHistogram("##SizeHistogram", histogram, MemoryManager::c_SIZE_HISTOGRAM_BUCKETS, 0,
+            "Allocation Sizes (16B - 256KiB+)", 0.0f, FLT_MAX, ImVec2(-1, 80));
+
+        ImGui::Separator();
+
+        // Per-tag table
+        if (ImGui::BeginTable("MemoryTagsTable", 7,
+            ImGuiTableFlags_Borders |
+            ImGuiTableFlags_RowBg |
+            ImGuiTableFlags_Resizable |
+            ImGuiTableFlags_ScrollY))
+        {
+            ImGui::TableSetupColumn("Tag", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Size (KiB)", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            ImGui::TableSetupColumn("Peak (KiB)", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            ImGui::TableSetupColumn("Live", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Total", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("Budget (KiB)", ImGuiTableColumnFlags_WidthFixed, 140.0f);
+            ImGui::TableSetupColumn("Refused", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableHeadersRow();
+
+            for (uint32 i = 0; i < static_cast<uint32>(MemoryManager::MemoryTag::MAX); ++i)
+            {
+                const MemoryManager::TagUsage& tag = snapshot.tags[i];
+
+                // Skip tags that were never used
+                if (tag.totalAllocations == 0) continue;
+
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", MemoryManager::GetMemoryTagName(static_cast<MemoryManager::MemoryTag>(i)));
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.2f", tag.bytes / 1024.0);
+
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.2f", tag.peakBytes / 1024.0);
+
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%" PRIu64, tag.liveAllocations);
+
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%" PRIu64, tag.totalAllocations);
+
+                ImGui::TableSetColumnIndex(5);
+                if (tag.budget.softLimit > 0 || tag.budget.hardLimit > 0)
+                {
+                    // Above the soft budget the tag is under pressure
+                    const bool overBudget = tag.budget.softLimit > 0 && tag.bytes > tag.budget.softLimit;
+
+                    ImGui::TextColored(overBudget ? ImVec4(1.0f, 0.6f, 0.2f, 1.0f) : ImGui::GetStyleColorVec4(ImGuiCol_Text),
+                        "%.0f / %.0f", tag.budget.softLimit / 1024.0, tag.budget.hardLimit / 1024.0);
+                }
+                else
+                {
+                    ImGui::TextDisabled("-");
+                }
+
+                ImGui::TableSetColumnIndex(6);
+                ImGui::Text("%" PRIu64, tag.failedAllocations);
+            }
+
+            ImGui::EndTable();
+        }
+    }
+    ImGui::End();
+}
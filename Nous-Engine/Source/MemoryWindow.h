@@ -0,0 +1,13 @@
+#pragma once
+
+#include "IEditorWindow.inl"
+
+class Memory : public IEditorWindow
+{
+public:
+
+    explicit Memory(const char* title, bool start_open = true);
+
+    void Init() override;
+    void Draw() override;
+};
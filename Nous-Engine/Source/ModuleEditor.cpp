@@ -19,6 +19,8 @@
 #include "ResourcesWindow.h"
 #include "MultithreadingWindow.h"
 #include "JobQueueWindow.h"
+#include "JobProfilerWindow.h"
+#include "MemoryWindow.h"
 #include "SceneViewport.h"
 #include "GameViewport.h"
 
@@ -111,6 +113,8 @@ bool ModuleEditor::Awake()
 	AddEditorWindow(std::make_unique<Resources>("Resources"));
 	AddEditorWindow(std::make_unique<Multithreading>("Multithreading"));
 	AddEditorWindow(std::make_unique<JobQueue>("Job Queue"));
+	AddEditorWindow(std::make_unique<JobProfiler>("Job Profiler"));
+	AddEditorWindow(std::make_unique<Memory>("Memory"));
 	AddEditorWindow(std::make_unique<GameViewport>("Game"));
 	AddEditorWindow(std::make_unique<SceneViewport>("Scene"));
 
@@ -98,15 +98,18 @@ UpdateStatus ModuleRenderer3D::PostUpdate(float dt)
 	// Create the rotation matrix using the accumulated angle.
 	float4x4 model = Quat(float3::unitY, angle).ToFloat4x4();
 
-	for (const auto& [UID, Resource] : App->resourceManager->GetResourcesMap()) 
+	const auto& resources = App->resourceManager->GetResourcesMap();
+
+	// Upper bound, only meshes end up in the packet
+	packet.geometries = App->frameAllocator->AllocateArray<GeometryRenderData>(resources.size());
+
+	for (const auto& [UID, Resource] : resources) 
 	{
-		if (Resource->GetType() == ResourceType::MESH) 
+		if (packet.geometries && Resource->GetType() == ResourceType::MESH) 
 		{
-			GeometryRenderData testRender;
+			GeometryRenderData& testRender = packet.geometries[packet.geometryCount++];
 			testRender.geometry = static_cast<ResourceMesh*>(Resource);
 			testRender.model = model;
-
-			packet.geometries.push_back(testRender);
 		}
 	}
 
@@ -16,7 +16,12 @@
 
 #include "ImporterManager.h"
 
-ModuleResourceManager::ModuleResourceManager(Application* app) : Module(app)
+#include <cinttypes>
+
+ModuleResourceManager::ModuleResourceManager(Application* app) : Module(app),
+	meshPool(POOL_DEFAULT_SLOTS_PER_CHUNK, MemoryManager::MemoryTag::RESOURCE_MESH),
+	materialPool(POOL_DEFAULT_SLOTS_PER_CHUNK, MemoryManager::MemoryTag::RESOURCE_MATERIAL),
+	texturePool(POOL_DEFAULT_SLOTS_PER_CHUNK, MemoryManager::MemoryTag::RESOURCE_TEXTURE)
 {
 	NOUS_TRACE("%s()", __FUNCTION__);
 }
@@ -30,6 +35,8 @@ bool ModuleResourceManager::Awake()
 {
 	NOUS_TRACE("%s()", __FUNCTION__);
 
+	MemoryManager::RegisterPressureCallback(MemoryManager::MemoryTag::RESOURCE_MESH, OnMemoryPressure, this);
+
 	return true;
 }
 
@@ -66,6 +73,8 @@ bool ModuleResourceManager::CleanUp()
 
 	ClearResources();
 
+	MemoryManager::UnregisterPressureCallback(MemoryManager::MemoryTag::RESOURCE_MESH, OnMemoryPressure, this);
+
 	return true;
 }
 
@@ -355,7 +364,7 @@ bool ModuleResourceManager::ImportFile(const std::string& path)
 	return true;
 }
 
-const std::unordered_map<UID, Resource*>& ModuleResourceManager::GetResourcesMap() const
+const nous::unordered_map<UID, Resource*>& ModuleResourceManager::GetResourcesMap() const
 {
 	return resources;
 }
@@ -416,17 +425,17 @@ Resource* ModuleResourceManager::InstantiateResource(const ResourceType& type)
 	{
 		case ResourceType::MESH:
 		{
-			resource = NOUS_NEW<ResourceMesh>(MemoryManager::MemoryTag::RESOURCE_MESH);
+			resource = meshPool.New();
 			break;
 		}
 		case ResourceType::MATERIAL:
 		{
-			resource = NOUS_NEW<ResourceMaterial>(MemoryManager::MemoryTag::RESOURCE_MATERIAL);
+			resource = materialPool.New();
 			break;
 		}
 		case ResourceType::TEXTURE:
 		{
-			resource = NOUS_NEW<ResourceTexture>(MemoryManager::MemoryTag::RESOURCE_TEXTURE);
+			resource = texturePool.New();
 			break;
 		}
 	}
@@ -443,19 +452,19 @@ void ModuleResourceManager::DeleteResource(Resource*& resource)
 		case ResourceType::MESH:
 		{
 			ResourceMesh* r = down_cast<ResourceMesh*>(resource);
-			NOUS_DELETE<ResourceMesh>(r, MemoryManager::MemoryTag::RESOURCE_MESH);
+			meshPool.Delete(r);
 			break;
 		}
 		case ResourceType::MATERIAL:
 		{
 			ResourceMaterial* r = down_cast<ResourceMaterial*>(resource);
-			NOUS_DELETE<ResourceMaterial>(r, MemoryManager::MemoryTag::RESOURCE_MATERIAL);
+			materialPool.Delete(r);
 			break;
 		}
 		case ResourceType::TEXTURE:
 		{
 			ResourceTexture* r = down_cast<ResourceTexture*>(resource);
-			NOUS_DELETE<ResourceTexture>(r, MemoryManager::MemoryTag::RESOURCE_TEXTURE);
+			texturePool.Delete(r);
 			break;
 		}
 	}
@@ -542,10 +551,24 @@ bool ModuleResourceManager::UnloadResource(const UID& UID)
 
 Resource* ModuleResourceManager::RequestResource(const UID& uid)
 {
-	Resource* resource = resources[uid];
+	Resource* resource = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(resourcesMutex);
+		resource = resources[uid];
+
+		// Reloading frees and refills the mesh geometry, ReleaseMeshCopies() has to leave it alone meanwhile
+		if (resource->GetType() == ResourceType::MESH) down_cast<ResourceMesh*>(resource)->pendingLoads++;
+	}
 
 	ImporterManager::Load(resource->GetType(), resource->GetLibraryPath(), resource);
 
+	if (resource->GetType() == ResourceType::MESH)
+	{
+		std::lock_guard<std::mutex> lock(resourcesMutex);
+		down_cast<ResourceMesh*>(resource)->pendingLoads--;
+	}
+
 	resource->IncreaseReferenceCount();
 
 	return resource;
@@ -568,19 +591,19 @@ void ModuleResourceManager::ClearResources()
 			case ResourceType::MESH:
 			{
 				ResourceMesh* r = down_cast<ResourceMesh*>(Resource);
-				NOUS_DELETE<ResourceMesh>(r, MemoryManager::MemoryTag::RESOURCE_MESH);
+				meshPool.Delete(r);
 				break;
 			}
 			case ResourceType::MATERIAL:
 			{
 				ResourceMaterial* r = down_cast<ResourceMaterial*>(Resource);
-				NOUS_DELETE<ResourceMaterial>(r, MemoryManager::MemoryTag::RESOURCE_MATERIAL);
+				materialPool.Delete(r);
 				break;
 			}
 			case ResourceType::TEXTURE:
 			{
 				ResourceTexture* r = down_cast<ResourceTexture*>(Resource);
-				NOUS_DELETE<ResourceTexture>(r, MemoryManager::MemoryTag::RESOURCE_TEXTURE);
+				texturePool.Delete(r);
 				break;
 			}
 		}
@@ -589,6 +612,58 @@ void ModuleResourceManager::ClearResources()
 	resources.clear();
 }
 
+uint64 ModuleResourceManager::ReleaseMeshCopies()
+{
+	// Runs from inside a refused allocation too, which may come from this thread while it holds the lock
+	std::unique_lock<std::mutex> lock(resourcesMutex, std::try_to_lock);
+
+	if (!lock.owns_lock()) return 0;
+
+	RelocatableHeap* heap = App->relocatableHeap;
+	uint64 releasedBytes = 0;
+
+	for (auto& [UID, Resource] : resources)
+	{
+		if (Resource->GetType() != ResourceType::MESH) continue;
+
+		ResourceMesh* mesh = down_cast<ResourceMesh*>(Resource);
+
+		// Not on the GPU yet, the copy is still needed to create the geometry
+		if (mesh->internalID == INVALID_ID) continue;
+
+		// Being reloaded by a loader job, or its blocks are still in use
+		if (mesh->pendingLoads > 0 || heap->IsPinned(mesh->vertexData) || heap->IsPinned(mesh->indexData)) continue;
+
+		releasedBytes += mesh->vertices.capacity() * sizeof(Vertex3D) + mesh->indices.capacity() * sizeof(uint32);
+
+		nous::vector<Vertex3D, MemoryManager::MemoryTag::RESOURCE_MESH>().swap(mesh->vertices);
+		nous::vector<uint32, MemoryManager::MemoryTag::RESOURCE_MESH>().swap(mesh->indices);
+
+		if (mesh->vertexData.IsValid())
+		{
+			releasedBytes += heap->GetSize(mesh->vertexData);
+			heap->Free(mesh->vertexData);
+		}
+
+		if (mesh->indexData.IsValid())
+		{
+			releasedBytes += heap->GetSize(mesh->indexData);
+			heap->Free(mesh->indexData);
+		}
+	}
+
+	return releasedBytes;
+}
+
+void ModuleResourceManager::OnMemoryPressure(MemoryManager::MemoryTag tag, MemoryManager::MemoryPressure pressure, void* listener)
+{
+	ModuleResourceManager* resourceManager = static_cast<ModuleResourceManager*>(listener);
+
+	const uint64 releasedBytes = resourceManager->ReleaseMeshCopies();
+
+	NOUS_INFO("Resource Manager released %" PRIu64 " bytes of mesh data under memory pressure", releasedBytes);
+}
+
 //std::string ModuleResourceManager::GetLibraryPath(const std::string& assetsPath)
 //{
 //	JsonFile metaFile;
@@ -2,6 +2,14 @@
 
 #include "Module.h"
 #include "Resource.h"
+
+#include "ResourceMesh.h"
+#include "ResourceMaterial.h"
+#include "ResourceTexture.h"
+
+#include "PoolAllocator.h"
+#include "NousAllocator.h"
+
 #include <mutex>
 
 using UID = uint32;
@@ -36,12 +44,18 @@ public:
 	Resource* CreateResource(const std::string& assetsPath);
 	bool UnloadResource(const UID& UID);
 
-	const std::unordered_map<UID, Resource*>& GetResourcesMap() const;
+	const nous::unordered_map<UID, Resource*>& GetResourcesMap() const;
 
 	void ClearResources();
 
+	// Drops the CPU copy of the geometry of meshes already uploaded to the GPU, returns the bytes released.
+	// Releases nothing if the resources are locked at the moment.
+	uint64 ReleaseMeshCopies();
+
 private:
 
+	static void OnMemoryPressure(MemoryManager::MemoryTag tag, MemoryManager::MemoryPressure pressure, void* listener);
+
 	bool CreateMetaFile(const std::string& metaFilePath, const MetaFileData& inFileData);
 	bool ReadMetaFile(const std::string& metaFilePath, MetaFileData& outFileData);
 
@@ -56,5 +70,10 @@ private:
 private:
 
 	std::mutex resourcesMutex;  // Mutex to protect resources map from race conditions
-	std::unordered_map<UID, Resource*> resources;
+	nous::unordered_map<UID, Resource*> resources;
+
+	// Resources are created and destroyed from the loader jobs, pools keep them off the shared heap
+	PoolAllocator<ResourceMesh, true> meshPool;
+	PoolAllocator<ResourceMaterial, true> materialPool;
+	PoolAllocator<ResourceTexture, true> texturePool;
 };
\ No newline at end of file
@@ -49,73 +49,32 @@ UpdateStatus ModuleScene::Update(float dt)
 
 	if (App->input->GetKey(SDL_SCANCODE_F1) == KeyState::DOWN) 
 	{
-		App->jobSystem->SubmitJob([this]()
-			{
-				ResourceMesh* mesh2 = static_cast<ResourceMesh*>(App->resourceManager->CreateResource("Assets/Meshes/Lagiacrus_Head.fbx"));
-				mesh2->material = static_cast<ResourceMaterial*>(App->resourceManager->CreateResource("Assets/Materials/Lagiacrus_Head.nmat"));
-			}, "Render Lagiacrus");
+		LoadModel("Assets/Meshes/Lagiacrus_Head.fbx", "Assets/Materials/Lagiacrus_Head.nmat", "Render Lagiacrus");
 	}
 
 	if (App->input->GetKey(SDL_SCANCODE_F2) == KeyState::DOWN)
 	{
-		App->jobSystem->SubmitJob([this]()
-			{
-				ResourceMesh* mesh2 = static_cast<ResourceMesh*>(App->resourceManager->CreateResource("Assets/Meshes/Cypher_S0_Skelmesh.fbx"));
-				mesh2->material = static_cast<ResourceMaterial*>(App->resourceManager->CreateResource("Assets/Materials/cypher_material.nmat"));
-			}, "Render Cypher");
+		LoadModel("Assets/Meshes/Cypher_S0_Skelmesh.fbx", "Assets/Materials/cypher_material.nmat", "Render Cypher");
 	}
 
 	if (App->input->GetKey(SDL_SCANCODE_F3) == KeyState::DOWN)
 	{
-		App->jobSystem->SubmitJob([this]()
-			{
-				ResourceMesh* mesh2 = static_cast<ResourceMesh*>(App->resourceManager->CreateResource("Assets/Meshes/Queen_Xenomorph.fbx"));
-				mesh2->material = static_cast<ResourceMaterial*>(App->resourceManager->CreateResource("Assets/Materials/queen_xenomorph.nmat"));
-			}, "Render Queen Xenomorph");
+		LoadModel("Assets/Meshes/Queen_Xenomorph.fbx", "Assets/Materials/queen_xenomorph.nmat", "Render Queen Xenomorph");
 	}
 
 	if (App->input->GetKey(SDL_SCANCODE_F4) == KeyState::DOWN)
 	{
-		App->jobSystem->SubmitJob([this]()
-			{
-				ResourceMesh* mesh2 = static_cast<ResourceMesh*>(App->resourceManager->CreateResource("Assets/Meshes/Wolf.obj"));
-				mesh2->material = static_cast<ResourceMaterial*>(App->resourceManager->CreateResource("Assets/Materials/wolf_material.nmat"));
-			}, "Render Wolf");
+		LoadModel("Assets/Meshes/Wolf.obj", "Assets/Materials/wolf_material.nmat", "Render Wolf");
 	}
 
 	if (App->input->GetKey(SDL_SCANCODE_F5) == KeyState::DOWN) 
 	{
-		App->jobSystem->SubmitJob([this]()
-			{
-				NOUS_Multithreading::NOUS_Thread::SleepMS(1000);
-				ResourceMesh* mesh2 = static_cast<ResourceMesh*>(App->resourceManager->CreateResource("Assets/Meshes/Lagiacrus_Head.fbx"));
-				NOUS_Multithreading::NOUS_Thread::SleepMS(1000);
-				mesh2->material = static_cast<ResourceMaterial*>(App->resourceManager->CreateResource("Assets/Materials/Lagiacrus_Head.nmat"));
-			}, "Render Lagiacrus");
+		const NOUS_Multithreading::NOUS_JobPriority priority = NOUS_Multithreading::NOUS_JobPriority::BACKGROUND;
 
-		App->jobSystem->SubmitJob([this]()
-			{
-				NOUS_Multithreading::NOUS_Thread::SleepMS(1000);
-				ResourceMesh* mesh2 = static_cast<ResourceMesh*>(App->resourceManager->CreateResource("Assets/Meshes/Cypher_S0_Skelmesh.fbx"));
-				NOUS_Multithreading::NOUS_Thread::SleepMS(1000);
-				mesh2->material = static_cast<ResourceMaterial*>(App->resourceManager->CreateResource("Assets/Materials/cypher_material.nmat"));
-			}, "Render Cypher");
-
-		App->jobSystem->SubmitJob([this]()
-			{
-				NOUS_Multithreading::NOUS_Thread::SleepMS(1000);
-				ResourceMesh* mesh2 = static_cast<ResourceMesh*>(App->resourceManager->CreateResource("Assets/Meshes/Queen_Xenomorph.fbx"));
-				NOUS_Multithreading::NOUS_Thread::SleepMS(1000);
-				mesh2->material = static_cast<ResourceMaterial*>(App->resourceManager->CreateResource("Assets/Materials/queen_xenomorph.nmat"));
-			}, "Render Queen Xenomorph");
-
-		App->jobSystem->SubmitJob([this]()
-			{
-				NOUS_Multithreading::NOUS_Thread::SleepMS(1000);
-				ResourceMesh* mesh2 = static_cast<ResourceMesh*>(App->resourceManager->CreateResource("Assets/Meshes/Wolf.obj"));
-				NOUS_Multithreading::NOUS_Thread::SleepMS(1000);
-				mesh2->material = static_cast<ResourceMaterial*>(App->resourceManager->CreateResource("Assets/Materials/wolf_material.nmat"));
-			}, "Render Wolf");
+		App->jobSystem->SubmitTask(LoadModelDelayed("Assets/Meshes/Lagiacrus_Head.fbx", "Assets/Materials/Lagiacrus_Head.nmat", 1000), "Render Lagiacrus", priority);
+		App->jobSystem->SubmitTask(LoadModelDelayed("Assets/Meshes/Cypher_S0_Skelmesh.fbx", "Assets/Materials/cypher_material.nmat", 1000), "Render Cypher", priority);
+		App->jobSystem->SubmitTask(LoadModelDelayed("Assets/Meshes/Queen_Xenomorph.fbx", "Assets/Materials/queen_xenomorph.nmat", 1000), "Render Queen Xenomorph", priority);
+		App->jobSystem->SubmitTask(LoadModelDelayed("Assets/Meshes/Wolf.obj", "Assets/Materials/wolf_material.nmat", 1000), "Render Wolf", priority);
 	}
 
 	if (App->input->GetKey(SDL_SCANCODE_F6) == KeyState::DOWN)
@@ -128,7 +87,7 @@ UpdateStatus ModuleScene::Update(float dt)
 		App->jobSystem->SubmitJob([this]()
 			{
 				NOUS_Multithreading::NOUS_Thread::SleepMS(5000);
-			}, "Test");
+			}, "Test", NOUS_Multithreading::NOUS_JobPriority::BACKGROUND);
 	}
 
 	if (App->input->GetKey(SDL_SCANCODE_F8) == KeyState::DOWN)
@@ -145,7 +104,7 @@ UpdateStatus ModuleScene::Update(float dt)
 						std::sqrt(123.456); // Dummy CPU-bound work
 					}
 
-				}, "Stress Test");
+				}, "Stress Test", NOUS_Multithreading::NOUS_JobPriority::BACKGROUND);
 		}
 	}
 
@@ -165,6 +124,56 @@ bool ModuleScene::CleanUp()
 	return true;
 }
 
+void ModuleScene::LoadModel(const std::string& meshPath, const std::string& materialPath, const std::string& jobName)
+{
+	struct ModelLoad
+	{
+		ResourceMesh* mesh = nullptr;
+		ResourceMaterial* material = nullptr;
+	};
+
+	ModelLoad* load = NOUS_NEW<ModelLoad>(MemoryManager::MemoryTag::SCENE);
+
+	NOUS_Multithreading::NOUS_JobHandle meshJob = App->jobSystem->SubmitJob([this, load, meshPath]()
+		{
+			load->mesh = static_cast<ResourceMesh*>(App->resourceManager->CreateResource(meshPath));
+		}, jobName + " (Mesh)", NOUS_Multithreading::NOUS_JobPriority::BACKGROUND);
+
+	NOUS_Multithreading::NOUS_JobHandle materialJob = App->jobSystem->SubmitJob([this, load, materialPath]()
+		{
+			load->material = static_cast<ResourceMaterial*>(App->resourceManager->CreateResource(materialPath));
+		}, jobName + " (Material)", NOUS_Multithreading::NOUS_JobPriority::BACKGROUND);
+
+	App->jobSystem->SubmitJob([load]()
+		{
+			if (load->mesh) load->mesh->material = load->material;
+
+			NOUS_DELETE<ModelLoad>(load, MemoryManager::MemoryTag::SCENE);
+		}, jobName, NOUS_Multithreading::NOUS_JobPriority::NORMAL, { meshJob, materialJob });
+}
+
+NOUS_Multithreading::NOUS_Task<void> ModuleScene::LoadModelDelayed(std::string meshPath, std::string materialPath, uint32 delayMS)
+{
+	NOUS_Multithreading::NOUS_JobSystem& jobSystem = *App->jobSystem;
+
+	// Delays hold no thread, the imports run as jobs and the task continues on whichever worker ran them
+	co_await NOUS_Multithreading::Delay(jobSystem, std::chrono::milliseconds(delayMS));
+
+	ResourceMesh* mesh = co_await NOUS_Multithreading::ExecuteAsync(jobSystem, [this, &meshPath]()
+		{
+			return static_cast<ResourceMesh*>(App->resourceManager->CreateResource(meshPath));
+		}, "Load Mesh");
+
+	co_await NOUS_Multithreading::Delay(jobSystem, std::chrono::milliseconds(delayMS));
+
+	ResourceMaterial* material = co_await NOUS_Multithreading::ExecuteAsync(jobSystem, [this, &materialPath]()
+		{
+			return static_cast<ResourceMaterial*>(App->resourceManager->CreateResource(materialPath));
+		}, "Load Material");
+
+	if (mesh) mesh->material = material;
+}
+
 void ModuleScene::ReceiveEvent(const Event& event)
 {
 	switch (event.type)
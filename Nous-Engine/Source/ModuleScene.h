@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Module.h"
+#include "NOUS_Task.h"
 
 class Camera;
 
@@ -25,6 +26,12 @@ public:
 
 	void ReceiveEvent(const Event& event) override;
 
+	// Loads mesh and material as independent jobs, a continuation assigns the material once both are done
+	void LoadModel(const std::string& meshPath, const std::string& materialPath, const std::string& jobName);
+
+	// Same as LoadModel() written as a coroutine, waits delayMS before each step without holding a worker
+	NOUS_Multithreading::NOUS_Task<void> LoadModelDelayed(std::string meshPath, std::string materialPath, uint32 delayMS);
+
 public:
 
 	Camera* gameCamera;
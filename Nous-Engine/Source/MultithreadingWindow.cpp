@@ -46,21 +46,33 @@ void Multithreading::Draw()
             NOUS_VulkanMultithreading::RecreateWorkerCommandPools(VulkanBackend::GetVulkanContext());
         }
 
+        ImGui::SameLine();
+        bool pinWorkers = External->jobSystem->GetThreadPool().IsPinningWorkers();
+        if (ImGui::Checkbox("Pin Workers", &pinWorkers))
+        {
+            External->jobSystem->SetWorkerPinning(pinWorkers);
+            NOUS_VulkanMultithreading::RecreateWorkerCommandPools(VulkanBackend::GetVulkanContext());
+        }
+
         ImGui::Separator();
         
-        static const auto& threadPool = External->jobSystem->GetThreadPool();
-        static const auto& threads = threadPool.GetThreads();
-        static const auto& jobQueue = threadPool.GetJobQueue();
+        // Not cached, Resize() replaces the thread pool
+        const auto& threadPool = External->jobSystem->GetThreadPool();
+        const auto& threads = threadPool.GetThreads();
 
         ImGui::Columns(2);
         ImGui::Text("Max Hardware Threads: %u", NOUS_Multithreading::c_MAX_HARDWARE_THREADS);
-        ImGui::Text("Total Worker Threads: %u", static_cast<uint8>(threads.size()));
+
+        const auto& topology = NOUS_Multithreading::NOUS_CpuTopology::Get();
+        ImGui::Text("CPU: %u Cores / %u Threads, %u L3, %u NUMA", topology.GetPhysicalCoreCount(), topology.GetLogicalCoreCount(),
+            topology.GetCacheDomainCount(), topology.GetNumaNodeCount());
+        ImGui::Text("Total Worker Threads: %u", static_cast<uint32>(threads.size()));
         ImGui::Text("Total Jobs: %u", External->jobSystem->GetPendingJobs());
         ImGui::NextColumn();
 
         auto* mainThread = NOUS_Multithreading::GetMainThread();
         
-        NOUS_Multithreading::NOUS_Job mainThreadJob("Nous Engine", {});
+        NOUS_Multithreading::NOUS_Job mainThreadJob("Nous Engine");
         mainThread->SetCurrentJob(&mainThreadJob);
 
         // Calculate active threads
@@ -118,7 +130,7 @@ void Multithreading::Draw()
         ImGui::Separator();
 
         // Thread details table
-        if (ImGui::BeginTable("ThreadsTable", 5,
+        if (ImGui::BeginTable("ThreadsTable", 6,
             ImGuiTableFlags_Borders |
             ImGuiTableFlags_RowBg |
             ImGuiTableFlags_Resizable |
@@ -130,11 +142,14 @@ void Multithreading::Draw()
             ImGui::TableSetupColumn("State", ImGuiTableColumnFlags_WidthFixed, 100.0f);
             ImGui::TableSetupColumn("Current Job", ImGuiTableColumnFlags_WidthFixed, 100.0f);
             ImGui::TableSetupColumn("Time (s)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("Core", ImGuiTableColumnFlags_WidthFixed, 60.0f);
             ImGui::TableHeadersRow();
 
             // Table contents
-            for (const auto& thread : allThreads)
+            for (uint32 i = 0; i < allThreads.size(); ++i)
             {
+                const auto& thread = allThreads[i];
+
                 ImGui::TableNextRow();
 
                 // Status indicator
@@ -160,7 +175,7 @@ void Multithreading::Draw()
                 ImGui::TableSetColumnIndex(3);
                 if (thread->GetCurrentJob())
                 {
-                    ImGui::Text("%s", thread->GetCurrentJob()->GetName().c_str());
+                    ImGui::Text("%s", thread->GetCurrentJob()->GetName());
                 }
                 else
                 {
@@ -170,6 +185,18 @@ void Multithreading::Draw()
                 // Time
                 ImGui::TableSetColumnIndex(4);
                 ImGui::Text("%.3f", thread->GetExecutionTimeMS() / 1000);
+
+                // Pinned core, workers come after the main thread
+                ImGui::TableSetColumnIndex(5);
+                const auto* core = (mainThread && i == 0) ? nullptr : threadPool.GetWorkerCore(mainThread ? i - 1 : i);
+                if (core)
+                {
+                    ImGui::Text("%u%s", core->id, core->smtIndex > 0 ? " (SMT)" : "");
+                }
+                else
+                {
+                    ImGui::TextDisabled("-");
+                }
             }
 
             ImGui::EndTable();
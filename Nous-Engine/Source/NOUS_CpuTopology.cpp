@@ -0,0 +1,421 @@
+#include "NOUS_CpuTopology.h"
+
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif
+
+#ifndef _WIN32
+namespace
+{
+	const char* c_SYSFS_CPU_PATH = "/sys/devices/system/cpu/";
+
+	bool ReadLine(const std::string& path, std::string& outLine)
+	{
+		std::ifstream file(path);
+		return static_cast<bool>(std::getline(file, outLine));
+	}
+
+	/// @brief Parses a whole decimal number. Detection runs during static initialization, so nothing here throws.
+	bool ParseNumber(const std::string& text, uint32& outValue)
+	{
+		const char* end = text.data() + text.size();
+
+		uint32 value = 0;
+		const std::from_chars_result result = std::from_chars(text.data(), end, value);
+
+		if (result.ec != std::errc() || result.ptr != end) return false;
+
+		outValue = value;
+		return true;
+	}
+
+	/// @brief Parses sysfs cpu lists ("0-3,8,10-11"), malformed ranges are skipped.
+	std::vector<uint32> ParseCpuList(const std::string& list)
+	{
+		std::vector<uint32> cpus;
+		std::stringstream stream(list);
+		std::string range;
+
+		while (std::getline(stream, range, ','))
+		{
+			const size_t dash = range.find('-');
+
+			uint32 first = 0;
+			uint32 last = 0;
+
+			if (!ParseNumber(range.substr(0, dash), first)) continue;
+			if (dash == std::string::npos) last = first;
+			else if (!ParseNumber(range.substr(dash + 1), last)) continue;
+
+			for (uint32 cpu = first; cpu <= last; ++cpu)
+			{
+				cpus.push_back(cpu);
+			}
+		}
+
+		return cpus;
+	}
+
+	/// @return Cpus of the process affinity mask.
+	std::vector<uint32> GetAllowedCpus(uint32 maxCpu)
+	{
+		std::vector<uint32> cpus;
+
+		cpu_set_t* set = CPU_ALLOC(maxCpu + 1);
+		const size_t setSize = CPU_ALLOC_SIZE(maxCpu + 1);
+
+		CPU_ZERO_S(setSize, set);
+
+		if (sched_getaffinity(0, setSize, set) == 0)
+		{
+			for (uint32 cpu = 0; cpu <= maxCpu; ++cpu)
+			{
+				if (CPU_ISSET_S(cpu, setSize, set)) cpus.push_back(cpu);
+			}
+		}
+
+		CPU_FREE(set);
+
+		return cpus;
+	}
+}
+#endif
+
+/// @return Topology of the machine, detected on first use.
+const NOUS_Multithreading::NOUS_CpuTopology& NOUS_Multithreading::NOUS_CpuTopology::Get()
+{
+	static const NOUS_CpuTopology topology;
+	return topology;
+}
+
+/// @brief NOUS_CpuTopology constructor, detects the topology.
+NOUS_Multithreading::NOUS_CpuTopology::NOUS_CpuTopology() :
+	mPhysicalCoreCount(0), mCacheDomainCount(0), mNumaNodeCount(0)
+{
+	if (!DetectPlatform() || mLogicalCores.empty())
+	{
+		DetectFallback();
+	}
+
+	Finalize();
+}
+
+/// @return Logical cores the process can run on, sorted by id.
+const std::vector<NOUS_Multithreading::NOUS_LogicalCore>& NOUS_Multithreading::NOUS_CpuTopology::GetLogicalCores() const
+{
+	return mLogicalCores;
+}
+
+uint32 NOUS_Multithreading::NOUS_CpuTopology::GetLogicalCoreCount() const
+{
+	return static_cast<uint32>(mLogicalCores.size());
+}
+
+uint32 NOUS_Multithreading::NOUS_CpuTopology::GetPhysicalCoreCount() const
+{
+	return mPhysicalCoreCount;
+}
+
+uint32 NOUS_Multithreading::NOUS_CpuTopology::GetCacheDomainCount() const
+{
+	return mCacheDomainCount;
+}
+
+uint32 NOUS_Multithreading::NOUS_CpuTopology::GetNumaNodeCount() const
+{
+	return mNumaNodeCount;
+}
+
+/// @brief Order workers are placed in: the first hardware thread of every physical core, cache
+/// domains taking turns, then the SMT siblings the same way. The first core is left to the main thread.
+/// @return Indices into GetLogicalCores().
+std::vector<uint32> NOUS_Multithreading::NOUS_CpuTopology::GetWorkerPlacement() const
+{
+	std::vector<uint32> placement;
+	placement.reserve(mLogicalCores.size());
+
+	const uint32 mainThreadCore = mLogicalCores.front().physicalCore;
+	const bool reserveMainCore = mPhysicalCoreCount > 1;
+
+	// Primary hardware threads first, SMT siblings only once every core has a worker
+	for (const bool siblings : { false, true })
+	{
+		std::vector<std::vector<uint32>> domains(mCacheDomainCount);
+
+		for (uint32 i = 0; i < mLogicalCores.size(); ++i)
+		{
+			const NOUS_LogicalCore& core = mLogicalCores[i];
+
+			if ((core.smtIndex > 0) != siblings) continue;
+			if (reserveMainCore && core.physicalCore == mainThreadCore) continue;
+
+			domains[core.cacheDomain].push_back(i);
+		}
+
+		for (uint32 round = 0; ; ++round)
+		{
+			bool placed = false;
+
+			for (const std::vector<uint32>& domain : domains)
+			{
+				if (round < domain.size())
+				{
+					placement.push_back(domain[round]);
+					placed = true;
+				}
+			}
+
+			if (!placed) break;
+		}
+	}
+
+	// The main thread's core is still used, after every other one
+	if (reserveMainCore)
+	{
+		for (uint32 i = 0; i < mLogicalCores.size(); ++i)
+		{
+			if (mLogicalCores[i].physicalCore == mainThreadCore) placement.push_back(i);
+		}
+	}
+
+	return placement;
+}
+
+/// @brief Restricts the calling thread to a single logical core.
+/// @return false if the OS refused it.
+bool NOUS_Multithreading::NOUS_CpuTopology::PinCurrentThread(const NOUS_LogicalCore& core)
+{
+#ifdef _WIN32
+	GROUP_AFFINITY affinity = {};
+	affinity.Group = static_cast<WORD>(core.id / 64);
+	affinity.Mask = static_cast<KAFFINITY>(1) << (core.id % 64);
+
+	return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+#else
+	cpu_set_t* set = CPU_ALLOC(core.id + 1);
+	const size_t setSize = CPU_ALLOC_SIZE(core.id + 1);
+
+	CPU_ZERO_S(setSize, set);
+	CPU_SET_S(core.id, setSize, set);
+
+	const int result = pthread_setaffinity_np(pthread_self(), setSize, set);
+
+	CPU_FREE(set);
+
+	return result == 0;
+#endif
+}
+
+bool NOUS_Multithreading::NOUS_CpuTopology::DetectPlatform()
+{
+#ifdef _WIN32
+	DWORD length = 0;
+	GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+
+	if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) return false;
+
+	std::vector<uint8> buffer(length);
+
+	if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length))
+	{
+		return false;
+	}
+
+	// Processors of the process affinity mask only, like sched_getaffinity() on Linux. The mask covers the primary
+	// group: a process restricted inside it stays there, an unrestricted one may also run on the other groups
+	DWORD_PTR processMask = 0;
+	DWORD_PTR systemMask = 0;
+	GROUP_AFFINITY primaryGroup = {};
+
+	const bool restricted = GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) && processMask != 0 &&
+		processMask != systemMask && GetThreadGroupAffinity(GetCurrentThread(), &primaryGroup);
+
+	auto isAllowed = [&](WORD group, KAFFINITY bit)
+		{
+			return !restricted || (group == primaryGroup.Group && (processMask & bit) != 0);
+		};
+
+	// Cores come first in practice, but caches and nodes are matched by id in case they don't
+	std::map<uint32, NOUS_LogicalCore> cores;
+	std::vector<std::pair<GROUP_AFFINITY, uint32>> caches;
+	std::vector<std::pair<GROUP_AFFINITY, uint32>> nodes;
+
+	uint32 physicalCore = 0;
+
+	for (DWORD offset = 0; offset < length; )
+	{
+		const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+
+		switch (info->Relationship)
+		{
+			case RelationProcessorCore:
+			{
+				uint32 smtIndex = 0;
+
+				for (WORD g = 0; g < info->Processor.GroupCount; ++g)
+				{
+					const GROUP_AFFINITY& group = info->Processor.GroupMask[g];
+
+					for (uint32 bit = 0; bit < 64; ++bit)
+					{
+						const KAFFINITY mask = static_cast<KAFFINITY>(1) << bit;
+
+						if ((group.Mask & mask) == 0 || !isAllowed(group.Group, mask)) continue;
+
+						const uint32 id = group.Group * 64 + bit;
+						cores[id] = { id, physicalCore, smtIndex++, 0, 0 };
+					}
+				}
+
+				physicalCore++;
+				break;
+			}
+			case RelationCache:
+			{
+				if (info->Cache.Level == 3) caches.push_back({ info->Cache.GroupMask, static_cast<uint32>(caches.size()) });
+				break;
+			}
+			case RelationNumaNode:
+			{
+				nodes.push_back({ info->NumaNode.GroupMask, info->NumaNode.NodeNumber });
+				break;
+			}
+			default:
+				break;
+		}
+
+		offset += info->Size;
+	}
+
+	for (auto& [id, core] : cores)
+	{
+		const WORD group = static_cast<WORD>(id / 64);
+		const KAFFINITY bit = static_cast<KAFFINITY>(1) << (id % 64);
+
+		for (const auto& [mask, index] : caches)
+		{
+			if (mask.Group == group && (mask.Mask & bit)) core.cacheDomain = index;
+		}
+
+		for (const auto& [mask, node] : nodes)
+		{
+			if (mask.Group == group && (mask.Mask & bit)) core.numaNode = node;
+		}
+
+		mLogicalCores.push_back(core);
+	}
+
+	return true;
+#else
+	std::string online;
+
+	if (!ReadLine(std::string(c_SYSFS_CPU_PATH) + "online", online)) return false;
+
+	const std::vector<uint32> onlineCpus = ParseCpuList(online);
+
+	if (onlineCpus.empty()) return false;
+
+	const std::vector<uint32> allowedCpus = GetAllowedCpus(*std::max_element(onlineCpus.begin(), onlineCpus.end()));
+
+	std::map<std::pair<uint32, uint32>, uint32> physicalCores;	// (package, core id) -> physical core
+	std::map<std::pair<uint32, uint32>, uint32> siblingCounts;	// (package, core id) -> hardware threads seen
+	std::map<std::string, uint32> cacheDomains;						// L3 shared_cpu_list -> domain
+
+	for (const uint32 cpu : onlineCpus)
+	{
+		if (!allowedCpus.empty() && !std::binary_search(allowedCpus.begin(), allowedCpus.end(), cpu)) continue;
+
+		const std::string cpuPath = std::string(c_SYSFS_CPU_PATH) + "cpu" + std::to_string(cpu) + "/";
+
+		std::string package, coreID;
+		std::pair<uint32, uint32> coreKey = { 0, cpu };	// Its own core when sysfs doesn't say
+
+		if (!ReadLine(cpuPath + "topology/physical_package_id", package) || !ParseNumber(package, coreKey.first)) package = "0";
+		if (ReadLine(cpuPath + "topology/core_id", coreID)) ParseNumber(coreID, coreKey.second);
+
+		NOUS_LogicalCore core = {};
+		core.id = cpu;
+		core.physicalCore = physicalCores.emplace(coreKey, static_cast<uint32>(physicalCores.size())).first->second;
+		core.smtIndex = siblingCounts[coreKey]++;
+
+		// The package is the domain when there's no L3
+		std::string cacheKey = "package" + package;
+
+		// cache/indexN, the L3 is the one with level 3
+		std::error_code error;
+
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(cpuPath + "cache", error))
+		{
+			std::string level, sharedCpus;
+
+			if (ReadLine(entry.path().string() + "/level", level) && level == "3" &&
+				ReadLine(entry.path().string() + "/shared_cpu_list", sharedCpus))
+			{
+				cacheKey = sharedCpus;
+				break;
+			}
+		}
+
+		core.cacheDomain = cacheDomains.emplace(cacheKey, static_cast<uint32>(cacheDomains.size())).first->second;
+
+		// NUMA node exposed as a nodeN link next to the topology
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(cpuPath, error))
+		{
+			const std::string name = entry.path().filename().string();
+
+			if (name.size() > 4 && name.compare(0, 4, "node") == 0 && ParseNumber(name.substr(4), core.numaNode))
+			{
+				break;
+			}
+		}
+
+		mLogicalCores.push_back(core);
+	}
+
+	return true;
+#endif
+}
+
+void NOUS_Multithreading::NOUS_CpuTopology::DetectFallback()
+{
+	mLogicalCores.clear();
+
+	const uint32 hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (uint32 i = 0; i < hardwareThreads; ++i)
+	{
+		mLogicalCores.push_back({ i, i, 0, 0, 0 });
+	}
+}
+
+/// @brief Sorts the cores and renumbers cores, cache domains and NUMA nodes from 0.
+void NOUS_Multithreading::NOUS_CpuTopology::Finalize()
+{
+	std::sort(mLogicalCores.begin(), mLogicalCores.end(), [](const NOUS_LogicalCore& a, const NOUS_LogicalCore& b) { return a.id < b.id; });
+
+	std::map<uint32, uint32> physicalCores, cacheDomains, numaNodes;
+
+	for (NOUS_LogicalCore& core : mLogicalCores)
+	{
+		core.physicalCore = physicalCores.emplace(core.physicalCore, static_cast<uint32>(physicalCores.size())).first->second;
+		core.cacheDomain = cacheDomains.emplace(core.cacheDomain, static_cast<uint32>(cacheDomains.size())).first->second;
+		core.numaNode = numaNodes.emplace(core.numaNode, static_cast<uint32>(numaNodes.size())).first->second;
+	}
+
+	mPhysicalCoreCount = static_cast<uint32>(physicalCores.size());
+	mCacheDomainCount = static_cast<uint32>(cacheDomains.size());
+	mNumaNodeCount = static_cast<uint32>(numaNodes.size());
+}
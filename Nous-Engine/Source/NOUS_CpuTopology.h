@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <vector>
+
+namespace NOUS_Multithreading
+{
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief One hardware thread the process can run on.
+	///////////////////////////////////////////////////////////////////////////
+	struct NOUS_LogicalCore
+	{
+		uint32 id;				// OS processor number (Windows: group * 64 + index inside the group)
+		uint32 physicalCore;	// Shared by SMT siblings
+		uint32 smtIndex;		// 0 for the first hardware thread of its core, 1+ for its SMT siblings
+		uint32 cacheDomain;		// Cores sharing the same last level cache (L3)
+		uint32 numaNode;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief CPU layout of the machine: physical cores, SMT siblings, L3 and NUMA domains.
+	/// Read once from sysfs on Linux and from GetLogicalProcessorInformationEx() on Windows; if neither
+	/// is available every hardware thread counts as its own core inside a single cache and NUMA domain.
+	/// Physical cores, cache domains and NUMA nodes are renumbered from 0.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_CpuTopology
+	{
+	public:
+
+		/// @return Topology of the machine, detected on first use.
+		static const NOUS_CpuTopology& Get();
+
+		/// @return Logical cores the process can run on, sorted by id.
+		const std::vector<NOUS_LogicalCore>& GetLogicalCores() const;
+
+		uint32 GetLogicalCoreCount() const;
+		uint32 GetPhysicalCoreCount() const;
+		uint32 GetCacheDomainCount() const;
+		uint32 GetNumaNodeCount() const;
+
+		/// @brief Order workers are placed in: the first hardware thread of every physical core, cache
+		/// domains taking turns, then the SMT siblings the same way. The first core is left to the main thread.
+		/// @return Indices into GetLogicalCores().
+		std::vector<uint32> GetWorkerPlacement() const;
+
+		/// @brief Restricts the calling thread to a single logical core.
+		/// @return false if the OS refused it.
+		static bool PinCurrentThread(const NOUS_LogicalCore& core);
+
+		/// @brief NOUS_CpuTopology delete copy operators.
+		NOUS_CpuTopology(const NOUS_CpuTopology&) = delete;
+		NOUS_CpuTopology& operator=(const NOUS_CpuTopology&) = delete;
+
+	private:
+
+		/// @brief NOUS_CpuTopology constructor, detects the topology.
+		NOUS_CpuTopology();
+
+		bool DetectPlatform();
+		void DetectFallback();
+
+		/// @brief Sorts the cores and renumbers cores, cache domains and NUMA nodes from 0.
+		void Finalize();
+
+	private:
+
+		// Plain std containers, detected during static initialization before the memory manager exists
+		std::vector<NOUS_LogicalCore>	mLogicalCores;
+
+		uint32		mPhysicalCoreCount;
+		uint32		mCacheDomainCount;
+		uint32		mNumaNodeCount;
+
+	};
+}
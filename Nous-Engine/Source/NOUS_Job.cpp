@@ -1,24 +1,259 @@
 #include "NOUS_Job.h"
 
+#include <unordered_set>
+
 #ifdef TRACY_ENABLE
 #include "Tracy.h"
 #endif
 
-/// @brief NOUS_Job constructor.
-NOUS_Multithreading::NOUS_Job::NOUS_Job(const std::string& name, std::function<void()> func) :
-	mName(name), mFunction(func) 
+/// @return Display name of a job priority.
+const char* NOUS_Multithreading::GetJobPriorityName(NOUS_JobPriority priority)
+{
+	switch (priority)
+	{
+		case NOUS_JobPriority::CRITICAL:	return "Critical";
+		case NOUS_JobPriority::HIGH:		return "High";
+		case NOUS_JobPriority::NORMAL:		return "Normal";
+		case NOUS_JobPriority::BACKGROUND:	return "Background";
+		default:							return "Unknown";
+	}
+}
+
+// ------------------------------------------------------------------------ //
+
+NOUS_Multithreading::NOUS_JobName::NOUS_JobName(const std::string& name)
+{
+	// Plain std containers, the table outlives the memory manager
+	static std::mutex internMutex;
+	static std::unordered_set<std::string> internedNames;
+
+	std::lock_guard<std::mutex> lock(internMutex);
+
+	mName = internedNames.insert(name).first->c_str();
+}
+
+// ------------------------------------------------------------------------ //
+
+/// @brief NOUS_JobFunction destructor.
+NOUS_Multithreading::NOUS_JobFunction::~NOUS_JobFunction()
+{
+	if (mDestroy)
+	{
+		mDestroy(mCallable, IsHeapAllocated());
+	}
+}
+
+void NOUS_Multithreading::NOUS_JobFunction::operator()()
+{
+	if (mInvoke)
+	{
+		mInvoke(mCallable);
+	}
+}
+
+/// @return true if the callable didn't fit in the inline buffer.
+bool NOUS_Multithreading::NOUS_JobFunction::IsHeapAllocated() const
+{
+	return mCallable != nullptr && mCallable != static_cast<const void*>(mStorage);
+}
+
+// ------------------------------------------------------------------------ //
+
+/// @brief NOUS_Job constructors.
+NOUS_Multithreading::NOUS_Job::NOUS_Job(NOUS_JobName name) :
+	mName(name), mPriority(NOUS_JobPriority::NORMAL), mMainThreadOnly(false), mDependencyCount(0), mNext(nullptr), mEnqueueTime(0)
 {
 
 }
 
 /// @brief Executes the stored function inside the job.
-void NOUS_Multithreading::NOUS_Job::Execute() 
-{ 
-	mFunction(); 
+void NOUS_Multithreading::NOUS_Job::Execute()
+{
+	mFunction();
+}
+
+/// @return NOUS_Job name identifier.
+const char* NOUS_Multithreading::NOUS_Job::GetName() const
+{
+	return mName.GetString();
+}
+
+NOUS_Multithreading::NOUS_JobPriority NOUS_Multithreading::NOUS_Job::GetPriority() const
+{
+	return mPriority;
+}
+
+/// @brief Main thread jobs are queued to NOUS_MainThreadQueue instead of the thread pool.
+void NOUS_Multithreading::NOUS_Job::SetMainThreadOnly(bool mainThreadOnly)
+{
+	mMainThreadOnly = mainThreadOnly;
+}
+
+bool NOUS_Multithreading::NOUS_Job::IsMainThreadOnly() const
+{
+	return mMainThreadOnly;
+}
+
+/// @brief Intrusive link, used by the queues that don't own a slot per job.
+void NOUS_Multithreading::NOUS_Job::SetNext(NOUS_Job* next)
+{
+	mNext = next;
+}
+
+NOUS_Multithreading::NOUS_Job* NOUS_Multithreading::NOUS_Job::GetNext() const
+{
+	return mNext;
+}
+
+/// @brief Time the job became ready to run, set by NOUS_JobProfiler while it's recording.
+void NOUS_Multithreading::NOUS_Job::SetEnqueueTime(uint64 enqueueTime)
+{
+	mEnqueueTime = enqueueTime;
+}
+
+uint64 NOUS_Multithreading::NOUS_Job::GetEnqueueTime() const
+{
+	return mEnqueueTime;
+}
+
+/// @brief A job only runs once every dependency has been resolved.
+void NOUS_Multithreading::NOUS_Job::AddDependency()
+{
+	mDependencyCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// @return true if that was the last pending dependency, the job is ready to run.
+bool NOUS_Multithreading::NOUS_Job::ResolveDependency()
+{
+	return mDependencyCount.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+// ------------------------------------------------------------------------ //
+
+/// @brief NOUS_JobState constructor.
+/// @param pool: Pool the state was created from.
+NOUS_Multithreading::NOUS_JobState::NOUS_JobState(NOUS_JobStatePool* pool) :
+	mPool(pool), mReferenceCount(1), mCompleted(false)
+{
+
+}
+
+void NOUS_Multithreading::NOUS_JobState::AddReference()
+{
+	mReferenceCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NOUS_Multithreading::NOUS_JobState::Release()
+{
+	if (mReferenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		NOUS_JobState* state = this;
+		mPool->Delete(state);
+	}
+}
+
+bool NOUS_Multithreading::NOUS_JobState::IsComplete() const
+{
+	return mCompleted.load(std::memory_order_acquire);
+}
+
+/// @brief Registers a job to be released when this one completes.
+/// @return false if it has already completed, the continuation doesn't need to wait.
+bool NOUS_Multithreading::NOUS_JobState::AddContinuation(NOUS_Job* job)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (mCompleted.load(std::memory_order_relaxed)) return false;
+
+	mContinuations.push_back(job);
+
+	return true;
+}
+
+/// @brief Marks the job as complete and hands over the continuations waiting on it.
+void NOUS_Multithreading::NOUS_JobState::Complete(nous::vector<NOUS_Job*, MemoryManager::MemoryTag::JOB>& outContinuations)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mCompleted.store(true, std::memory_order_release);
+	outContinuations.swap(mContinuations);
+}
+
+// ------------------------------------------------------------------------ //
+
+NOUS_Multithreading::NOUS_JobHandle::NOUS_JobHandle(NOUS_JobState* state) :
+	mState(state)
+{
+	if (mState) mState->AddReference();
+}
+
+/// @brief NOUS_JobHandle destructor.
+NOUS_Multithreading::NOUS_JobHandle::~NOUS_JobHandle()
+{
+	Reset();
 }
 
-/// @return std::string with the NOUS_Job name identifier.
-const std::string& NOUS_Multithreading::NOUS_Job::GetName() const 
-{ 
-	return mName; 
+/// @brief NOUS_JobHandle copy and move semantics definition.
+
+NOUS_Multithreading::NOUS_JobHandle::NOUS_JobHandle(const NOUS_JobHandle& other) :
+	mState(other.mState)
+{
+	if (mState) mState->AddReference();
+}
+
+NOUS_Multithreading::NOUS_JobHandle::NOUS_JobHandle(NOUS_JobHandle&& other) noexcept :
+	mState(other.mState)
+{
+	other.mState = nullptr;
+}
+
+NOUS_Multithreading::NOUS_JobHandle& NOUS_Multithreading::NOUS_JobHandle::operator=(const NOUS_JobHandle& other)
+{
+	if (this != &other)
+	{
+		if (other.mState) other.mState->AddReference();
+
+		Reset();
+		mState = other.mState;
+	}
+
+	return *this;
+}
+
+NOUS_Multithreading::NOUS_JobHandle& NOUS_Multithreading::NOUS_JobHandle::operator=(NOUS_JobHandle&& other) noexcept
+{
+	if (this != &other)
+	{
+		Reset();
+
+		mState = other.mState;
+		other.mState = nullptr;
+	}
+
+	return *this;
+}
+
+bool NOUS_Multithreading::NOUS_JobHandle::IsValid() const
+{
+	return mState != nullptr;
+}
+
+bool NOUS_Multithreading::NOUS_JobHandle::IsComplete() const
+{
+	return !mState || mState->IsComplete();
+}
+
+/// @brief Drops the reference to the job, the handle becomes empty.
+void NOUS_Multithreading::NOUS_JobHandle::Reset()
+{
+	if (mState)
+	{
+		mState->Release();
+		mState = nullptr;
+	}
+}
+
+NOUS_Multithreading::NOUS_JobState* NOUS_Multithreading::NOUS_JobHandle::GetState() const
+{
+	return mState;
 }
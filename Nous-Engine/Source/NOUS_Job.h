@@ -2,10 +2,102 @@
 
 #include "Globals.h"
 
-#include <functional>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <mutex>
+#include <string>
+
+#include "MemoryManager.h"
+#include "PoolAllocator.h"
+#include "NousAllocator.h"
 
 namespace NOUS_Multithreading
 {
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Job priority levels, each one has its own queues. Workers always drain higher
+	/// priorities first; background jobs only run on a capped number of workers at once.
+	///////////////////////////////////////////////////////////////////////////
+	enum class NOUS_JobPriority : uint8
+	{
+		CRITICAL = 0,	// Work the current frame is waiting on
+		HIGH,			// Work needed within the next frames
+		NORMAL,
+		BACKGROUND,		// Asset streaming, imports and other long-running work
+
+		COUNT
+	};
+
+	/// @return Display name of a job priority.
+	const char* GetJobPriorityName(NOUS_JobPriority priority);
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Job name identifier, a pointer to a string that outlives every job using it.
+	/// String literals are used as they are, any other string is interned once into a table kept
+	/// for the whole execution, so jobs never copy their names.
+	/// @note The literal constructor is consteval, a const char array that isn't a literal (a local
+	/// buffer) doesn't compile and has to be passed as a std::string. Mutable buffers are interned.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_JobName
+	{
+	public:
+
+		/// @brief NOUS_JobName constructors.
+		template<std::size_t N>
+		consteval NOUS_JobName(const char(&literal)[N]) : mName(literal) {}
+		template<std::size_t N>
+		NOUS_JobName(char(&buffer)[N]) : NOUS_JobName(std::string(buffer)) {}
+		NOUS_JobName(const std::string& name);
+
+		const char* GetString() const { return mName; }
+
+	private:
+
+		const char*		mName;
+
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Type-erased void() callable stored inside the job. Callables up to c_INLINE_SIZE bytes
+	/// live in the inline buffer, larger ones fall back to a heap allocation.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_JobFunction
+	{
+	public:
+
+		static constexpr uint64 c_INLINE_SIZE = 64;
+
+		/// @brief NOUS_JobFunction constructors, an empty function does nothing when invoked.
+		NOUS_JobFunction() = default;
+
+		template<typename Function>
+		NOUS_JobFunction(Function&& function);
+
+		/// @brief NOUS_JobFunction destructor.
+		~NOUS_JobFunction();
+
+		/// @brief NOUS_JobFunction delete copy and move operators, jobs never leave their pool slot.
+		NOUS_JobFunction(const NOUS_JobFunction&) = delete;
+		NOUS_JobFunction& operator=(const NOUS_JobFunction&) = delete;
+
+		void operator()();
+
+		/// @return true if the callable didn't fit in the inline buffer.
+		bool IsHeapAllocated() const;
+
+	private:
+
+		typedef void (*PFN_Invoke)(void* callable);
+		typedef void (*PFN_Destroy)(void* callable, bool heapAllocated);
+
+		alignas(std::max_align_t) unsigned char		mStorage[c_INLINE_SIZE];
+
+		void*			mCallable = nullptr;
+		PFN_Invoke		mInvoke = nullptr;
+		PFN_Destroy		mDestroy = nullptr;
+
+	};
+
 	///////////////////////////////////////////////////////////////////////////
 	/// @brief Represents an executable task with a name and function.
 	///////////////////////////////////////////////////////////////////////////
@@ -13,19 +105,165 @@ namespace NOUS_Multithreading
 	{
 	public:
 
-		/// @brief NOUS_Job constructor.
-		NOUS_Job(const std::string& name, std::function<void()> func);
+		/// @brief NOUS_Job constructors.
+		explicit NOUS_Job(NOUS_JobName name);
+
+		template<typename Function>
+		NOUS_Job(NOUS_JobName name, Function&& function, NOUS_JobPriority priority = NOUS_JobPriority::NORMAL);
 
 		/// @brief Executes the stored function inside the job.
 		void Execute();
 
-		/// @return std::string with the NOUS_Job name identifier.
-		const std::string& GetName() const;
+		/// @return NOUS_Job name identifier.
+		const char* GetName() const;
+
+		NOUS_JobPriority GetPriority() const;
+
+		/// @brief Main thread jobs are queued to NOUS_MainThreadQueue instead of the thread pool.
+		void SetMainThreadOnly(bool mainThreadOnly);
+		bool IsMainThreadOnly() const;
+
+		/// @brief Intrusive link, used by the queues that don't own a slot per job.
+		void SetNext(NOUS_Job* next);
+		NOUS_Job* GetNext() const;
+
+		/// @brief Time the job became ready to run, set by NOUS_JobProfiler while it's recording.
+		void SetEnqueueTime(uint64 enqueueTime);
+		uint64 GetEnqueueTime() const;
+
+		/// @brief A job only runs once every dependency has been resolved.
+		void AddDependency();
+
+		/// @return true if that was the last pending dependency, the job is ready to run.
+		bool ResolveDependency();
 
 	private:
 
-		std::string				mName;
-		std::function<void()>	mFunction;
+		NOUS_JobFunction		mFunction;
+		NOUS_JobName			mName;
+		NOUS_JobPriority		mPriority;
+		bool					mMainThreadOnly;
+
+		std::atomic<uint32>		mDependencyCount;
+		NOUS_Job*				mNext;
+		uint64					mEnqueueTime;
 
 	};
-}
\ No newline at end of file
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Lock-free pool the jobs are allocated from, shared by submitters and workers.
+	///////////////////////////////////////////////////////////////////////////
+	using NOUS_JobPool = PoolAllocator<NOUS_Job, true>;
+
+	class NOUS_JobState;
+
+	using NOUS_JobStatePool = PoolAllocator<NOUS_JobState, true>;
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Completion state of a submitted job, shared by its handles. Keeps the jobs that
+	/// depend on it (continuations) until it completes. Reference counted, returns to its pool
+	/// once the job has finished and no handle is left.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_JobState
+	{
+	public:
+
+		/// @brief NOUS_JobState constructor.
+		/// @param pool: Pool the state was created from.
+		NOUS_JobState(NOUS_JobStatePool* pool);
+
+		void AddReference();
+		void Release();
+
+		bool IsComplete() const;
+
+		/// @brief Registers a job to be released when this one completes.
+		/// @return false if it has already completed, the continuation doesn't need to wait.
+		bool AddContinuation(NOUS_Job* job);
+
+		/// @brief Marks the job as complete and hands over the continuations waiting on it.
+		void Complete(nous::vector<NOUS_Job*, MemoryManager::MemoryTag::JOB>& outContinuations);
+
+	private:
+
+		NOUS_JobStatePool*		mPool;
+		std::atomic<uint32>		mReferenceCount;
+		std::atomic<bool>		mCompleted;
+
+		std::mutex												mMutex;
+		nous::vector<NOUS_Job*, MemoryManager::MemoryTag::JOB>	mContinuations;
+
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Reference to a submitted job, used to wait for it or to make other jobs depend on it.
+	/// @note Handles must be released before the job system that created them is destroyed.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_JobHandle
+	{
+	public:
+
+		/// @brief NOUS_JobHandle constructors, an empty handle counts as complete.
+		NOUS_JobHandle() = default;
+		explicit NOUS_JobHandle(NOUS_JobState* state);
+
+		/// @brief NOUS_JobHandle destructor.
+		~NOUS_JobHandle();
+
+		/// @brief NOUS_JobHandle copy and move semantics definition.
+		NOUS_JobHandle(const NOUS_JobHandle& other);
+		NOUS_JobHandle(NOUS_JobHandle&& other) noexcept;
+		NOUS_JobHandle& operator=(const NOUS_JobHandle& other);
+		NOUS_JobHandle& operator=(NOUS_JobHandle&& other) noexcept;
+
+		bool IsValid() const;
+		bool IsComplete() const;
+
+		/// @brief Drops the reference to the job, the handle becomes empty.
+		void Reset();
+
+		NOUS_JobState* GetState() const;
+
+	private:
+
+		NOUS_JobState*	mState = nullptr;
+
+	};
+
+	template<typename Function>
+	inline NOUS_JobFunction::NOUS_JobFunction(Function&& function)
+	{
+		using Callable = std::decay_t<Function>;
+
+		if constexpr (sizeof(Callable) <= c_INLINE_SIZE && alignof(Callable) <= alignof(std::max_align_t))
+		{
+			mCallable = new(mStorage) Callable(std::forward<Function>(function));
+		}
+		else
+		{
+			mCallable = NOUS_NEW_ALIGNED<Callable>(alignof(Callable), MemoryManager::MemoryTag::JOB, std::forward<Function>(function));
+		}
+
+		mInvoke = [](void* callable) { (*static_cast<Callable*>(callable))(); };
+
+		mDestroy = [](void* callable, bool heapAllocated) {
+			Callable* typedCallable = static_cast<Callable*>(callable);
+
+			if (heapAllocated)
+			{
+				NOUS_DELETE_ALIGNED<Callable>(typedCallable, alignof(Callable), MemoryManager::MemoryTag::JOB);
+			}
+			else
+			{
+				typedCallable->~Callable();
+			}
+			};
+	}
+
+	template<typename Function>
+	inline NOUS_Job::NOUS_Job(NOUS_JobName name, Function&& function, NOUS_JobPriority priority) :
+		mFunction(std::forward<Function>(function)), mName(name), mPriority(priority), mMainThreadOnly(false), mDependencyCount(0), mNext(nullptr), mEnqueueTime(0)
+	{
+
+	}
+}
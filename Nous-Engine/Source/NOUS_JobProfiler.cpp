@@ -0,0 +1,489 @@
+#include "NOUS_JobProfiler.h"
+
+#include "Logger.h"
+#include "VirtualMemory.h"
+
+#include "External/Parson/parson.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <string_view>
+#include <unordered_map>
+
+/// @brief Reference point of every profiler time, taken during static initialization.
+static const std::chrono::steady_clock::time_point sProfilerEpoch = std::chrono::steady_clock::now();
+
+// Slot::info layout
+static constexpr uint64 c_INFO_RECORDING_SHIFT = 16;
+static constexpr uint64 c_INFO_PRIORITY_SHIFT = 32;
+static constexpr uint64 c_INFO_STOLEN = 1ULL << 40;
+static constexpr uint64 c_INFO_NESTED = 1ULL << 41;
+static constexpr uint64 c_INFO_MAIN_THREAD_TASK = 1ULL << 42;
+
+thread_local NOUS_Multithreading::NOUS_JobProfiler::ThreadState NOUS_Multithreading::NOUS_JobProfiler::tThreadState;
+
+/// @return Profiler shared by every job system.
+NOUS_Multithreading::NOUS_JobProfiler& NOUS_Multithreading::NOUS_JobProfiler::Get()
+{
+	static NOUS_JobProfiler profiler;
+	return profiler;
+}
+
+/// @brief NOUS_JobProfiler constructor and destructor.
+NOUS_Multithreading::NOUS_JobProfiler::NOUS_JobProfiler() :
+	mRecording(false), mRecordingID(0), mStartTime(0), mStopTime(0)
+{
+
+}
+
+NOUS_Multithreading::NOUS_JobProfiler::~NOUS_JobProfiler()
+{
+	const uint64 bufferSize = VirtualMemory::AlignToPage(c_EVENTS_PER_THREAD * sizeof(Slot));
+
+	for (ThreadBuffer* buffer : mBuffers)
+	{
+		VirtualMemory::Release(buffer->slots, bufferSize);
+		delete buffer;
+	}
+}
+
+/// @brief Gives the buffer back when the thread exits.
+NOUS_Multithreading::NOUS_JobProfiler::ThreadState::~ThreadState()
+{
+	if (buffer) buffer->inUse.store(false, std::memory_order_release);
+}
+
+/// @brief Starts a new recording, discarding the previous one.
+void NOUS_Multithreading::NOUS_JobProfiler::Start()
+{
+	// Events keep 16 bits of the id, 0 is never used so buffers that never recorded don't match
+	const uint32 recordingID = (mRecordingID.load(std::memory_order_relaxed) % 0xFFFF) + 1;
+
+	mStartTime.store(GetTime(), std::memory_order_relaxed);
+	mStopTime.store(0, std::memory_order_relaxed);
+	mRecordingID.store(recordingID, std::memory_order_relaxed);
+
+	mRecording.store(true, std::memory_order_release);
+
+	NOUS_INFO("Job profiler recording started");
+}
+
+void NOUS_Multithreading::NOUS_JobProfiler::Stop()
+{
+	if (!mRecording.exchange(false, std::memory_order_acq_rel)) return;
+
+	mStopTime.store(GetTime(), std::memory_order_relaxed);
+
+	NOUS_INFO("Job profiler recording stopped");
+}
+
+bool NOUS_Multithreading::NOUS_JobProfiler::IsRecording() const
+{
+	return mRecording.load(std::memory_order_relaxed);
+}
+
+/// @return Nanoseconds since the profiler was created.
+uint64 NOUS_Multithreading::NOUS_JobProfiler::GetTime()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sProfilerEpoch).count();
+}
+
+/// @brief Names the calling thread in the recordings, threads not registered are named after their index.
+void NOUS_Multithreading::NOUS_JobProfiler::RegisterThread(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	ThreadState& state = tThreadState;
+
+	if (state.registered)
+	{
+		mThreadNames[state.threadIndex] = name;
+	}
+	else
+	{
+		RegisterThreadIndex(state, name);
+	}
+}
+
+/// @brief Called by the queues when a job becomes ready to run, its queue wait starts here.
+void NOUS_Multithreading::NOUS_JobProfiler::MarkEnqueued(NOUS_Job* job) const
+{
+	if (IsRecording()) job->SetEnqueueTime(GetTime());
+}
+
+/// @brief Called right before a job is executed, on the thread executing it.
+/// @return Start time to pass to EndJob(), 0 if not recording.
+uint64 NOUS_Multithreading::NOUS_JobProfiler::BeginJob()
+{
+	tThreadState.depth++;
+
+	return IsRecording() ? std::max<uint64>(GetTime(), 1) : 0;
+}
+
+/// @brief Called once the job has executed, before it's deleted.
+/// @param stolen: The job was taken from another worker's deque.
+void NOUS_Multithreading::NOUS_JobProfiler::EndJob(const NOUS_Job* job, uint64 startTime, bool stolen)
+{
+	ThreadState& state = tThreadState;
+	state.depth--;
+
+	if (startTime == 0) return;
+
+	const uint64 endTime = GetTime();
+
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	if (!buffer) return;
+
+	const uint32 recordingID = mRecordingID.load(std::memory_order_relaxed);
+	const uint64 index = buffer->writeIndex.load(std::memory_order_relaxed);
+
+	if (buffer->recording.load(std::memory_order_relaxed) != recordingID)
+	{
+		buffer->recordingFirstIndex.store(index, std::memory_order_relaxed);
+		buffer->recording.store(recordingID, std::memory_order_relaxed);
+	}
+
+	const uint64 enqueueTime = job->GetEnqueueTime();
+
+	uint64 info = state.threadIndex | (static_cast<uint64>(recordingID) << c_INFO_RECORDING_SHIFT) |
+		(static_cast<uint64>(job->GetPriority()) << c_INFO_PRIORITY_SHIFT);
+
+	if (stolen) info |= c_INFO_STOLEN;
+	if (state.depth > 0) info |= c_INFO_NESTED;
+	if (job->IsMainThreadOnly()) info |= c_INFO_MAIN_THREAD_TASK;
+
+	// Pairs with the fence in ReadEvents(): a reader seeing any word of this event also sees the index before it,
+	// and knows the event this slot held is gone
+	std::atomic_thread_fence(std::memory_order_release);
+
+	Slot& slot = buffer->slots[index % c_EVENTS_PER_THREAD];
+
+	std::atomic_ref<uint64>(slot.name).store(reinterpret_cast<uint64>(job->GetName()), std::memory_order_relaxed);
+	std::atomic_ref<uint64>(slot.enqueueTime).store((enqueueTime != 0 && enqueueTime <= startTime) ? enqueueTime : startTime, std::memory_order_relaxed);
+	std::atomic_ref<uint64>(slot.startTime).store(startTime, std::memory_order_relaxed);
+	std::atomic_ref<uint64>(slot.endTime).store(endTime, std::memory_order_relaxed);
+	std::atomic_ref<uint64>(slot.info).store(info, std::memory_order_relaxed);
+
+	buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+/// @brief Copies the events of the current recording, sorted by start time.
+void NOUS_Multithreading::NOUS_JobProfiler::GetEvents(std::vector<NOUS_JobEvent>& outEvents) const
+{
+	outEvents.clear();
+
+	ReadEvents(outEvents);
+
+	std::sort(outEvents.begin(), outEvents.end(), [](const NOUS_JobEvent& a, const NOUS_JobEvent& b) {
+		return a.startTime < b.startTime;
+		});
+}
+
+/// @return Per job name and per thread statistics of the current recording.
+NOUS_Multithreading::NOUS_JobProfile NOUS_Multithreading::NOUS_JobProfiler::BuildProfile() const
+{
+	NOUS_JobProfile profile = {};
+
+	std::vector<NOUS_JobEvent> events;
+	profile.overwrittenEvents = ReadEvents(events);
+
+	profile.startTime = mStartTime.load(std::memory_order_relaxed);
+	profile.endTime = IsRecording() ? GetTime() : mStopTime.load(std::memory_order_relaxed);
+	profile.eventCount = events.size();
+
+	// Names are compared by content, the same literal may have a different address in every translation unit
+	std::unordered_map<std::string_view, uint64> jobIndices;
+	std::unordered_map<uint16, uint64> threadIndices;
+
+	for (const NOUS_JobEvent& event : events)
+	{
+		const uint64 duration = event.endTime - event.startTime;
+		const uint64 waitTime = event.startTime - event.enqueueTime;
+
+		auto [jobIt, newJob] = jobIndices.try_emplace(event.name, profile.jobs.size());
+
+		if (newJob)
+		{
+			NOUS_JobNameStats jobStats = {};
+			jobStats.name = event.name;
+			jobStats.minTime = UINT64_MAX;
+
+			profile.jobs.push_back(jobStats);
+		}
+
+		NOUS_JobNameStats& job = profile.jobs[jobIt->second];
+
+		job.count++;
+		job.totalTime += duration;
+		job.minTime = std::min(job.minTime, duration);
+		job.maxTime = std::max(job.maxTime, duration);
+		job.totalWaitTime += waitTime;
+		job.maxWaitTime = std::max(job.maxWaitTime, waitTime);
+		job.histogram[std::min<uint64>(std::bit_width(duration / 1000), c_JOB_HISTOGRAM_BUCKETS - 1)]++;
+
+		auto [threadIt, newThread] = threadIndices.try_emplace(event.threadIndex, profile.threads.size());
+
+		if (newThread)
+		{
+			NOUS_JobThreadStats threadStats = {};
+			threadStats.threadIndex = event.threadIndex;
+
+			profile.threads.push_back(threadStats);
+		}
+
+		NOUS_JobThreadStats& thread = profile.threads[threadIt->second];
+
+		thread.executedJobs++;
+		thread.totalWaitTime += waitTime;
+
+		if (event.stolen) thread.stolenJobs++;
+		if (!event.nested) thread.busyTime += duration;
+	}
+
+	const uint64 duration = (profile.endTime > profile.startTime) ? profile.endTime - profile.startTime : 0;
+
+	for (NOUS_JobThreadStats& thread : profile.threads)
+	{
+		thread.name = GetThreadName(thread.threadIndex);
+		thread.utilization = (duration > 0) ? std::min(static_cast<float>(static_cast<double>(thread.busyTime) / duration), 1.0f) : 0.0f;
+	}
+
+	std::sort(profile.jobs.begin(), profile.jobs.end(), [](const NOUS_JobNameStats& a, const NOUS_JobNameStats& b) {
+		return a.totalTime > b.totalTime;
+		});
+
+	std::sort(profile.threads.begin(), profile.threads.end(), [](const NOUS_JobThreadStats& a, const NOUS_JobThreadStats& b) {
+		return a.threadIndex < b.threadIndex;
+		});
+
+	return profile;
+}
+
+/// @brief Writes the current recording in the Chrome trace event format (JSON).
+bool NOUS_Multithreading::NOUS_JobProfiler::ExportChromeTrace(const char* path) const
+{
+	std::vector<NOUS_JobEvent> events;
+	GetEvents(events);
+
+	const uint64 startTime = mStartTime.load(std::memory_order_relaxed);
+
+	JSON_Value* rootValue = json_value_init_object();
+	JSON_Object* rootObject = json_value_get_object(rootValue);
+
+	json_object_set_string(rootObject, "displayTimeUnit", "ms");
+	json_object_set_value(rootObject, "traceEvents", json_value_init_array());
+
+	JSON_Array* traceEvents = json_object_get_array(rootObject, "traceEvents");
+
+	// Metadata events name the process and one track per thread
+	auto appendMetadata = [traceEvents](const char* type, uint16 threadIndex, const std::string& name) {
+		JSON_Value* value = json_value_init_object();
+		JSON_Object* object = json_value_get_object(value);
+
+		json_object_set_string(object, "name", type);
+		json_object_set_string(object, "ph", "M");
+		json_object_set_number(object, "pid", 1);
+		json_object_set_number(object, "tid", threadIndex);
+		json_object_dotset_string(object, "args.name", name.c_str());
+
+		json_array_append_value(traceEvents, value);
+		};
+
+	appendMetadata("process_name", 0, "Nous Engine Jobs");
+
+	std::vector<uint16> threads;
+
+	for (const NOUS_JobEvent& event : events)
+	{
+		if (std::find(threads.begin(), threads.end(), event.threadIndex) == threads.end())
+		{
+			threads.push_back(event.threadIndex);
+			appendMetadata("thread_name", event.threadIndex, GetThreadName(event.threadIndex));
+		}
+
+		JSON_Value* value = json_value_init_object();
+		JSON_Object* object = json_value_get_object(value);
+
+		// Complete events, timestamps in microseconds from the start of the recording
+		json_object_set_string(object, "name", event.name);
+		json_object_set_string(object, "cat", GetJobPriorityName(event.priority));
+		json_object_set_string(object, "ph", "X");
+		json_object_set_number(object, "ts", (event.startTime - startTime) / 1000.0);
+		json_object_set_number(object, "dur", (event.endTime - event.startTime) / 1000.0);
+		json_object_set_number(object, "pid", 1);
+		json_object_set_number(object, "tid", event.threadIndex);
+
+		json_object_dotset_number(object, "args.queueWaitUs", (event.startTime - event.enqueueTime) / 1000.0);
+		json_object_dotset_boolean(object, "args.stolen", event.stolen);
+		json_object_dotset_boolean(object, "args.mainThreadTask", event.mainThreadTask);
+
+		json_array_append_value(traceEvents, value);
+	}
+
+	const bool saved = json_serialize_to_file(rootValue, path) == JSONSuccess;
+
+	if (saved)
+	{
+		NOUS_INFO("Job trace exported to %s (%llu events)", path, static_cast<uint64>(events.size()));
+	}
+	else
+	{
+		NOUS_ERROR("NOUS_JobProfiler::ExportChromeTrace() - Failed writing %s", path);
+	}
+
+	json_value_free(rootValue);
+
+	return saved;
+}
+
+/// @return Name the thread registered with.
+std::string NOUS_Multithreading::NOUS_JobProfiler::GetThreadName(uint16 threadIndex) const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	return (threadIndex < mThreadNames.size()) ? mThreadNames[threadIndex] : "Thread " + std::to_string(threadIndex);
+}
+
+/// @return Upper bound of a histogram bucket, in microseconds.
+uint64 NOUS_Multithreading::NOUS_JobProfiler::GetHistogramBucketLimitUS(uint32 bucket)
+{
+	return (bucket + 1 < c_JOB_HISTOGRAM_BUCKETS) ? (1ULL << bucket) : UINT64_MAX;
+}
+
+/// @brief Gives the calling thread an index and a name in mThreadNames, if it has none yet.
+/// @note mMutex must be held.
+void NOUS_Multithreading::NOUS_JobProfiler::RegisterThreadIndex(ThreadState& state, const std::string& name)
+{
+	if (state.registered) return;
+
+	state.threadIndex = static_cast<uint16>(mThreadNames.size());
+	state.registered = true;
+
+	mThreadNames.push_back(name.empty() ? "Thread " + std::to_string(state.threadIndex) : name);
+}
+
+/// @return Ring buffer of the calling thread, nullptr if it couldn't be reserved.
+NOUS_Multithreading::NOUS_JobProfiler::ThreadBuffer* NOUS_Multithreading::NOUS_JobProfiler::GetThreadBuffer()
+{
+	ThreadState& state = tThreadState;
+
+	if (state.buffer || state.bufferFailed) return state.buffer;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	RegisterThreadIndex(state, std::string());
+
+	state.buffer = AcquireBuffer();
+	state.bufferFailed = (state.buffer == nullptr);
+
+	return state.buffer;
+}
+
+/// @note mMutex must be held.
+NOUS_Multithreading::NOUS_JobProfiler::ThreadBuffer* NOUS_Multithreading::NOUS_JobProfiler::AcquireBuffer()
+{
+	// Buffers of exited threads keep their events until the new owner overwrites them
+	for (ThreadBuffer* buffer : mBuffers)
+	{
+		if (!buffer->inUse.exchange(true, std::memory_order_acquire)) return buffer;
+	}
+
+	const uint64 bufferSize = VirtualMemory::AlignToPage(c_EVENTS_PER_THREAD * sizeof(Slot));
+
+	Slot* slots = static_cast<Slot*>(VirtualMemory::Reserve(bufferSize));
+
+	// Pages are only backed once events are written to them
+	if (!slots || !VirtualMemory::Commit(slots, bufferSize))
+	{
+		NOUS_ERROR("NOUS_JobProfiler - Failed to reserve %llu bytes for a thread's events", bufferSize);
+
+		if (slots) VirtualMemory::Release(slots, bufferSize);
+
+		return nullptr;
+	}
+
+	ThreadBuffer* buffer = new ThreadBuffer();
+	buffer->slots = slots;
+	buffer->inUse.store(true, std::memory_order_relaxed);
+
+	mBuffers.push_back(buffer);
+
+	return buffer;
+}
+
+/// @return Overwritten events of the current recording.
+uint64 NOUS_Multithreading::NOUS_JobProfiler::ReadEvents(std::vector<NOUS_JobEvent>& outEvents) const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	const uint32 recordingID = mRecordingID.load(std::memory_order_relaxed);
+
+	if (recordingID == 0) return 0;
+
+	const uint64 startTime = mStartTime.load(std::memory_order_relaxed);
+
+	uint64 overwrittenEvents = 0;
+
+	std::vector<Slot> slots;
+	slots.reserve(c_EVENTS_PER_THREAD);
+
+	for (const ThreadBuffer* buffer : mBuffers)
+	{
+		// Acquire: the buffer's recording id and every slot written before this index are visible
+		const uint64 writeIndex = buffer->writeIndex.load(std::memory_order_acquire);
+
+		if (buffer->recording.load(std::memory_order_relaxed) != recordingID) continue;
+
+		const uint64 recordingFirstIndex = buffer->recordingFirstIndex.load(std::memory_order_relaxed);
+		const uint64 firstIndex = std::max(recordingFirstIndex, (writeIndex > c_EVENTS_PER_THREAD) ? writeIndex - c_EVENTS_PER_THREAD : 0);
+
+		slots.clear();
+
+		for (uint64 i = firstIndex; i < writeIndex; ++i)
+		{
+			Slot& slot = buffer->slots[i % c_EVENTS_PER_THREAD];
+
+			slots.push_back({
+				std::atomic_ref<uint64>(slot.name).load(std::memory_order_relaxed),
+				std::atomic_ref<uint64>(slot.enqueueTime).load(std::memory_order_relaxed),
+				std::atomic_ref<uint64>(slot.startTime).load(std::memory_order_relaxed),
+				std::atomic_ref<uint64>(slot.endTime).load(std::memory_order_relaxed),
+				std::atomic_ref<uint64>(slot.info).load(std::memory_order_relaxed)
+				});
+		}
+
+		// The owner kept writing meanwhile: every slot it may have started overwriting is dropped
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		const uint64 currentIndex = buffer->writeIndex.load(std::memory_order_relaxed);
+		const uint64 validIndex = (currentIndex >= c_EVENTS_PER_THREAD) ? currentIndex - c_EVENTS_PER_THREAD + 1 : 0;
+		const uint64 keptIndex = std::max(firstIndex, validIndex);
+
+		overwrittenEvents += (keptIndex > recordingFirstIndex) ? std::min(keptIndex, writeIndex) - recordingFirstIndex : 0;
+
+		for (uint64 i = keptIndex; i < writeIndex; ++i)
+		{
+			const Slot& slot = slots[i - firstIndex];
+
+			// Jobs that were already running when the recording started are left out
+			if (((slot.info >> c_INFO_RECORDING_SHIFT) & 0xFFFF) != recordingID || slot.startTime < startTime) continue;
+
+			NOUS_JobEvent event = {};
+			event.name = reinterpret_cast<const char*>(slot.name);
+			event.enqueueTime = slot.enqueueTime;
+			event.startTime = slot.startTime;
+			event.endTime = slot.endTime;
+			event.threadIndex = static_cast<uint16>(slot.info & 0xFFFF);
+			event.priority = static_cast<NOUS_JobPriority>((slot.info >> c_INFO_PRIORITY_SHIFT) & 0xFF);
+			event.stolen = (slot.info & c_INFO_STOLEN) != 0;
+			event.nested = (slot.info & c_INFO_NESTED) != 0;
+			event.mainThreadTask = (slot.info & c_INFO_MAIN_THREAD_TASK) != 0;
+
+			outEvents.push_back(event);
+		}
+	}
+
+	return overwrittenEvents;
+}
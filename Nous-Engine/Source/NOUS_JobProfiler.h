@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "NOUS_Job.h"
+
+namespace NOUS_Multithreading
+{
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Duration histogram buckets: bucket 0 holds jobs under 1 us, bucket b jobs in [2^(b-1), 2^b) us,
+	/// the last one everything above.
+	///////////////////////////////////////////////////////////////////////////
+	const uint32 c_JOB_HISTOGRAM_BUCKETS = 20;
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief One executed job. Times are nanoseconds from NOUS_JobProfiler::GetTime().
+	///////////////////////////////////////////////////////////////////////////
+	struct NOUS_JobEvent
+	{
+		const char*			name;
+		uint64				enqueueTime;		// Queued with its dependencies resolved, startTime if it never waited in a queue
+		uint64				startTime;
+		uint64				endTime;
+		uint16				threadIndex;		// See NOUS_JobProfiler::GetThreadName()
+		NOUS_JobPriority	priority;
+		bool				stolen;				// Taken from another worker's deque
+		bool				nested;				// Ran inside another job, while its thread waited on a handle
+		bool				mainThreadTask;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Jobs sharing a name, added up over the recording.
+	///////////////////////////////////////////////////////////////////////////
+	struct NOUS_JobNameStats
+	{
+		std::string		name;
+		uint64			count;
+		uint64			totalTime;
+		uint64			minTime;
+		uint64			maxTime;
+		uint64			totalWaitTime;
+		uint64			maxWaitTime;
+		uint64			histogram[c_JOB_HISTOGRAM_BUCKETS];
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Jobs run by one thread, added up over the recording.
+	///////////////////////////////////////////////////////////////////////////
+	struct NOUS_JobThreadStats
+	{
+		uint16			threadIndex;
+		std::string		name;
+		uint64			executedJobs;
+		uint64			stolenJobs;
+		uint64			busyTime;			// Outermost jobs only, nested ones run inside that time
+		uint64			totalWaitTime;
+		float			utilization;		// busyTime over the recorded time span
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Aggregated view of the current recording, see NOUS_JobProfiler::BuildProfile().
+	///////////////////////////////////////////////////////////////////////////
+	struct NOUS_JobProfile
+	{
+		uint64								startTime;
+		uint64								endTime;		// Now while still recording
+		uint64								eventCount;
+		uint64								overwrittenEvents;
+
+		std::vector<NOUS_JobNameStats>		jobs;			// Most total time first
+		std::vector<NOUS_JobThreadStats>	threads;		// By thread index, the main thread registers first
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Records every executed job (queue wait, start, end, thread and name) while a recording is on.
+	/// Each thread writes its own ring buffer without locking, readers copy the buffers and discard any
+	/// event overwritten while they were reading. A full buffer keeps the newest c_EVENTS_PER_THREAD events.
+	/// The recording can be aggregated per job name and per thread, or exported as a Chrome trace that
+	/// chrome://tracing and Perfetto open, so scheduling stalls can be looked at without a Tracy build.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_JobProfiler
+	{
+	public:
+
+		static constexpr uint64 c_EVENTS_PER_THREAD = 64 * 1024;
+
+		/// @return Profiler shared by every job system.
+		static NOUS_JobProfiler& Get();
+
+		/// @brief Starts a new recording, discarding the previous one.
+		void Start();
+		void Stop();
+
+		bool IsRecording() const;
+
+		/// @return Nanoseconds since the profiler was created.
+		static uint64 GetTime();
+
+		/// @brief Names the calling thread in the recordings, threads not registered are named after their index.
+		void RegisterThread(const std::string& name);
+
+		/// @brief Called by the queues when a job becomes ready to run, its queue wait starts here.
+		void MarkEnqueued(NOUS_Job* job) const;
+
+		/// @brief Called right before a job is executed, on the thread executing it.
+		/// @return Start time to pass to EndJob(), 0 if not recording.
+		uint64 BeginJob();
+
+		/// @brief Called once the job has executed, before it's deleted.
+		/// @param stolen: The job was taken from another worker's deque.
+		void EndJob(const NOUS_Job* job, uint64 startTime, bool stolen);
+
+		/// @brief Copies the events of the current recording, sorted by start time.
+		void GetEvents(std::vector<NOUS_JobEvent>& outEvents) const;
+
+		/// @return Per job name and per thread statistics of the current recording.
+		NOUS_JobProfile BuildProfile() const;
+
+		/// @brief Writes the current recording in the Chrome trace event format (JSON).
+		bool ExportChromeTrace(const char* path) const;
+
+		/// @return Name the thread registered with.
+		std::string GetThreadName(uint16 threadIndex) const;
+
+		/// @return Upper bound of a histogram bucket, in microseconds.
+		static uint64 GetHistogramBucketLimitUS(uint32 bucket);
+
+		/// @brief NOUS_JobProfiler delete copy operators.
+		NOUS_JobProfiler(const NOUS_JobProfiler&) = delete;
+		NOUS_JobProfiler& operator=(const NOUS_JobProfiler&) = delete;
+
+	private:
+
+		/// @brief NOUS_JobProfiler constructor and destructor.
+		NOUS_JobProfiler();
+		~NOUS_JobProfiler();
+
+		// Event as stored in the ring buffers, every word accessed atomically so readers can copy it while it's overwritten
+		struct Slot
+		{
+			uint64		name;
+			uint64		enqueueTime;
+			uint64		startTime;
+			uint64		endTime;
+			uint64		info;			// Thread index, recording, priority and flags packed
+		};
+
+		struct ThreadBuffer
+		{
+			Slot*					slots = nullptr;
+			std::atomic<uint64>		writeIndex = 0;			// Events ever written, only the owner thread advances it
+
+			// Where the current recording started in this buffer, tells how many of its events were overwritten
+			std::atomic<uint32>		recording = 0;
+			std::atomic<uint64>		recordingFirstIndex = 0;
+
+			std::atomic<bool>		inUse = false;			// Returned when its thread exits, the next new thread reuses it
+		};
+
+		struct ThreadState
+		{
+			ThreadBuffer*	buffer = nullptr;
+			bool			bufferFailed = false;
+			bool			registered = false;
+			uint16			threadIndex = 0;
+			uint32			depth = 0;				// Jobs the thread is inside of, nested jobs run within the outer one's time
+
+			/// @brief Gives the buffer back when the thread exits.
+			~ThreadState();
+		};
+
+		static thread_local ThreadState tThreadState;
+
+		/// @brief Gives the calling thread an index and a name in mThreadNames, if it has none yet.
+		void RegisterThreadIndex(ThreadState& state, const std::string& name);
+
+		/// @return Ring buffer of the calling thread, nullptr if it couldn't be reserved.
+		ThreadBuffer* GetThreadBuffer();
+
+		ThreadBuffer* AcquireBuffer();
+
+		/// @return Overwritten events of the current recording.
+		uint64 ReadEvents(std::vector<NOUS_JobEvent>& outEvents) const;
+
+	private:
+
+		std::atomic<bool>			mRecording;
+		std::atomic<uint32>			mRecordingID;			// Tags the events, changes with every Start()
+		std::atomic<uint64>			mStartTime;
+		std::atomic<uint64>			mStopTime;
+
+		// Plain std containers, threads keep recording until the process exits, after the memory manager shut down
+		mutable std::mutex			mMutex;
+		std::vector<ThreadBuffer*>	mBuffers;
+		std::vector<std::string>	mThreadNames;
+
+	};
+}
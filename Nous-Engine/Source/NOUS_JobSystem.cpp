@@ -1,16 +1,25 @@
 #include "NOUS_JobSystem.h"
 
 #include "NOUS_Job.h"
+#include "NOUS_Task.h"
 
 #include "MemoryManager.h"
 
 /// @brief NOUS_JobSystem constructor.
 /// @param size: Number of worker threads available inside the thread pool.
+/// @param pinWorkers: Pins every worker to a logical core, following the CPU topology.
 /// @note If size is not specified, c_MAX_HARDWARE_THREADS is used.
-NOUS_Multithreading::NOUS_JobSystem::NOUS_JobSystem(const uint8 size)
+NOUS_Multithreading::NOUS_JobSystem::NOUS_JobSystem(const uint32 size, bool pinWorkers) :
+	mJobPool(256, MemoryManager::MemoryTag::JOB), mStatePool(256, MemoryManager::MemoryTag::JOB), mMainThreadQueue(&mJobPool), 
+	mMainThreadID(std::this_thread::get_id()), mPinWorkers(pinWorkers), mSleepingWaiters(0), mWaitEpoch(0)
 {
+	const NOUS_CpuTopology& topology = NOUS_CpuTopology::Get();
+
+	NOUS_INFO("CPU Topology: %u logical cores, %u physical cores, %u L3 domains, %u NUMA nodes", topology.GetLogicalCoreCount(), 
+		topology.GetPhysicalCoreCount(), topology.GetCacheDomainCount(), topology.GetNumaNodeCount());
+
 	mPendingJobs = 0;
-	mThreadPool = NOUS_NEW<NOUS_ThreadPool>(MemoryManager::MemoryTag::THREAD, size);
+	mThreadPool = NOUS_NEW<NOUS_ThreadPool>(MemoryManager::MemoryTag::THREAD, size, &mJobPool, mPinWorkers);
 }
 
 /// @brief NOUS_JobSystem destructor.
@@ -19,61 +28,400 @@ NOUS_Multithreading::NOUS_JobSystem::~NOUS_JobSystem()
 {
 	WaitForPendingJobs();
 
+	// Their predicates may never hold, the coroutines are left suspended
+	if (!mMainThreadPolls.empty())
+	{
+		NOUS_WARN("Job system destroyed with %llu tasks still waiting on WaitUntil()", static_cast<unsigned long long>(mMainThreadPolls.size()));
+	}
+
 	NOUS_DELETE<NOUS_ThreadPool>(mThreadPool, MemoryManager::MemoryTag::THREAD);
 }
 
-/// @brief Submits a job to the thread pool, to be executed by a free worker thread.
-/// @note Job executes immediately if thread pool size is 0 (running on Main Thread).
-/// @param userJob: The function to execute.
-/// @param jobName: Optional name identifier.
-void NOUS_Multithreading::NOUS_JobSystem::SubmitJob(std::function<void()> userJob, const std::string& jobName)
+/// @brief Owns a submitted task until it returns, then completes its handle. See SubmitTask().
+NOUS_Multithreading::NOUS_Task<void> NOUS_Multithreading::NOUS_JobSystem::RunTask(NOUS_JobState* state, NOUS_Task<void> task)
 {
-	mPendingJobs++;
+	try
+	{
+		co_await task;
+	}
+	catch (const std::exception& e)
+	{
+		NOUS_ERROR("Task failed: %s", e.what());
+	}
+	catch (...)
+	{
+		NOUS_ERROR("Task failed: unknown exception"); // The handle still completes, waiters can't hang
+	}
+
+	FinishJob(state);
+}
 
-	std::function<void()> wrappedJob = [this, userJob]() {
+/// @brief Registers the job as a continuation of its dependencies, queues it if none is pending.
+void NOUS_Multithreading::NOUS_JobSystem::ScheduleJob(NOUS_Job* job, const NOUS_JobHandle* dependsOn, uint32 dependencyCount)
+{
+	// Held while the continuations are registered, a dependency finishing meanwhile can't dispatch the job early
+	job->AddDependency();
+
+	for (uint32 i = 0; i < dependencyCount; ++i)
+	{
+		NOUS_JobState* dependency = dependsOn[i].GetState();
 
-		userJob();
+		if (!dependency) continue;
 
-		if (mPendingJobs-- == 1)
+		job->AddDependency();
+
+		if (!dependency->AddContinuation(job))
 		{
-			mWaitCondition.notify_all();
+			job->ResolveDependency(); // Already complete
 		}
+	}
+
+	if (job->ResolveDependency())
+	{
+		DispatchJob(job);
+	}
+}
+
+/// @brief Starts a coroutine task on a worker, see NOUS_Task.h.
+/// @param priority: Priority of every job the task runs on, including its resumes.
+/// @return Handle completed once the task returns, wait on it or use it as a dependency.
+NOUS_Multithreading::NOUS_JobHandle NOUS_Multithreading::NOUS_JobSystem::SubmitTask(NOUS_Task<void>&& task, NOUS_JobName taskName, 
+	NOUS_JobPriority priority)
+{
+	mPendingJobs++;
+
+	// Completed by RunTask(), the job below only starts the coroutine
+	NOUS_JobState* state = mStatePool.New(&mStatePool);
+	NOUS_JobHandle handle(state);
+
+	NOUS_Task<void> runner = RunTask(state, std::move(task));
+	runner.SetPriority(priority);
+
+	std::coroutine_handle<> coroutine = runner.Detach();
+
+	SubmitJob([coroutine]() { coroutine.resume(); }, taskName, priority);
+
+	return handle;
+}
+
+/// @brief Main thread only. Runs the tasks queued with SubmitMainThreadTask() so far, then resumes the
+/// parked polls that are ready.
+/// @note Called at fixed points of the frame, see Application::Update().
+/// @return Number of tasks executed and polls resumed.
+uint32 NOUS_Multithreading::NOUS_JobSystem::ExecuteMainThreadTasks()
+{
+	NOUS_ASSERT_MSG(IsMainThread(), "Main thread tasks executed outside of the main thread");
 
-		};
+	const uint32 executedTasks = mMainThreadQueue.Execute();
 
-	NOUS_Job* job = NOUS_NEW<NOUS_Job>(MemoryManager::MemoryTag::THREAD, jobName, wrappedJob);
+	return executedTasks + ExecuteMainThreadPolls();
+}
 
-	if (mThreadPool->GetThreads().empty()) // Running on Main Thread (sequentially)
+/// @brief Any thread. Parks a poll until ExecuteMainThreadTasks() finds it ready, it's checked once per call.
+/// @note The task waiting on it doesn't count as pending meanwhile, WaitForPendingJobs() returns without it.
+void NOUS_Multithreading::NOUS_JobSystem::AddMainThreadPoll(const MainThreadPoll& poll)
+{
 	{
-		job->Execute();
-		NOUS_DELETE<NOUS_Job>(job, MemoryManager::MemoryTag::THREAD);
+		std::lock_guard<std::mutex> lock(mPollMutex);
+		mMainThreadPolls.push_back(poll);
 	}
-	else
+
+	// Counted again by ExecuteMainThreadPolls() before it resumes the task
+	ReleasePendingJob();
+}
+
+/// @return true if called from the thread that created the job system.
+bool NOUS_Multithreading::NOUS_JobSystem::IsMainThread() const
+{
+	return std::this_thread::get_id() == mMainThreadID;
+}
+
+/// @brief Blocks until the job completes, running other queued jobs in the meantime.
+/// Once there's nothing left to run, the thread sleeps until a job completes or more work is queued.
+/// @note Safe to call from inside a job, the worker keeps working instead of blocking.
+/// @note On the main thread, main thread tasks are run too.
+void NOUS_Multithreading::NOUS_JobSystem::Wait(const NOUS_JobHandle& handle)
+{
+	const bool mainThread = IsMainThread();
+	uint32 idleRounds = 0;
+
+	std::chrono::steady_clock::time_point lastPollCheck = std::chrono::steady_clock::now();
+
+	while (!handle.IsComplete())
 	{
-		mThreadPool->SubmitJob(job);
+		if (ExecutePendingWork(mainThread))
+		{
+			idleRounds = 0;
+			continue;
+		}
+
+		// The job is running somewhere else or waiting on its dependencies, usually not for long
+		if (++idleRounds < c_WAIT_YIELD_ROUNDS)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mWaitMutex);
+
+		const uint64 epoch = mWaitEpoch;
+		mSleepingWaiters.fetch_add(1, std::memory_order_seq_cst);
+
+		lock.unlock();
+
+		// Pairs with NotifyWaiters(): either this last look finds the work, or its notifier sees this thread
+		if (!handle.IsComplete() && !ExecutePendingWork(mainThread))
+		{
+			lock.lock();
+
+			mWaitCondition.wait_for(lock, c_WAIT_SLEEP_TIMEOUT, [this, &handle, epoch]() {
+				return mWaitEpoch != epoch || handle.IsComplete();
+				});
+
+			lock.unlock();
+		}
+		else
+		{
+			idleRounds = 0;
+		}
+
+		mSleepingWaiters.fetch_sub(1, std::memory_order_relaxed);
+
+		// The job may be a task parked on a poll, those are checked here once per sleep timeout at most
+		if (mainThread && std::chrono::steady_clock::now() - lastPollCheck >= c_WAIT_SLEEP_TIMEOUT)
+		{
+			lastPollCheck = std::chrono::steady_clock::now();
+
+			if (ExecuteMainThreadPolls() > 0) idleRounds = 0;
+		}
 	}
 }
 
 /// @brief Blocks until all submitted jobs complete.
+/// @note On the main thread, main thread tasks are run while waiting.
 void NOUS_Multithreading::NOUS_JobSystem::WaitForPendingJobs()
 {
+	const bool mainThread = IsMainThread();
+
 	std::unique_lock<std::mutex> lock(mWaitMutex);
-	mWaitCondition.wait(lock, [this]() { return mPendingJobs == 0; });
+
+	while (mPendingJobs != 0)
+	{
+		// Workers may be waiting on a main thread task, run them instead of sleeping on each other
+		if (mainThread && mMainThreadQueue.GetPendingJobCount() > 0)
+		{
+			lock.unlock();
+			mMainThreadQueue.Execute();
+			lock.lock();
+
+			continue;
+		}
+
+		mWaitCondition.wait(lock, [this, mainThread]() {
+			return mPendingJobs == 0 || (mainThread && mMainThreadQueue.GetPendingJobCount() > 0);
+			});
+	}
 }
 
 /// @brief Resizes the thread pool to the specified number of threads.
 /// @param newSize: The new number of worker threads in the pool.
 /// @note If the size passed is 0, the program becomes single-threaded.
 /// @note Ensures all current jobs finish before resizing.
-void NOUS_Multithreading::NOUS_JobSystem::Resize(uint8 newSize)
+void NOUS_Multithreading::NOUS_JobSystem::Resize(uint32 newSize)
 {
 	WaitForPendingJobs();
 
 	NOUS_DELETE<NOUS_ThreadPool>(mThreadPool, MemoryManager::MemoryTag::THREAD);
-	mThreadPool = NOUS_NEW<NOUS_ThreadPool>(MemoryManager::MemoryTag::THREAD, newSize);
+	mThreadPool = NOUS_NEW<NOUS_ThreadPool>(MemoryManager::MemoryTag::THREAD, newSize, &mJobPool, mPinWorkers);
+}
+
+/// @brief Recreates the thread pool with its workers pinned to logical cores, or floating.
+/// @note Ensures all current jobs finish before recreating it.
+void NOUS_Multithreading::NOUS_JobSystem::SetWorkerPinning(bool pinWorkers)
+{
+	if (pinWorkers == mPinWorkers) return;
+
+	mPinWorkers = pinWorkers;
+
+	Resize(static_cast<uint32>(mThreadPool->GetThreads().size()));
+}
+
+/// @brief Queues a job whose dependencies are all resolved.
+void NOUS_Multithreading::NOUS_JobSystem::DispatchJob(NOUS_Job* job)
+{
+	if (job->IsMainThreadOnly())
+	{
+		mMainThreadQueue.Push(job);
+
+		// The main thread may be blocked in WaitForPendingJobs() or Wait()
+		{
+			std::lock_guard<std::mutex> lock(mWaitMutex);
+			mWaitEpoch++;
+		}
+		mWaitCondition.notify_all();
+	}
+	else if (mThreadPool->GetThreads().empty()) // Running on Main Thread (sequentially)
+	{
+		NOUS_JobProfiler& profiler = NOUS_JobProfiler::Get();
+		const uint64 startTime = profiler.BeginJob();
+
+		try
+		{
+			job->Execute();
+		}
+		catch (...)
+		{
+			profiler.EndJob(job, startTime, false); // The exception goes on to the submitter
+			mJobPool.Delete(job);
+			throw;
+		}
+
+		profiler.EndJob(job, startTime, false);
+		mJobPool.Delete(job);
+	}
+	else
+	{
+		mThreadPool->SubmitJob(job);
+
+		// A worker sleeping in Wait() isn't parked, the pool won't wake it up for the job
+		NotifyWaiters();
+	}
+}
+
+/// @brief Called by every job once its function returns.
+void NOUS_Multithreading::NOUS_JobSystem::FinishJob(NOUS_JobState* state)
+{
+	CompleteJob(state);
+	ReleasePendingJob();
+}
+
+/// @brief Drops a job from the pending count, wakes WaitForPendingJobs() on the last one.
+void NOUS_Multithreading::NOUS_JobSystem::ReleasePendingJob()
+{
+	if (mPendingJobs-- == 1)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mWaitMutex);
+			mWaitEpoch++;
+		}
+		mWaitCondition.notify_all();
+	}
+	else
+	{
+		NotifyWaiters();
+	}
+}
+
+/// @brief Marks the job state as complete and dispatches the continuations it released.
+void NOUS_Multithreading::NOUS_JobSystem::CompleteJob(NOUS_JobState* state)
+{
+	nous::vector<NOUS_Job*, MemoryManager::MemoryTag::JOB> continuations;
+
+	state->Complete(continuations);
+
+	for (NOUS_Job* continuation : continuations)
+	{
+		if (continuation->ResolveDependency())
+		{
+			DispatchJob(continuation);
+		}
+	}
+
+	state->Release();
+}
+
+/// @brief Main thread only. Resumes the parked polls that are ready, the others stay parked.
+/// @return Number of polls resumed.
+uint32 NOUS_Multithreading::NOUS_JobSystem::ExecuteMainThreadPolls()
+{
+	// Taken out of the list, polls parked by the tasks resumed below wait for the next call
+	nous::vector<MainThreadPoll, MemoryManager::MemoryTag::JOB> polls;
+
+	{
+		std::lock_guard<std::mutex> lock(mPollMutex);
+
+		if (mMainThreadPolls.empty()) return 0;
+
+		polls.swap(mMainThreadPolls);
+	}
+
+	uint32 resumedPolls = 0;
+	uint64 parkedPolls = 0;
+
+	for (uint64 i = 0; i < polls.size(); ++i)
+	{
+		const MainThreadPoll poll = polls[i];
+
+		if (poll.isReady(poll.awaiter))
+		{
+			mPendingJobs++;
+			poll.resume(poll.awaiter);
+
+			resumedPolls++;
+		}
+		else
+		{
+			polls[parkedPolls++] = poll;
+		}
+	}
+
+	if (parkedPolls > 0)
+	{
+		std::lock_guard<std::mutex> lock(mPollMutex);
+		mMainThreadPolls.insert(mMainThreadPolls.end(), polls.begin(), polls.begin() + parkedPolls);
+	}
+
+	return resumedPolls;
+}
+
+/// @brief Runs a main thread task (main thread only) or a queued job on the calling thread.
+/// @return false if there was nothing to run.
+bool NOUS_Multithreading::NOUS_JobSystem::ExecutePendingWork(bool mainThread)
+{
+	if (mainThread && mMainThreadQueue.Execute() > 0) return true;
+
+	return mThreadPool->ExecutePendingJob();
+}
+
+/// @brief Wakes the threads sleeping in Wait(), a job completed or more work was queued.
+void NOUS_Multithreading::NOUS_JobSystem::NotifyWaiters()
+{
+	// Callers published the completion or the job with a seq_cst operation first. A wakeup missed anyway only
+	// costs the waiter c_WAIT_SLEEP_TIMEOUT
+	if (mSleepingWaiters.load(std::memory_order_seq_cst) == 0) return;
+
+	{
+		std::lock_guard<std::mutex> lock(mWaitMutex);
+		mWaitEpoch++;
+	}
+	mWaitCondition.notify_all();
+}
+
+/// @return grainSize, or a grain giving each worker a few ranges to balance with if it's 0.
+uint64 NOUS_Multithreading::NOUS_JobSystem::GetGrainSize(uint64 rangeSize, uint64 grainSize) const
+{
+	if (grainSize > 0) return grainSize;
+
+	const uint64 rangeCount = (mThreadPool->GetThreads().size() + 1) * c_PARALLEL_RANGES_PER_THREAD;
+	const uint64 autoGrainSize = rangeSize / rangeCount;
+
+	return (autoGrainSize > 0) ? autoGrainSize : 1;
+}
+
+/// @return Priority of the job running on the calling thread, CRITICAL outside of a job.
+NOUS_Multithreading::NOUS_JobPriority NOUS_Multithreading::NOUS_JobSystem::GetSplitPriority()
+{
+	const NOUS_Job* currentJob = NOUS_ThreadPool::GetCurrentJob();
+
+	return currentJob ? currentJob->GetPriority() : NOUS_JobPriority::CRITICAL;
 }
 
 /// @return Reference to the underlying thread pool.
+NOUS_Multithreading::NOUS_ThreadPool& NOUS_Multithreading::NOUS_JobSystem::GetThreadPool()
+{
+	return *mThreadPool;
+}
+
 const NOUS_Multithreading::NOUS_ThreadPool& NOUS_Multithreading::NOUS_JobSystem::GetThreadPool() const 
 { 
 	return *mThreadPool; 
@@ -84,3 +432,17 @@ int NOUS_Multithreading::NOUS_JobSystem::GetPendingJobs() const
 { 
 	return mPendingJobs; 
 }
+
+/// @return Number of tasks waiting for the main thread.
+uint64 NOUS_Multithreading::NOUS_JobSystem::GetPendingMainThreadTasks() const
+{
+	return mMainThreadQueue.GetPendingJobCount();
+}
+
+/// @return Number of polls parked until their predicate holds.
+uint64 NOUS_Multithreading::NOUS_JobSystem::GetParkedMainThreadPolls() const
+{
+	std::lock_guard<std::mutex> lock(mPollMutex);
+
+	return mMainThreadPolls.size();
+}
@@ -2,21 +2,38 @@
 
 #include "Globals.h"
 
-#include <functional>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <initializer_list>
+#include <thread>
 
+#include "NOUS_Job.h"
 #include "NOUS_ThreadPool.h"
+#include "NOUS_MainThreadQueue.h"
+#include "NOUS_CpuTopology.h"
+#include "PoolAllocator.h"
 
 namespace NOUS_Multithreading
 {
 	///////////////////////////////////////////////////////////////////////////
-	/// @brief Maximum hardware threads available, minus one reserved for the main thread.
+	/// @brief Logical cores the process can run on, minus one reserved for the main thread.
 	///////////////////////////////////////////////////////////////////////////
-	const uint8 c_MAX_HARDWARE_THREADS = []()
+	const uint32 c_MAX_HARDWARE_THREADS = []()
 		{
-			const unsigned int hardwareThreads = std::thread::hardware_concurrency();
-			return (hardwareThreads == 0) ? 0 : (hardwareThreads - 1);
+			const uint32 logicalCores = NOUS_CpuTopology::Get().GetLogicalCoreCount();
+			return (logicalCores == 0) ? 0 : (logicalCores - 1);
 		}();
 
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Ranges per thread ParallelFor() aims for when no grain size is given, spare ones let
+	/// faster workers steal from slower ones.
+	///////////////////////////////////////////////////////////////////////////
+	const uint64 c_PARALLEL_RANGES_PER_THREAD = 4;
+
+	template<typename T>
+	class NOUS_Task;
+
 	///////////////////////////////////////////////////////////////////////////
 	/// @brief High-level interface for job submission and management.
 	///////////////////////////////////////////////////////////////////////////
@@ -24,10 +41,24 @@ namespace NOUS_Multithreading
 	{
 	public:
 
+		///////////////////////////////////////////////////////////////////////////
+		/// @brief Suspended coroutine waiting on a predicate nothing signals, see WaitUntil() in NOUS_Task.h.
+		///////////////////////////////////////////////////////////////////////////
+		struct MainThreadPoll
+		{
+			typedef bool (*PFN_IsReady)(void* awaiter);
+			typedef void (*PFN_Resume)(void* awaiter);
+
+			PFN_IsReady		isReady;
+			PFN_Resume		resume;
+			void*			awaiter;
+		};
+
 		/// @brief NOUS_JobSystem constructor.
 		/// @param size: Number of worker threads available inside the thread pool.
+		/// @param pinWorkers: Pins every worker to a logical core, following the CPU topology.
 		/// @note If size is not specified, c_MAX_HARDWARE_THREADS is used.
-		NOUS_JobSystem(const uint8 size = c_MAX_HARDWARE_THREADS);
+		NOUS_JobSystem(const uint32 size = c_MAX_HARDWARE_THREADS, bool pinWorkers = false);
 
 		/// @brief NOUS_JobSystem destructor.
 		/// @note Wait until all threads have finished their work and then delete the thread pool.
@@ -35,32 +66,384 @@ namespace NOUS_Multithreading
 
 		/// @brief Submits a job to the thread pool, to be executed by a free worker thread.
 		/// @note Job executes immediately if thread pool size is 0 (running on Main Thread).
-		/// @param userJob: The function to execute.
-		/// @param jobName: Optional name identifier.
-		void SubmitJob(std::function<void()> userJob, const std::string& jobName = "Unnamed");
+		/// @param userJob: The function to execute, stored inline in the job if its captures are small.
+		/// @param jobName: Optional name identifier, string literals are stored without copying.
+		/// @param priority: Queue the job goes to, BACKGROUND for asset loads and other long work.
+		/// @param dependsOn: Jobs that must complete first, the job is queued once the last one finishes.
+		/// @return Handle to wait on the job or to make other jobs depend on it.
+		template<typename Function>
+		NOUS_JobHandle SubmitJob(Function&& userJob, NOUS_JobName jobName = "Unnamed", 
+			NOUS_JobPriority priority = NOUS_JobPriority::NORMAL, std::initializer_list<NOUS_JobHandle> dependsOn = {});
+
+		/// @brief SubmitJob() overload taking the dependencies as an array.
+		template<typename Function>
+		NOUS_JobHandle SubmitJob(Function&& userJob, NOUS_JobName jobName, NOUS_JobPriority priority, 
+			const NOUS_JobHandle* dependsOn, uint32 dependencyCount);
+
+		/// @brief Queues a task to run on the main thread at the next ExecuteMainThreadTasks() call.
+		/// @param dependsOn: Jobs that must complete first.
+		/// @return Handle completed once the task has run, wait on it or use it as a dependency.
+		template<typename Function>
+		NOUS_JobHandle SubmitMainThreadTask(Function&& task, NOUS_JobName taskName = "Main Thread Task", 
+			std::initializer_list<NOUS_JobHandle> dependsOn = {});
+
+		/// @brief Starts a coroutine task on a worker, see NOUS_Task.h.
+		/// @param priority: Priority of every job the task runs on, including its resumes.
+		/// @return Handle completed once the task returns, wait on it or use it as a dependency.
+		NOUS_JobHandle SubmitTask(NOUS_Task<void>&& task, NOUS_JobName taskName = "Unnamed Task", 
+			NOUS_JobPriority priority = NOUS_JobPriority::NORMAL);
+
+		/// @brief Main thread only. Runs the tasks queued with SubmitMainThreadTask() so far, then resumes the
+		/// parked polls that are ready.
+		/// @note Called at fixed points of the frame, see Application::Update().
+		/// @return Number of tasks executed and polls resumed.
+		uint32 ExecuteMainThreadTasks();
+
+		/// @brief Any thread. Parks a poll until ExecuteMainThreadTasks() finds it ready, it's checked once per call.
+		/// @note The task waiting on it doesn't count as pending meanwhile, WaitForPendingJobs() returns without it.
+		void AddMainThreadPoll(const MainThreadPoll& poll);
+
+		/// @return true if called from the thread that created the job system.
+		bool IsMainThread() const;
+
+		/// @brief Blocks until the job completes, running other queued jobs in the meantime.
+		/// Once there's nothing left to run, the thread sleeps until a job completes or more work is queued.
+		/// @note Safe to call from inside a job, the worker keeps working instead of blocking.
+		/// @note On the main thread, main thread tasks are run too.
+		void Wait(const NOUS_JobHandle& handle);
 
 		/// @brief Blocks until all submitted jobs complete.
+		/// @note On the main thread, main thread tasks are run while waiting.
 		void WaitForPendingJobs();
 
+		/// @brief Runs fn over [begin, end) split across the workers, returns once the whole range is done.
+		/// Ranges are halved recursively: the calling thread keeps the first half and submits the second,
+		/// idle workers steal the largest halves left and split them further.
+		/// @param grainSize: Largest range run without splitting, 0 picks one from the worker count.
+		/// @param fn: Callable as fn(uint64 first, uint64 last), processing [first, last).
+		/// @note Runs on the calling thread if thread pool size is 0. Safe to call from inside a job.
+		/// @note Splits inherit the priority of the calling job, and are CRITICAL outside of a job.
+		/// @note If fn throws, on this thread or in a split run by a worker, the exception is rethrown here once the
+		/// splits already submitted are done. When several ranges throw, only one exception is rethrown.
+		template<typename Function>
+		void ParallelFor(uint64 begin, uint64 end, uint64 grainSize, const Function& fn);
+
+		/// @brief Maps subranges of [begin, end) in parallel and combines the partial results.
+		/// @param identity: Result of an empty range.
+		/// @param map: Callable as T map(uint64 first, uint64 last).
+		/// @param reduce: Callable as T reduce(const T& left, const T& right), applied in range order.
+		/// @note Exceptions thrown by map or reduce are rethrown here, as in ParallelFor().
+		template<typename T, typename MapFunction, typename ReduceFunction>
+		T ParallelReduce(uint64 begin, uint64 end, uint64 grainSize, const T& identity, 
+			const MapFunction& map, const ReduceFunction& reduce);
+
 		/// @brief Resizes the thread pool to the specified number of threads.
 		/// @param newSize: The new number of worker threads in the pool.
 		/// @note If the size passed is 0, the program becomes single-threaded.
 		/// @note Ensures all current jobs finish before resizing.
-		void Resize(uint8 newSize);
+		void Resize(uint32 newSize);
+
+		/// @brief Recreates the thread pool with its workers pinned to logical cores, or floating.
+		/// @note Ensures all current jobs finish before recreating it.
+		void SetWorkerPinning(bool pinWorkers);
 
 		/// @return Reference to the underlying thread pool.
+		NOUS_ThreadPool& GetThreadPool();
 		const NOUS_ThreadPool& GetThreadPool() const;
 
 		/// @return Number of pending unprocessed jobs.
 		int GetPendingJobs() const;
 
+		/// @return Number of tasks waiting for the main thread.
+		uint64 GetPendingMainThreadTasks() const;
+
+		/// @return Number of polls parked until their predicate holds.
+		uint64 GetParkedMainThreadPolls() const;
+
 	private:
 
+		// Wait(): yields while there's nothing to run, then sleeps. The timeout only bounds a missed wakeup
+		static constexpr uint32 c_WAIT_YIELD_ROUNDS = 16;
+		static constexpr std::chrono::milliseconds c_WAIT_SLEEP_TIMEOUT = std::chrono::milliseconds(1);
+
+		/// @brief Allocates a job that runs userJob and then completes the returned handle.
+		template<typename Function>
+		NOUS_Job* CreateJob(Function&& userJob, NOUS_JobName jobName, NOUS_JobPriority priority, NOUS_JobHandle& outHandle);
+
+		/// @brief Owns a submitted task until it returns, then completes its handle. See SubmitTask().
+		NOUS_Task<void> RunTask(NOUS_JobState* state, NOUS_Task<void> task);
+
+		/// @brief Registers the job as a continuation of its dependencies, queues it if none is pending.
+		void ScheduleJob(NOUS_Job* job, const NOUS_JobHandle* dependsOn, uint32 dependencyCount);
+
+		/// @brief Queues a job whose dependencies are all resolved.
+		void DispatchJob(NOUS_Job* job);
+
+		/// @brief Called by every job once its function returns.
+		void FinishJob(NOUS_JobState* state);
+
+		/// @brief Drops a job from the pending count, wakes WaitForPendingJobs() on the last one.
+		void ReleasePendingJob();
+
+		/// @brief Main thread only. Resumes the parked polls that are ready, the others stay parked.
+		/// @return Number of polls resumed.
+		uint32 ExecuteMainThreadPolls();
+
+		/// @brief Marks the job state as complete and dispatches the continuations it released.
+		void CompleteJob(NOUS_JobState* state);
+
+		/// @brief Runs a main thread task (main thread only) or a queued job on the calling thread.
+		/// @return false if there was nothing to run.
+		bool ExecutePendingWork(bool mainThread);
+
+		/// @brief Wakes the threads sleeping in Wait(), a job completed or more work was queued.
+		void NotifyWaiters();
+
+		/// @return grainSize, or a grain giving each worker a few ranges to balance with if it's 0.
+		uint64 GetGrainSize(uint64 rangeSize, uint64 grainSize) const;
+
+		/// @return Priority of the job running on the calling thread, CRITICAL outside of a job.
+		static NOUS_JobPriority GetSplitPriority();
+
+		template<typename Function>
+		void ParallelForRange(uint64 begin, uint64 end, uint64 grainSize, NOUS_JobPriority priority, const Function& fn);
+
+		// Shared by every split of a ParallelReduce(), keeps the split jobs' captures small enough to stay inline
+		template<typename T, typename MapFunction, typename ReduceFunction>
+		struct ReduceContext
+		{
+			uint64					grainSize;
+			NOUS_JobPriority		priority;
+			const T&				identity;
+			const MapFunction&		map;
+			const ReduceFunction&	reduce;
+		};
+
+		template<typename T, typename MapFunction, typename ReduceFunction>
+		T ParallelReduceRange(uint64 begin, uint64 end, const ReduceContext<T, MapFunction, ReduceFunction>& context);
+
+		NOUS_JobPool				mJobPool;
+		NOUS_JobStatePool			mStatePool;
+		NOUS_MainThreadQueue		mMainThreadQueue;
 		NOUS_ThreadPool*			mThreadPool;
+		std::thread::id				mMainThreadID;
+		bool						mPinWorkers;
 		std::atomic<int>			mPendingJobs;
 
 		std::mutex					mWaitMutex;
 		std::condition_variable		mWaitCondition;
 
+		// Threads sleeping in Wait(), and a counter bumped under mWaitMutex every time they're notified
+		std::atomic<uint32>			mSleepingWaiters;
+		uint64						mWaitEpoch;
+
+		mutable std::mutex										mPollMutex;
+		nous::vector<MainThreadPoll, MemoryManager::MemoryTag::JOB>	mMainThreadPolls;
+
 	};
+
+	template<typename Function>
+	inline NOUS_JobHandle NOUS_JobSystem::SubmitJob(Function&& userJob, NOUS_JobName jobName, 
+		NOUS_JobPriority priority, std::initializer_list<NOUS_JobHandle> dependsOn)
+	{
+		return SubmitJob(std::forward<Function>(userJob), jobName, priority, dependsOn.begin(), static_cast<uint32>(dependsOn.size()));
+	}
+
+	template<typename Function>
+	inline NOUS_JobHandle NOUS_JobSystem::SubmitJob(Function&& userJob, NOUS_JobName jobName, NOUS_JobPriority priority, 
+		const NOUS_JobHandle* dependsOn, uint32 dependencyCount)
+	{
+		NOUS_JobHandle handle;
+		NOUS_Job* job = CreateJob(std::forward<Function>(userJob), jobName, priority, handle);
+
+		ScheduleJob(job, dependsOn, dependencyCount);
+
+		return handle;
+	}
+
+	template<typename Function>
+	inline NOUS_JobHandle NOUS_JobSystem::SubmitMainThreadTask(Function&& task, NOUS_JobName taskName, 
+		std::initializer_list<NOUS_JobHandle> dependsOn)
+	{
+		NOUS_JobHandle handle;
+		NOUS_Job* job = CreateJob(std::forward<Function>(task), taskName, NOUS_JobPriority::CRITICAL, handle);
+
+		job->SetMainThreadOnly(true);
+
+		ScheduleJob(job, dependsOn.begin(), static_cast<uint32>(dependsOn.size()));
+
+		return handle;
+	}
+
+	template<typename Function>
+	inline NOUS_Job* NOUS_JobSystem::CreateJob(Function&& userJob, NOUS_JobName jobName, NOUS_JobPriority priority, NOUS_JobHandle& outHandle)
+	{
+		mPendingJobs++;
+
+		// The job keeps its own reference to the state until it completes
+		NOUS_JobState* state = mStatePool.New(&mStatePool);
+		outHandle = NOUS_JobHandle(state);
+
+		// Captures 16 bytes on top of the user function, all of it stays in the job's inline buffer when small
+		return mJobPool.New(jobName, [this, state, function = std::forward<Function>(userJob)]() mutable {
+
+			try
+			{
+				function();
+			}
+			catch (...)
+			{
+				FinishJob(state); // Waiters can't hang on a job that threw, the worker reports the exception
+				throw;
+			}
+
+			FinishJob(state);
+
+			}, priority);
+	}
+
+	template<typename Function>
+	inline void NOUS_JobSystem::ParallelFor(uint64 begin, uint64 end, uint64 grainSize, const Function& fn)
+	{
+		if (begin >= end) return;
+
+		grainSize = GetGrainSize(end - begin, grainSize);
+
+		if (mThreadPool->GetThreads().empty()) // Running on Main Thread (sequentially)
+		{
+			for (uint64 first = begin; first < end; first += grainSize)
+			{
+				fn(first, (end - first > grainSize) ? first + grainSize : end);
+			}
+
+			return;
+		}
+
+		ParallelForRange(begin, end, grainSize, GetSplitPriority(), fn);
+	}
+
+	template<typename T, typename MapFunction, typename ReduceFunction>
+	inline T NOUS_JobSystem::ParallelReduce(uint64 begin, uint64 end, uint64 grainSize, const T& identity, 
+		const MapFunction& map, const ReduceFunction& reduce)
+	{
+		if (begin >= end) return identity;
+
+		grainSize = GetGrainSize(end - begin, grainSize);
+
+		if (mThreadPool->GetThreads().empty()) // Running on Main Thread (sequentially)
+		{
+			T result = identity;
+
+			for (uint64 first = begin; first < end; first += grainSize)
+			{
+				result = reduce(result, map(first, (end - first > grainSize) ? first + grainSize : end));
+			}
+
+			return result;
+		}
+
+		const ReduceContext<T, MapFunction, ReduceFunction> context = { grainSize, GetSplitPriority(), identity, map, reduce };
+
+		return ParallelReduceRange(begin, end, context);
+	}
+
+	template<typename Function>
+	inline void NOUS_JobSystem::ParallelForRange(uint64 begin, uint64 end, uint64 grainSize, NOUS_JobPriority priority, const Function& fn)
+	{
+		// Each split halves the range, 64 handles cover any uint64 range
+		NOUS_JobHandle splits[64];
+		uint32 splitCount = 0;
+
+		// A worker only logs what escapes a job, so each split hands its exception back through this frame
+		std::exception_ptr splitErrors[64];
+
+		while (end - begin > grainSize)
+		{
+			const uint64 middle = begin + (end - begin) / 2;
+
+			splits[splitCount] = SubmitJob([this, middle, end, grainSize, priority, &fn, &error = splitErrors[splitCount]]() {
+				try
+				{
+					ParallelForRange(middle, end, grainSize, priority, fn);
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+				}, "Parallel For", priority);
+
+			splitCount++;
+			end = middle;
+		}
+
+		const uint32 submittedCount = splitCount;
+
+		try
+		{
+			fn(begin, end);
+		}
+		catch (...)
+		{
+			// The splits still use fn and this frame, they have to finish before the exception unwinds it
+			while (splitCount > 0)
+			{
+				Wait(splits[--splitCount]);
+			}
+
+			throw;
+		}
+
+		// Most recent splits are the smallest and the likeliest to still be in our own deque
+		while (splitCount > 0)
+		{
+			Wait(splits[--splitCount]);
+		}
+
+		for (uint32 i = 0; i < submittedCount; ++i)
+		{
+			if (splitErrors[i]) std::rethrow_exception(splitErrors[i]);
+		}
+	}
+
+	template<typename T, typename MapFunction, typename ReduceFunction>
+	inline T NOUS_JobSystem::ParallelReduceRange(uint64 begin, uint64 end, const ReduceContext<T, MapFunction, ReduceFunction>& context)
+	{
+		if (end - begin <= context.grainSize)
+		{
+			return context.map(begin, end);
+		}
+
+		const uint64 middle = begin + (end - begin) / 2;
+
+		// Written by the split before Wait() returns, both halves live in this frame until then
+		T right = context.identity;
+		std::exception_ptr rightError;
+
+		NOUS_JobHandle split = SubmitJob([this, middle, end, &context, &right, &rightError]() {
+			try
+			{
+				right = ParallelReduceRange(middle, end, context);
+			}
+			catch (...)
+			{
+				rightError = std::current_exception();
+			}
+			}, "Parallel Reduce", context.priority);
+
+		try
+		{
+			T left = ParallelReduceRange(begin, middle, context);
+
+			Wait(split);
+
+			if (rightError) std::rethrow_exception(rightError);
+
+			return context.reduce(left, right);
+		}
+		catch (...)
+		{
+			Wait(split); // Same as ParallelForRange(), the split writes right and reads the context
+			throw;
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "NOUS_MainThreadQueue.h"
+
+#include "NOUS_JobProfiler.h"
+
+#ifdef TRACY_ENABLE
+#include "Tracy.h"
+#endif
+
+/// @brief NOUS_MainThreadQueue constructor.
+/// @param jobPool: Pool the queued jobs were allocated from, executed jobs are returned to it.
+NOUS_Multithreading::NOUS_MainThreadQueue::NOUS_MainThreadQueue(NOUS_JobPool* jobPool) :
+	mHead(nullptr), mPendingJobs(0), mJobPool(jobPool)
+{
+
+}
+
+/// @brief NOUS_MainThreadQueue destructor.
+/// @note Jobs still queued are deleted without running.
+NOUS_Multithreading::NOUS_MainThreadQueue::~NOUS_MainThreadQueue()
+{
+	NOUS_Job* job = mHead.exchange(nullptr, std::memory_order_acquire);
+
+	while (job)
+	{
+		NOUS_Job* next = job->GetNext();
+		mJobPool->Delete(job);
+		job = next;
+	}
+}
+
+/// @brief Any thread. Queues a job for the next Execute().
+void NOUS_Multithreading::NOUS_MainThreadQueue::Push(NOUS_Job* job)
+{
+	// Counted first, Execute() may run the job before this function returns
+	mPendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+	NOUS_JobProfiler::Get().MarkEnqueued(job);
+
+	NOUS_Job* head = mHead.load(std::memory_order_relaxed);
+
+	// The link is written before the CAS publishes the job, the consumer never sees a half-linked node
+	do
+	{
+		job->SetNext(head);
+	}
+	while (!mHead.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+/// @brief Main thread only. Runs every job queued before the call, jobs they queue wait for the next one.
+/// @return Number of jobs executed.
+uint32 NOUS_Multithreading::NOUS_MainThreadQueue::Execute()
+{
+	if (!mHead.load(std::memory_order_relaxed)) return 0;
+
+#ifdef TRACY_ENABLE
+	ZoneScoped;
+#endif
+
+	NOUS_Job* job = mHead.exchange(nullptr, std::memory_order_acquire);
+
+	// Reverse into submission order
+	NOUS_Job* ordered = nullptr;
+
+	while (job)
+	{
+		NOUS_Job* next = job->GetNext();
+		job->SetNext(ordered);
+		ordered = job;
+		job = next;
+	}
+
+	NOUS_JobProfiler& profiler = NOUS_JobProfiler::Get();
+	uint32 executedJobs = 0;
+
+	while (ordered)
+	{
+		NOUS_Job* next = ordered->GetNext();
+		const uint64 startTime = profiler.BeginJob();
+
+		try
+		{
+			ordered->Execute();
+		}
+		catch (const std::exception& e)
+		{
+			NOUS_ERROR("Job '%s' failed: %s", ordered->GetName(), e.what());
+		}
+
+		profiler.EndJob(ordered, startTime, false);
+
+		mJobPool->Delete(ordered);
+		mPendingJobs.fetch_sub(1, std::memory_order_relaxed);
+
+		executedJobs++;
+		ordered = next;
+	}
+
+	return executedJobs;
+}
+
+/// @return Approximate number of jobs waiting for the main thread.
+uint64 NOUS_Multithreading::NOUS_MainThreadQueue::GetPendingJobCount() const
+{
+	return mPendingJobs.load(std::memory_order_relaxed);
+}
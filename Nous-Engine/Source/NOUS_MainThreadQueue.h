@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <atomic>
+
+#include "NOUS_Job.h"
+
+namespace NOUS_Multithreading
+{
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Lock-free multi-producer single-consumer queue of jobs that must run on the main thread.
+	/// Any thread pushes with a single CAS on the head; the main thread takes the whole list at once with
+	/// an exchange and runs it in submission order. Jobs are linked through NOUS_Job::SetNext(), so
+	/// pushing never allocates.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_MainThreadQueue
+	{
+	public:
+
+		/// @brief NOUS_MainThreadQueue constructor.
+		/// @param jobPool: Pool the queued jobs were allocated from, executed jobs are returned to it.
+		NOUS_MainThreadQueue(NOUS_JobPool* jobPool);
+
+		/// @brief NOUS_MainThreadQueue destructor.
+		/// @note Jobs still queued are deleted without running.
+		~NOUS_MainThreadQueue();
+
+		/// @brief Any thread. Queues a job for the next Execute().
+		void Push(NOUS_Job* job);
+
+		/// @brief Main thread only. Runs every job queued before the call, jobs they queue wait for the next one.
+		/// @return Number of jobs executed.
+		uint32 Execute();
+
+		/// @return Approximate number of jobs waiting for the main thread.
+		uint64 GetPendingJobCount() const;
+
+		/// @brief NOUS_MainThreadQueue delete copy operators.
+		NOUS_MainThreadQueue(const NOUS_MainThreadQueue&) = delete;
+		NOUS_MainThreadQueue& operator=(const NOUS_MainThreadQueue&) = delete;
+
+	private:
+
+		std::atomic<NOUS_Job*>		mHead;			// Most recently pushed job, the list runs newest to oldest
+		std::atomic<uint64>			mPendingJobs;
+
+		NOUS_JobPool*				mJobPool;
+
+	};
+}
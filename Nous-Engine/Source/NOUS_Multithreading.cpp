@@ -1,4 +1,5 @@
 #include "NOUS_Multithreading.h"
+#include "NOUS_JobProfiler.h"
 
 #include "MemoryManager.h"
 
@@ -14,6 +15,8 @@ void NOUS_Multithreading::RegisterMainThread()
 		sMainThread->SetThreadID(std::this_thread::get_id());
 		sMainThread->SetThreadState(ThreadState::RUNNING);
 		sMainThread->StartExecutionTimer();
+
+		NOUS_JobProfiler::Get().RegisterThread(sMainThread->GetName());
 	}
 }
 
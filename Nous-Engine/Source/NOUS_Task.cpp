@@ -0,0 +1,56 @@
+#include "NOUS_Task.h"
+
+#include "MemoryManager.h"
+
+/// @brief Coroutine frames are tracked under the JOB tag.
+void* NOUS_Multithreading::NOUS_TaskPromiseBase::operator new(std::size_t size)
+{
+	void* memory = MemoryManager::Allocate(size, MemoryManager::MemoryTag::JOB);
+
+	// No get_return_object_on_allocation_failure(), the coroutine call itself throws
+	if (memory == nullptr)
+	{
+		NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__);
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+void NOUS_Multithreading::NOUS_TaskPromiseBase::operator delete(void* memory, std::size_t size)
+{
+	MemoryManager::Free(memory, size, MemoryManager::MemoryTag::JOB);
+}
+
+void NOUS_Multithreading::NOUS_TaskPromiseBase::unhandled_exception()
+{
+	// Kept for whoever awaits the task, co_await rethrows it
+	mException = std::current_exception();
+}
+
+/// @brief Priority of the jobs the task resumes on, inherited from the task awaiting it.
+void NOUS_Multithreading::NOUS_TaskPromiseBase::SetPriority(NOUS_JobPriority priority)
+{
+	mPriority = priority;
+}
+
+NOUS_Multithreading::NOUS_JobPriority NOUS_Multithreading::NOUS_TaskPromiseBase::GetPriority() const
+{
+	return mPriority;
+}
+
+void NOUS_Multithreading::NOUS_TaskPromiseBase::SetContinuation(std::coroutine_handle<> continuation)
+{
+	mContinuation = continuation;
+}
+
+void NOUS_Multithreading::NOUS_TaskPromiseBase::Detach()
+{
+	mDetached = true;
+}
+
+/// @brief Rethrows the exception the task ended with, if any.
+void NOUS_Multithreading::NOUS_TaskPromiseBase::RethrowException() const
+{
+	if (mException) std::rethrow_exception(mException);
+}
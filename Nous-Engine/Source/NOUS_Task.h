@@ -0,0 +1,413 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "NOUS_Job.h"
+#include "NOUS_JobSystem.h"
+
+namespace NOUS_Multithreading
+{
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief State shared by every task promise: the coroutine waiting for the task, the priority
+	/// its resume jobs are submitted with and the exception it ended with.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_TaskPromiseBase
+	{
+	public:
+
+		///////////////////////////////////////////////////////////////////////////
+		/// @brief Resumes the awaiting coroutine in place (symmetric transfer), a detached task
+		/// destroys itself instead.
+		///////////////////////////////////////////////////////////////////////////
+		struct FinalAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+
+			template<typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> coroutine) noexcept;
+
+			void await_resume() const noexcept {}
+		};
+
+		/// @brief Coroutine frames are tracked under the JOB tag.
+		static void* operator new(std::size_t size);
+		static void operator delete(void* memory, std::size_t size);
+
+		/// @brief Tasks are lazy, they start once awaited or submitted with NOUS_JobSystem::SubmitTask().
+		std::suspend_always initial_suspend() const noexcept { return {}; }
+		FinalAwaiter final_suspend() const noexcept { return {}; }
+
+		void unhandled_exception();
+
+		/// @brief Priority of the jobs the task resumes on, inherited from the task awaiting it.
+		void SetPriority(NOUS_JobPriority priority);
+		NOUS_JobPriority GetPriority() const;
+
+		void SetContinuation(std::coroutine_handle<> continuation);
+		void Detach();
+
+	protected:
+
+		/// @brief Rethrows the exception the task ended with, if any.
+		void RethrowException() const;
+
+	private:
+
+		std::coroutine_handle<>		mContinuation;
+		std::exception_ptr			mException;
+		NOUS_JobPriority			mPriority = NOUS_JobPriority::NORMAL;
+		bool						mDetached = false;
+
+	};
+
+	template<typename T>
+	class NOUS_Task;
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Promise of a NOUS_Task<T>, stores the value the coroutine returns.
+	///////////////////////////////////////////////////////////////////////////
+	template<typename T>
+	class NOUS_TaskPromise : public NOUS_TaskPromiseBase
+	{
+	public:
+
+		NOUS_Task<T> get_return_object();
+
+		template<typename Value>
+		void return_value(Value&& value) { mValue.emplace(std::forward<Value>(value)); }
+
+		T GetResult()
+		{
+			RethrowException();
+			return std::move(*mValue);
+		}
+
+	private:
+
+		std::optional<T>	mValue;
+
+	};
+
+	template<>
+	class NOUS_TaskPromise<void> : public NOUS_TaskPromiseBase
+	{
+	public:
+
+		NOUS_Task<void> get_return_object();
+
+		void return_void() const {}
+
+		void GetResult() const { RethrowException(); }
+
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Coroutine running on the job system. Every co_await on a job, a main thread hop or
+	/// another task suspends the coroutine without holding a worker; it resumes as a new job once
+	/// whatever it waits on is done, so multi-step flows are written linearly and still overlap.
+	/// @note Lazy: the body starts when the task is awaited or passed to NOUS_JobSystem::SubmitTask().
+	///////////////////////////////////////////////////////////////////////////
+	template<typename T = void>
+	class NOUS_Task
+	{
+	public:
+
+		using promise_type = NOUS_TaskPromise<T>;
+
+		///////////////////////////////////////////////////////////////////////////
+		/// @brief Starts the awaited task in place, the awaiting coroutine resumes when it returns.
+		///////////////////////////////////////////////////////////////////////////
+		struct Awaiter
+		{
+			std::coroutine_handle<promise_type> coroutine;
+
+			bool await_ready() const noexcept { return coroutine.done(); }
+
+			template<typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) noexcept
+			{
+				coroutine.promise().SetPriority(awaiting.promise().GetPriority());
+				coroutine.promise().SetContinuation(awaiting);
+
+				return coroutine;
+			}
+
+			T await_resume() { return coroutine.promise().GetResult(); }
+		};
+
+		/// @brief NOUS_Task constructors.
+		NOUS_Task() = default;
+		explicit NOUS_Task(std::coroutine_handle<promise_type> coroutine) : mCoroutine(coroutine) {}
+
+		/// @brief NOUS_Task destructor, destroys the coroutine if it is still owned.
+		~NOUS_Task() { if (mCoroutine) mCoroutine.destroy(); }
+
+		/// @brief NOUS_Task move semantics definition, tasks are not copyable.
+		NOUS_Task(NOUS_Task&& other) noexcept : mCoroutine(std::exchange(other.mCoroutine, nullptr)) {}
+
+		NOUS_Task& operator=(NOUS_Task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (mCoroutine) mCoroutine.destroy();
+				mCoroutine = std::exchange(other.mCoroutine, nullptr);
+			}
+
+			return *this;
+		}
+
+		NOUS_Task(const NOUS_Task&) = delete;
+		NOUS_Task& operator=(const NOUS_Task&) = delete;
+
+		Awaiter operator co_await() const noexcept
+		{
+			NOUS_ASSERT_MSG(mCoroutine, "Awaiting an empty task");
+			return Awaiter{ mCoroutine };
+		}
+
+		bool IsValid() const { return mCoroutine != nullptr; }
+		bool IsDone() const { return !mCoroutine || mCoroutine.done(); }
+
+		void SetPriority(NOUS_JobPriority priority) { mCoroutine.promise().SetPriority(priority); }
+
+		/// @brief Gives up ownership, the coroutine destroys itself once it returns.
+		/// @return The coroutine, still suspended at its start.
+		std::coroutine_handle<> Detach()
+		{
+			mCoroutine.promise().Detach();
+			return std::exchange(mCoroutine, nullptr);
+		}
+
+	private:
+
+		std::coroutine_handle<promise_type>		mCoroutine;
+
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief co_await ResumeOnWorker() / ResumeOnMainThread(): moves the coroutine to a worker or to
+	/// the next main thread drain point.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_ResumeAwaiter
+	{
+	public:
+
+		NOUS_ResumeAwaiter(NOUS_JobSystem* jobSystem, bool mainThread) : mJobSystem(jobSystem), mMainThread(mainThread) {}
+
+		bool await_ready() const { return mMainThread && mJobSystem->IsMainThread(); }
+
+		template<typename Promise>
+		void await_suspend(std::coroutine_handle<Promise> coroutine)
+		{
+			if (mMainThread)
+			{
+				mJobSystem->SubmitMainThreadTask([coroutine]() { coroutine.resume(); }, "Task Resume");
+			}
+			else
+			{
+				mJobSystem->SubmitJob([coroutine]() { coroutine.resume(); }, "Task Resume", coroutine.promise().GetPriority());
+			}
+		}
+
+		void await_resume() const {}
+
+	private:
+
+		NOUS_JobSystem*		mJobSystem;
+		bool				mMainThread;
+
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief co_await WaitForJob(): resumes on a worker once the job completes, as a continuation of it.
+	///////////////////////////////////////////////////////////////////////////
+	class NOUS_JobAwaiter
+	{
+	public:
+
+		NOUS_JobAwaiter(NOUS_JobSystem* jobSystem, NOUS_JobHandle handle) : mJobSystem(jobSystem), mHandle(std::move(handle)) {}
+
+		bool await_ready() const { return mHandle.IsComplete(); }
+
+		template<typename Promise>
+		void await_suspend(std::coroutine_handle<Promise> coroutine)
+		{
+			mJobSystem->SubmitJob([coroutine]() { coroutine.resume(); }, "Task Resume", coroutine.promise().GetPriority(), { mHandle });
+		}
+
+		void await_resume() const {}
+
+	private:
+
+		NOUS_JobSystem*		mJobSystem;
+		NOUS_JobHandle		mHandle;
+
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief co_await ExecuteAsync(): runs a blocking call (file read, import, decode) as a job and
+	/// continues on the same worker with its result.
+	///////////////////////////////////////////////////////////////////////////
+	template<typename Function>
+	class NOUS_CallAwaiter
+	{
+	public:
+
+		using Result = std::invoke_result_t<Function&>;
+
+		NOUS_CallAwaiter(NOUS_JobSystem* jobSystem, Function function, NOUS_JobName callName) :
+			mJobSystem(jobSystem), mFunction(std::move(function)), mCallName(callName) {}
+
+		bool await_ready() const { return false; }
+
+		template<typename Promise>
+		void await_suspend(std::coroutine_handle<Promise> coroutine)
+		{
+			// The awaiter lives in the suspended coroutine frame until the job resumes it
+			mJobSystem->SubmitJob([this, coroutine]() {
+
+				try
+				{
+					if constexpr (std::is_void_v<Result>) mFunction();
+					else mResult.emplace(mFunction());
+				}
+				catch (...)
+				{
+					mException = std::current_exception();
+				}
+
+				coroutine.resume();
+
+				}, mCallName, coroutine.promise().GetPriority());
+		}
+
+		Result await_resume()
+		{
+			if (mException) std::rethrow_exception(mException);
+
+			if constexpr (!std::is_void_v<Result>) return std::move(*mResult);
+		}
+
+	private:
+
+		using Storage = std::conditional_t<std::is_void_v<Result>, bool, Result>;
+
+		NOUS_JobSystem*			mJobSystem;
+		Function				mFunction;
+		NOUS_JobName			mCallName;
+
+		std::optional<Storage>	mResult;
+		std::exception_ptr		mException;
+
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief co_await WaitUntil(): parks the coroutine in the job system, which checks the predicate once per
+	/// ExecuteMainThreadTasks() call and resumes it on the main thread once it holds. Meant for state nothing
+	/// signals, like GPU fences. A parked task holds no job and doesn't count as pending.
+	///////////////////////////////////////////////////////////////////////////
+	template<typename Predicate>
+	class NOUS_PollAwaiter
+	{
+	public:
+
+		NOUS_PollAwaiter(NOUS_JobSystem* jobSystem, Predicate predicate) : mJobSystem(jobSystem), mPredicate(std::move(predicate)) {}
+
+		bool await_ready() { return mPredicate(); }
+
+		void await_suspend(std::coroutine_handle<> coroutine)
+		{
+			mCoroutine = coroutine;
+
+			// The main thread may resume the coroutine and free this awaiter before the call returns
+			mJobSystem->AddMainThreadPoll({ &IsReady, &Resume, this });
+		}
+
+		void await_resume() const {}
+
+	private:
+
+		static bool IsReady(void* awaiter) { return static_cast<NOUS_PollAwaiter*>(awaiter)->mPredicate(); }
+		static void Resume(void* awaiter) { static_cast<NOUS_PollAwaiter*>(awaiter)->mCoroutine.resume(); }
+
+	private:
+
+		NOUS_JobSystem*				mJobSystem;
+		Predicate					mPredicate;
+		std::coroutine_handle<>		mCoroutine;
+
+	};
+
+	/// @brief Continues the coroutine on a worker, at the task's priority.
+	inline NOUS_ResumeAwaiter ResumeOnWorker(NOUS_JobSystem& jobSystem)
+	{
+		return NOUS_ResumeAwaiter(&jobSystem, false);
+	}
+
+	/// @brief Continues the coroutine on the main thread, at its next drain point.
+	/// @note Doesn't suspend if already on the main thread.
+	inline NOUS_ResumeAwaiter ResumeOnMainThread(NOUS_JobSystem& jobSystem)
+	{
+		return NOUS_ResumeAwaiter(&jobSystem, true);
+	}
+
+	/// @brief Suspends until the job completes, the coroutine continues on a worker.
+	inline NOUS_JobAwaiter WaitForJob(NOUS_JobSystem& jobSystem, NOUS_JobHandle handle)
+	{
+		return NOUS_JobAwaiter(&jobSystem, std::move(handle));
+	}
+
+	/// @brief Runs function as a job, the coroutine continues on that worker with its result.
+	/// @note Exceptions thrown by function are rethrown from the co_await.
+	template<typename Function>
+	inline NOUS_CallAwaiter<std::decay_t<Function>> ExecuteAsync(NOUS_JobSystem& jobSystem, Function&& function,
+		NOUS_JobName callName = "Async Call")
+	{
+		return NOUS_CallAwaiter<std::decay_t<Function>>(&jobSystem, std::forward<Function>(function), callName);
+	}
+
+	/// @brief Suspends until predicate returns true, checked on the main thread once per ExecuteMainThreadTasks() call.
+	template<typename Predicate>
+	inline NOUS_PollAwaiter<std::decay_t<Predicate>> WaitUntil(NOUS_JobSystem& jobSystem, Predicate&& predicate)
+	{
+		return NOUS_PollAwaiter<std::decay_t<Predicate>>(&jobSystem, std::forward<Predicate>(predicate));
+	}
+
+	/// @brief Suspends for at least the given time without holding a thread, resumes on the main thread.
+	inline auto Delay(NOUS_JobSystem& jobSystem, std::chrono::milliseconds duration)
+	{
+		const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + duration;
+
+		return WaitUntil(jobSystem, [end]() { return std::chrono::steady_clock::now() >= end; });
+	}
+
+	template<typename Promise>
+	inline std::coroutine_handle<> NOUS_TaskPromiseBase::FinalAwaiter::await_suspend(std::coroutine_handle<Promise> coroutine) noexcept
+	{
+		NOUS_TaskPromiseBase& promise = coroutine.promise();
+
+		if (promise.mContinuation) return promise.mContinuation;
+
+		if (promise.mDetached) coroutine.destroy();
+
+		return std::noop_coroutine();
+	}
+
+	template<typename T>
+	inline NOUS_Task<T> NOUS_TaskPromise<T>::get_return_object()
+	{
+		return NOUS_Task<T>(std::coroutine_handle<NOUS_TaskPromise<T>>::from_promise(*this));
+	}
+
+	inline NOUS_Task<void> NOUS_TaskPromise<void>::get_return_object()
+	{
+		return NOUS_Task<void>(std::coroutine_handle<NOUS_TaskPromise<void>>::from_promise(*this));
+	}
+}
@@ -2,25 +2,117 @@
 
 #include "MemoryManager.h"
 
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 #ifdef TRACY_ENABLE
 #include "Tracy.h"
 #endif
 
+/// @brief Pool and worker index of the calling thread, lets SubmitJob() push to the caller's own deque.
+static thread_local const NOUS_Multithreading::NOUS_ThreadPool* tCurrentPool = nullptr;
+static thread_local uint32 tWorkerIndex = 0;
+
+/// @brief Victim selection of threads outside the pool helping with ExecutePendingJob().
+static thread_local uint64 tRandomState = 0x2545F4914F6CDD1DULL;
+
+/// @brief Job executed by the calling thread, and how many background jobs it is nested inside.
+/// A thread holding a background slot keeps it until its outermost background job returns.
+static thread_local const NOUS_Multithreading::NOUS_Job* tExecutingJob = nullptr;
+static thread_local uint32 tHeldBackgroundJobs = 0;
+
+/// @brief Spin-wait hint, lets the other hardware thread of the core run and saves power while spinning.
+static inline void CpuRelax()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
 /// @brief NOUS_ThreadPool constructor.
-/// @note Marked explicit to prevent implicit conversions and copy-initialization from a single argument.
-NOUS_Multithreading::NOUS_ThreadPool::NOUS_ThreadPool(uint8 numThreads) :
-	mShutdown(false)
+/// @param numThreads: Number of worker threads to spawn.
+/// @param jobPool: Pool the submitted jobs were allocated from, executed jobs are returned to it.
+/// @param pinWorkers: Pins every worker to a logical core, see NOUS_CpuTopology::GetWorkerPlacement().
+NOUS_Multithreading::NOUS_ThreadPool::NOUS_ThreadPool(uint32 numThreads, NOUS_JobPool* jobPool, bool pinWorkers) :
+	mQueuedJobs(0), mQueuedPriorityJobs(), mActiveBackgroundWorkers(0), mMaxBackgroundWorkers((numThreads + 1) / 2), 
+	mSleepingWorkers(0), mSpinningWorkers(0), mMaxSpinningWorkers(0), mWakeups(0), mShutdown(false), mPinWorkers(pinWorkers), mJobPool(jobPool)
 {
-	numThreads = std::max<uint8>(0, numThreads);
+	if (mMaxBackgroundWorkers == 0) mMaxBackgroundWorkers = 1;
+
+	const NOUS_CpuTopology& topology = NOUS_CpuTopology::Get();
+	const std::vector<uint32> placement = topology.GetWorkerPlacement();
+
+	// On a single core a spinning worker only delays the thread that would submit its next job
+	if (topology.GetLogicalCoreCount() > 1)
+	{
+		mMaxSpinningWorkers = std::max<uint32>(numThreads / 2, 1);
+	}
+
+	mParkedWorkers.reserve(numThreads);
+
+	mWorkers.reserve(numThreads);
 	mThreads.reserve(numThreads);
 
-	for (uint8 i = 0; i < numThreads; ++i)
+	// Every worker exists before any thread starts, thieves walk the whole list
+	for (uint32 i = 0; i < numThreads; ++i)
 	{
-		mThreads.push_back(NOUS_NEW<NOUS_Thread>(MemoryManager::MemoryTag::THREAD));
+		Worker* worker = NOUS_NEW_ALIGNED<Worker>(MemoryManager::c_CACHE_LINE_SIZE, MemoryManager::MemoryTag::THREAD);
+
+		worker->thread = NOUS_NEW<NOUS_Thread>(MemoryManager::MemoryTag::THREAD);
+		worker->randomState = 0x9E3779B97F4A7C15ULL * (i + 1);
 
+		if (pinWorkers && !placement.empty())
+		{
+			// More workers than logical cores wrap around, they share cores with the first ones
+			worker->core = &topology.GetLogicalCores()[placement[i % placement.size()]];
+			worker->smtSibling = worker->core->smtIndex > 0 || i >= placement.size();
+		}
+
+		mWorkers.push_back(worker);
+		mThreads.push_back(worker->thread);
+	}
+
+	// Floating workers have no known cache domain, all of them count as local
+	for (Worker* worker : mWorkers)
+	{
+		for (const bool local : { true, false })
+		{
+			for (Worker* victim : mWorkers)
+			{
+				if (victim == worker) continue;
+
+				const bool sameDomain = !worker->core || !victim->core || worker->core->cacheDomain == victim->core->cacheDomain;
+
+				if (sameDomain == local) worker->victims.push_back(victim);
+			}
+
+			if (local) worker->localVictims = worker->victims.size();
+		}
+	}
+
+	for (uint32 i = 0; i < numThreads; ++i)
+	{
 		mThreads[i]->Start([this, i]() {
+			tCurrentPool = this;
+			tWorkerIndex = i;
+
 			mThreads[i]->SetName("Worker Thread " + std::to_string(i + 1));
-			WorkerLoop(mThreads[i]);
+			NOUS_JobProfiler::Get().RegisterThread(mThreads[i]->GetName());
+
+			if (const NOUS_LogicalCore* core = mWorkers[i]->core)
+			{
+				if (!NOUS_CpuTopology::PinCurrentThread(*core))
+				{
+					NOUS_WARN("Failed to pin %s to logical core %u", mThreads[i]->GetName().c_str(), core->id);
+				}
+			}
+
+			WorkerLoop(mWorkers[i]);
 			});
 	}
 }
@@ -31,18 +123,60 @@ NOUS_Multithreading::NOUS_ThreadPool::~NOUS_ThreadPool()
 	Shutdown();
 }
 
-/// @brief Adds a job to the queue and notifies a worker.
+/// @brief Queues a job and wakes a sleeping worker if there's one.
 /// @param job The job to be executed.
 void NOUS_Multithreading::NOUS_ThreadPool::SubmitJob(NOUS_Job* job)
 {
+	const uint32 priority = static_cast<uint32>(job->GetPriority());
+
+	NOUS_JobProfiler::Get().MarkEnqueued(job); // Before it's published, a worker may take it right away
+
+	// Counted before it's published, FindJob() decrements as soon as it takes the job and must never go below 0.
+	// A worker seeing the count before the job only looks again, WakeWorker() below still pairs with ParkWorker().
+	mQueuedPriorityJobs[priority].fetch_add(1, std::memory_order_seq_cst);
+	mQueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+	try
 	{
-		std::lock_guard<std::mutex> lock(mMutex);
-		mJobQueue.push(std::move(job));
+		if (tCurrentPool == this)
+		{
+			// Submitted from a worker: its own deque, no lock and likely still in cache when it runs
+			mWorkers[tWorkerIndex]->queues[priority].Push(job);
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(mInjectionMutex);
+			mInjectionQueues[priority].push_back(job);
+		}
 	}
-	mConditionVar.notify_one();
+	catch (...)
+	{
+		// The queue couldn't grow, the job was never published
+		mQueuedPriorityJobs[priority].fetch_sub(1, std::memory_order_seq_cst);
+		mQueuedJobs.fetch_sub(1, std::memory_order_seq_cst);
+		throw;
+	}
+
+	WakeWorker();
+}
+
+/// @brief Runs one queued job on the calling thread, lets waiters help instead of blocking.
+/// @return false if no job was found.
+bool NOUS_Multithreading::NOUS_ThreadPool::ExecutePendingJob()
+{
+	Worker* worker = (tCurrentPool == this) ? mWorkers[tWorkerIndex] : nullptr;
+
+	bool stolen = false;
+	NOUS_Job* job = FindJob(worker, stolen);
+
+	if (!job) return false;
+
+	ExecuteJob(worker, job, stolen);
+
+	return true;
 }
 
-/// @brief Deletes pending jobs, joins all threads and cleans up resources afterwards.
+/// @brief Joins all threads, then deletes the jobs they left pending.
 void NOUS_Multithreading::NOUS_ThreadPool::Shutdown()
 {
 	if (mShutdown.exchange(true))
@@ -50,86 +184,523 @@ void NOUS_Multithreading::NOUS_ThreadPool::Shutdown()
 		return;
 	}
 
-	while (!mJobQueue.empty())
+	WakeAllWorkers();
+
+	for (NOUS_Thread* thread : mThreads)
+	{
+		thread->Join();
+	}
+
+	// No worker is left, the deques can be drained from here
+	for (Worker* worker : mWorkers)
 	{
-		NOUS_Job* job = mJobQueue.front();
-		NOUS_DELETE<NOUS_Job>(job, MemoryManager::MemoryTag::THREAD);
-		mJobQueue.pop();
+		for (NOUS_WorkStealingQueue<NOUS_Job*>& queue : worker->queues)
+		{
+			while (NOUS_Job* job = queue.Pop())
+			{
+				mJobPool->Delete(job);
+			}
+		}
+
+		NOUS_DELETE<NOUS_Thread>(worker->thread, MemoryManager::MemoryTag::THREAD);
+		NOUS_DELETE_ALIGNED<Worker>(worker, MemoryManager::c_CACHE_LINE_SIZE, MemoryManager::MemoryTag::THREAD);
 	}
 
-	mConditionVar.notify_all();
+	for (nous::deque<NOUS_Job*, MemoryManager::MemoryTag::JOB>& queue : mInjectionQueues)
+	{
+		for (NOUS_Job* job : queue)
+		{
+			mJobPool->Delete(job);
+		}
 
-	for (NOUS_Thread* thread : mThreads)
+		queue.clear();
+	}
+
+	for (std::atomic<uint64>& queuedJobs : mQueuedPriorityJobs)
 	{
-		thread->Join();
-		NOUS_DELETE<NOUS_Thread>(thread, MemoryManager::MemoryTag::THREAD);
+		queuedJobs = 0;
 	}
 
+	mQueuedJobs = 0;
+
+	mWorkers.clear();
 	mThreads.clear();
 }
 
 /// @return A vector of NOUS_Thread contained inside the thread pool.
 const std::vector<NOUS_Multithreading::NOUS_Thread*>& NOUS_Multithreading::NOUS_ThreadPool::GetThreads() const
-{ 
-	return mThreads; 
+{
+	return mThreads;
 }
 
-/// @return A queue of NOUS_Job to be executed by the thread pool.
-const std::queue<NOUS_Multithreading::NOUS_Job*>& NOUS_Multithreading::NOUS_ThreadPool::GetJobQueue() const
+/// @return Approximate number of jobs queued and not started yet.
+uint64 NOUS_Multithreading::NOUS_ThreadPool::GetQueuedJobCount() const
 {
-	return mJobQueue;
+	return mQueuedJobs.load(std::memory_order_relaxed);
 }
 
-/// @brief Worker loop that each thread executes to process jobs from the queue.
-/// @param thread The thread executing this loop.
-void NOUS_Multithreading::NOUS_ThreadPool::WorkerLoop(NOUS_Thread* thread)
+uint64 NOUS_Multithreading::NOUS_ThreadPool::GetQueuedJobCount(NOUS_JobPriority priority) const
 {
-#ifdef TRACY_ENABLE
-	tracy::SetThreadName(thread->GetName().c_str()); // Set thread name
-#endif
+	return mQueuedPriorityJobs[static_cast<uint32>(priority)].load(std::memory_order_relaxed);
+}
 
-	while (true)
+/// @brief Caps the workers running background jobs at the same time, at least one is allowed.
+void NOUS_Multithreading::NOUS_ThreadPool::SetMaxBackgroundWorkers(uint32 maxWorkers)
+{
+	mMaxBackgroundWorkers.store((maxWorkers > 0) ? maxWorkers : 1, std::memory_order_seq_cst);
+
+	// A higher cap may let sleeping workers pick queued background jobs
+	WakeAllWorkers();
+}
+
+uint32 NOUS_Multithreading::NOUS_ThreadPool::GetMaxBackgroundWorkers() const
+{
+	return mMaxBackgroundWorkers.load(std::memory_order_relaxed);
+}
+
+uint32 NOUS_Multithreading::NOUS_ThreadPool::GetActiveBackgroundWorkers() const
+{
+	return mActiveBackgroundWorkers.load(std::memory_order_relaxed);
+}
+
+/// @brief Caps the workers spinning for jobs at the same time, 0 parks idle workers right away.
+void NOUS_Multithreading::NOUS_ThreadPool::SetMaxSpinningWorkers(uint32 maxWorkers)
+{
+	mMaxSpinningWorkers.store(std::min<uint32>(maxWorkers, static_cast<uint32>(mWorkers.size())), std::memory_order_relaxed);
+}
+
+uint32 NOUS_Multithreading::NOUS_ThreadPool::GetMaxSpinningWorkers() const
+{
+	return mMaxSpinningWorkers.load(std::memory_order_relaxed);
+}
+
+/// @return Workers spinning for jobs and workers parked, approximate.
+uint32 NOUS_Multithreading::NOUS_ThreadPool::GetSpinningWorkers() const
+{
+	return mSpinningWorkers.load(std::memory_order_relaxed);
+}
+
+uint32 NOUS_Multithreading::NOUS_ThreadPool::GetParkedWorkers() const
+{
+	return mSleepingWorkers.load(std::memory_order_relaxed);
+}
+
+/// @return Parked workers woken up since the pool was created.
+uint64 NOUS_Multithreading::NOUS_ThreadPool::GetWakeupCount() const
+{
+	return mWakeups.load(std::memory_order_relaxed);
+}
+
+/// @return Job being executed by the calling thread, nullptr outside of a job.
+const NOUS_Multithreading::NOUS_Job* NOUS_Multithreading::NOUS_ThreadPool::GetCurrentJob()
+{
+	return tExecutingJob;
+}
+
+/// @return Counters of the injection queues, all priorities added up.
+NOUS_Multithreading::NOUS_JobQueueStats NOUS_Multithreading::NOUS_ThreadPool::GetInjectionQueueStats() const
+{
+	std::lock_guard<std::mutex> lock(mInjectionMutex);
+
+	uint64 pendingJobs = 0;
+
+	for (const nous::deque<NOUS_Job*, MemoryManager::MemoryTag::JOB>& queue : mInjectionQueues)
+	{
+		pendingJobs += queue.size();
+	}
+
+	return { pendingJobs, 0, 0 };
+}
+
+/// @return Counters of a worker deque, in GetThreads() order.
+NOUS_Multithreading::NOUS_JobQueueStats NOUS_Multithreading::NOUS_ThreadPool::GetWorkerQueueStats(uint32 workerIndex) const
+{
+	if (workerIndex >= mWorkers.size()) return {};
+
+	const Worker* worker = mWorkers[workerIndex];
+
+	uint64 pendingJobs = 0;
+
+	for (const NOUS_WorkStealingQueue<NOUS_Job*>& queue : worker->queues)
 	{
+		pendingJobs += queue.GetSize();
+	}
+
+	return { pendingJobs, worker->executedJobs.load(std::memory_order_relaxed), worker->stolenJobs.load(std::memory_order_relaxed) };
+}
+
+/// @return Logical core a worker is pinned to, nullptr if it isn't.
+const NOUS_Multithreading::NOUS_LogicalCore* NOUS_Multithreading::NOUS_ThreadPool::GetWorkerCore(uint32 workerIndex) const
+{
+	return (workerIndex < mWorkers.size()) ? mWorkers[workerIndex]->core : nullptr;
+}
+
+bool NOUS_Multithreading::NOUS_ThreadPool::IsPinningWorkers() const
+{
+	return mPinWorkers;
+}
+
+/// @brief Worker loop that each thread executes to process jobs from the queues.
+/// @param worker The worker executing this loop.
+void NOUS_Multithreading::NOUS_ThreadPool::WorkerLoop(Worker* worker)
+{
 #ifdef TRACY_ENABLE
-		ZoneScoped;
+	tracy::SetThreadName(worker->thread->GetName().c_str()); // Set thread name
 #endif
 
-		NOUS_Job* job = nullptr;
+	worker->thread->SetThreadState(ThreadState::READY);
 
+	while (!mShutdown.load(std::memory_order_relaxed))
+	{
+		bool stolen = false;
+
+		if (NOUS_Job* job = FindJob(worker, stolen))
 		{
-			std::unique_lock<std::mutex> lock(mMutex);
+			ExecuteJob(worker, job, stolen);
+			continue;
+		}
 
-			thread->SetThreadState(ThreadState::READY);
+		// Threads sleep when there's no work they're allowed to run, after a short wait for more
+		if (!SpinForJobs(worker))
+		{
+			ParkWorker(worker);
+		}
+	}
+
+	worker->thread->SetThreadState(ThreadState::READY);
+}
+
+/// @brief Highest priority job available: own deque, injection queue, then other deques.
+/// @param worker: nullptr for threads outside the pool, which never pick background jobs.
+/// @param outStolen: Set if the job came from another worker's deque.
+NOUS_Multithreading::NOUS_Job* NOUS_Multithreading::NOUS_ThreadPool::FindJob(Worker* worker, bool& outStolen)
+{
+	uint64& randomState = worker ? worker->randomState : tRandomState;
+
+	// SMT siblings share their core with another worker, they leave frame work to whole cores when they can
+	const uint32 firstPriority = (worker && worker->smtSibling) ? c_BACKGROUND_PRIORITY : 0;
+
+	for (uint32 i = 0; i < c_PRIORITY_COUNT; ++i)
+	{
+		const uint32 priority = (firstPriority + i) % c_PRIORITY_COUNT;
+
+		if (mQueuedPriorityJobs[priority].load(std::memory_order_relaxed) == 0) continue;
 
-			mConditionVar.wait(lock, [this]() {
-				return !mJobQueue.empty() || mShutdown; // Threads sleep when there's no work.
-				});
+		// Only a capped number of workers take background jobs, a thread already inside one keeps its slot
+		const bool needsSlot = (priority == c_BACKGROUND_PRIORITY) && tHeldBackgroundJobs == 0;
 
-			if (mShutdown && mJobQueue.empty()) break;
+		if (priority == c_BACKGROUND_PRIORITY && !worker) continue; // A long load would stall the waiting thread
+		if (needsSlot && !TryAcquireBackgroundSlot()) continue;
 
-			job = std::move(mJobQueue.front());
-			mJobQueue.pop();
+		if (NOUS_Job* job = TakeJob(priority, randomState, worker, outStolen))
+		{
+			mQueuedPriorityJobs[priority].fetch_sub(1, std::memory_order_relaxed);
+			mQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+			return job;
 		}
 
-		thread->SetThreadState(ThreadState::RUNNING);
-		thread->SetCurrentJob(job);
-		thread->StartExecutionTimer();
+		if (needsSlot) ReleaseBackgroundSlot();
+	}
+
+	return nullptr;
+}
+
+NOUS_Multithreading::NOUS_Job* NOUS_Multithreading::NOUS_ThreadPool::TakeJob(uint32 priority, uint64& randomState, Worker* worker, bool& outStolen)
+{
+	NOUS_Job* job = worker ? worker->queues[priority].Pop() : nullptr;
+
+	if (!job) job = PopInjectedJob(priority);
+	if (job) return job;
+
+	job = StealJob(priority, randomState, worker);
+	outStolen = (job != nullptr);
+
+	return job;
+}
+
+NOUS_Multithreading::NOUS_Job* NOUS_Multithreading::NOUS_ThreadPool::PopInjectedJob(uint32 priority)
+{
+	std::lock_guard<std::mutex> lock(mInjectionMutex);
+
+	nous::deque<NOUS_Job*, MemoryManager::MemoryTag::JOB>& queue = mInjectionQueues[priority];
+
+	if (queue.empty()) return nullptr;
+
+	NOUS_Job* job = queue.front();
+	queue.pop_front();
+
+	return job;
+}
+
+NOUS_Multithreading::NOUS_Job* NOUS_Multithreading::NOUS_ThreadPool::StealJob(uint32 priority, uint64& randomState, Worker* self)
+{
+	const uint64 workerCount = mWorkers.size();
+
+	if (workerCount == 0 || (self && workerCount < 2)) return nullptr;
+
+	// xorshift64, a random first victim spreads thieves over the deques instead of all hitting the same one
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+
+	if (!self) return StealJobFrom(priority, randomState, nullptr, mWorkers.data(), workerCount);
+
+	// Workers sharing the L3 first, the jobs they pushed likely work on data still in that cache
+	Worker* const* victims = self->victims.data();
+	const uint64 localVictims = self->localVictims;
+
+	if (NOUS_Job* job = StealJobFrom(priority, randomState, self, victims, localVictims)) return job;
 
-		try
+	return StealJobFrom(priority, randomState >> 32, self, victims + localVictims, self->victims.size() - localVictims);
+}
+
+NOUS_Multithreading::NOUS_Job* NOUS_Multithreading::NOUS_ThreadPool::StealJobFrom(uint32 priority, uint64 randomValue, Worker* self, 
+	Worker* const* victims, uint64 victimCount)
+{
+	if (victimCount == 0) return nullptr;
+
+	const uint64 first = randomValue % victimCount;
+
+	for (uint64 i = 0; i < victimCount; ++i)
+	{
+		Worker* victim = victims[(first + i) % victimCount];
+
+		if (victim == self) continue;
+
+		if (NOUS_Job* job = victim->queues[priority].Steal())
 		{
-			job->Execute();
+			if (self) self->stolenJobs.fetch_add(1, std::memory_order_relaxed);
+			return job;
 		}
-		catch (const std::exception& e)
+	}
+
+	return nullptr;
+}
+
+bool NOUS_Multithreading::NOUS_ThreadPool::TryAcquireBackgroundSlot()
+{
+	uint32 activeWorkers = mActiveBackgroundWorkers.load(std::memory_order_relaxed);
+
+	while (activeWorkers < mMaxBackgroundWorkers.load(std::memory_order_relaxed))
+	{
+		if (mActiveBackgroundWorkers.compare_exchange_weak(activeWorkers, activeWorkers + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
 		{
-			NOUS_ERROR(("Job '" + job->GetName() + "' failed: " + e.what()).c_str());
+			return true;
 		}
+	}
 
-		NOUS_DELETE<NOUS_Job>(job, MemoryManager::MemoryTag::THREAD);
+	return false;
+}
 
-		thread->StopExecutionTimer();
-		thread->SetCurrentJob(nullptr);
-		thread->SetThreadState(ThreadState::READY);
+void NOUS_Multithreading::NOUS_ThreadPool::ReleaseBackgroundSlot()
+{
+	mActiveBackgroundWorkers.fetch_sub(1, std::memory_order_seq_cst);
+
+	// Workers may be asleep with background jobs they weren't allowed to take
+	if (mQueuedPriorityJobs[c_BACKGROUND_PRIORITY].load(std::memory_order_seq_cst) > 0)
+	{
+		WakeWorker();
+	}
+}
+
+/// @return true if a sleeping worker would find something to run.
+bool NOUS_Multithreading::NOUS_ThreadPool::HasRunnableJobs() const
+{
+	const uint64 backgroundJobs = mQueuedPriorityJobs[c_BACKGROUND_PRIORITY].load(std::memory_order_seq_cst);
+
+	if (mQueuedJobs.load(std::memory_order_seq_cst) > backgroundJobs) return true;
+
+	return backgroundJobs > 0 && mActiveBackgroundWorkers.load(std::memory_order_seq_cst) < mMaxBackgroundWorkers.load(std::memory_order_relaxed);
+}
+
+bool NOUS_Multithreading::NOUS_ThreadPool::SpinForJobs(Worker* worker)
+{
+	uint32 spinningWorkers = mSpinningWorkers.load(std::memory_order_relaxed);
+
+	do
+	{
+		if (spinningWorkers >= mMaxSpinningWorkers.load(std::memory_order_relaxed)) return false;
+	}
+	while (!mSpinningWorkers.compare_exchange_weak(spinningWorkers, spinningWorkers + 1, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+	bool found = false;
+
+	for (uint32 round = 0; round < worker->spinRounds && !found; ++round)
+	{
+		for (uint32 i = 0; i < c_PAUSES_PER_SPIN_ROUND; ++i)
+		{
+			CpuRelax();
+		}
+
+		found = HasRunnableJobs() || mShutdown.load(std::memory_order_relaxed);
+	}
+
+	for (uint32 i = 0; i < c_YIELD_ROUNDS && !found; ++i)
+	{
+		std::this_thread::yield();
+
+		found = HasRunnableJobs() || mShutdown.load(std::memory_order_relaxed);
+	}
+
+	const bool lastSpinner = mSpinningWorkers.fetch_sub(1, std::memory_order_seq_cst) == 1;
+
+	if (found)
+	{
+		worker->spinRounds = std::min(worker->spinRounds * 2, c_MAX_SPIN_ROUNDS);
+
+		// Submitters didn't wake anyone while this worker spun, the rest of a burst needs another one
+		if (lastSpinner && mQueuedJobs.load(std::memory_order_seq_cst) > 1) WakeWorker();
 	}
+	else
+	{
+		worker->spinRounds = std::max(worker->spinRounds / 2, c_MIN_SPIN_ROUNDS);
+	}
+
+	return found;
+}
+
+void NOUS_Multithreading::NOUS_ThreadPool::ParkWorker(Worker* worker)
+{
+	{
+		std::lock_guard<std::mutex> lock(mParkMutex);
+
+		worker->parked.store(true, std::memory_order_relaxed);
+		mParkedWorkers.push_back(worker);
+
+		mSleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+	}
+
+	// Pairs with WakeWorker(): either this sees the new job, or the submitter sees this worker parked
+	if (HasRunnableJobs() || mShutdown.load(std::memory_order_seq_cst))
+	{
+		std::lock_guard<std::mutex> lock(mParkMutex);
+
+		auto it = std::find(mParkedWorkers.begin(), mParkedWorkers.end(), worker);
+
+		// Not found: a submitter already took it and clears the flag right after
+		if (it != mParkedWorkers.end())
+		{
+			mParkedWorkers.erase(it);
+			mSleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+
+			worker->parked.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	while (worker->parked.load(std::memory_order_acquire))
+	{
+		worker->parked.wait(true, std::memory_order_acquire);
+	}
+}
+
+void NOUS_Multithreading::NOUS_ThreadPool::WakeWorker()
+{
+	// Pairs with the worker registering itself before re-checking the queues, one of both sees the other.
+	// A spinning worker finds the job by itself and hands the rest of a burst over when it stops spinning.
+	if (mSpinningWorkers.load(std::memory_order_seq_cst) > 0 || mSleepingWorkers.load(std::memory_order_seq_cst) == 0)
+	{
+		return;
+	}
+
+	Worker* worker = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(mParkMutex);
+
+		if (mParkedWorkers.empty()) return;
+
+		worker = mParkedWorkers.back();
+		mParkedWorkers.pop_back();
+
+		mSleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	UnparkWorker(worker);
+}
+
+void NOUS_Multithreading::NOUS_ThreadPool::WakeAllWorkers()
+{
+	std::lock_guard<std::mutex> lock(mParkMutex);
+
+	for (Worker* worker : mParkedWorkers)
+	{
+		UnparkWorker(worker);
+	}
+
+	mParkedWorkers.clear();
+	mSleepingWorkers.store(0, std::memory_order_relaxed);
+}
+
+void NOUS_Multithreading::NOUS_ThreadPool::UnparkWorker(Worker* worker)
+{
+	worker->parked.store(false, std::memory_order_release);
+	worker->parked.notify_one();
+
+	mWakeups.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// @param worker: nullptr when the job runs on a thread outside the pool.
+/// @param stolen: Reported to NOUS_JobProfiler.
+void NOUS_Multithreading::NOUS_ThreadPool::ExecuteJob(Worker* worker, NOUS_Job* job, bool stolen)
+{
+#ifdef TRACY_ENABLE
+	ZoneScoped;
+#endif
+
+	NOUS_Thread* thread = worker ? worker->thread : nullptr;
+
+	const NOUS_Job* outerExecutingJob = tExecutingJob;
+	const bool background = job->GetPriority() == NOUS_JobPriority::BACKGROUND;
+
+	tExecutingJob = job;
+	if (background) tHeldBackgroundJobs++;
+
+	// A worker waiting on a handle runs other jobs from inside its current one
+	NOUS_Job* outerJob = thread ? thread->GetCurrentJob() : nullptr;
+
+	if (thread)
+	{
+		thread->SetCurrentJob(job);
+
+		if (!outerJob)
+		{
+			thread->SetThreadState(ThreadState::RUNNING);
+			thread->StartExecutionTimer();
+		}
+	}
+
+	NOUS_JobProfiler& profiler = NOUS_JobProfiler::Get();
+	const uint64 startTime = profiler.BeginJob();
+
+	try
+	{
+		job->Execute();
+	}
+	catch (const std::exception& e)
+	{
+		NOUS_ERROR("Job '%s' failed: %s", job->GetName(), e.what());
+	}
+
+	profiler.EndJob(job, startTime, stolen);
+
+	if (thread)
+	{
+		thread->SetCurrentJob(outerJob);
+
+		if (!outerJob)
+		{
+			thread->StopExecutionTimer();
+			thread->SetThreadState(ThreadState::READY);
+		}
+
+		worker->executedJobs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	tExecutingJob = outerExecutingJob;
+
+	// The slot taken by FindJob() is returned once the outermost background job is done
+	if (background && --tHeldBackgroundJobs == 0) ReleaseBackgroundSlot();
 
-	thread->SetThreadState(ThreadState::READY);
+	mJobPool->Delete(job);
 }
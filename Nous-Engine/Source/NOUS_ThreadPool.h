@@ -3,53 +3,202 @@
 #include "Globals.h"
 
 #include <vector>
-#include <queue>
 #include <mutex>
 
 #include "NOUS_Job.h"
 #include "NOUS_Thread.h"
+#include "NOUS_CpuTopology.h"
+#include "NOUS_JobProfiler.h"
+#include "NOUS_WorkStealingQueue.h"
+#include "PoolAllocator.h"
+#include "NousAllocator.h"
 
 namespace NOUS_Multithreading
 {
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Introspection counters of one job queue (a worker deque or the injection queue).
+	///////////////////////////////////////////////////////////////////////////
+	struct NOUS_JobQueueStats
+	{
+		uint64 pendingJobs;		// Approximate, the queue keeps changing while it's read
+		uint64 executedJobs;	// Jobs run by the worker (0 for the injection queue)
+		uint64 stolenJobs;		// Jobs the worker took from other workers' deques
+	};
+
 	///////////////////////////////////////////////////////////////////////////
 	/// @brief Manages a pool of worker threads and job distribution between them.
+	/// Every worker owns a work-stealing deque per priority: jobs submitted from a worker go to its own
+	/// deque, jobs submitted from any other thread go to a shared injection queue of that priority.
+	/// Idle workers go through the priorities from critical to background, and for each one run their
+	/// own jobs first, then the injection queue, then steal from random victims. Background jobs only
+	/// run on up to GetMaxBackgroundWorkers() workers at once, the rest stay free for frame work.
+	/// Pinned workers follow NOUS_CpuTopology: thieves try victims sharing their L3 first, and workers
+	/// on SMT siblings look for background jobs first so frame work keeps whole cores.
+	/// A worker out of jobs spins for a while, then yields, then parks on its own flag. Submitters leave
+	/// the wakeup to a spinning worker when there's one and otherwise unpark a single parked worker, so
+	/// bursts of short jobs don't pay a kernel wakeup per job. Workers that keep finding jobs while
+	/// spinning spin longer next time, the ones that don't spin less.
 	///////////////////////////////////////////////////////////////////////////
 	class NOUS_ThreadPool
 	{
 	public:
 
 		/// @brief NOUS_ThreadPool constructor.
-		/// @note Marked explicit to prevent implicit conversions and copy-initialization from a single argument.
-		explicit NOUS_ThreadPool(uint8 numThreads);
+		/// @param numThreads: Number of worker threads to spawn.
+		/// @param jobPool: Pool the submitted jobs were allocated from, executed jobs are returned to it.
+		/// @param pinWorkers: Pins every worker to a logical core, see NOUS_CpuTopology::GetWorkerPlacement().
+		NOUS_ThreadPool(uint32 numThreads, NOUS_JobPool* jobPool, bool pinWorkers = false);
 
 		/// @brief NOUS_ThreadPool destructor.
 		~NOUS_ThreadPool();
 
-		/// @brief Adds a job to the queue and notifies a worker.
+		/// @brief Queues a job and wakes a sleeping worker if there's one.
 		/// @param job The job to be executed.
 		void SubmitJob(NOUS_Job* job);
 
-		/// @brief Deletes pending jobs, joins all threads and cleans up resources afterwards.
+		/// @brief Runs one queued job on the calling thread, lets waiters help instead of blocking.
+		/// @return false if no job was found.
+		bool ExecutePendingJob();
+
+		/// @brief Joins all threads, then deletes the jobs they left pending.
 		void Shutdown();
 
 		/// @return A vector of NOUS_Thread contained inside the thread pool.
 		const std::vector<NOUS_Thread*>& GetThreads() const;
 
-		/// @return A queue of NOUS_Job to be executed by the thread pool.
-		const std::queue<NOUS_Job*>& GetJobQueue() const;
+		/// @return Approximate number of jobs queued and not started yet.
+		uint64 GetQueuedJobCount() const;
+		uint64 GetQueuedJobCount(NOUS_JobPriority priority) const;
+
+		/// @brief Caps the workers running background jobs at the same time, at least one is allowed.
+		void SetMaxBackgroundWorkers(uint32 maxWorkers);
+		uint32 GetMaxBackgroundWorkers() const;
+		uint32 GetActiveBackgroundWorkers() const;
+
+		/// @brief Caps the workers spinning for jobs at the same time, 0 parks idle workers right away.
+		/// Defaults to half the workers on multi-core machines and 0 on single-core ones.
+		void SetMaxSpinningWorkers(uint32 maxWorkers);
+		uint32 GetMaxSpinningWorkers() const;
+
+		/// @return Workers spinning for jobs and workers parked, approximate.
+		uint32 GetSpinningWorkers() const;
+		uint32 GetParkedWorkers() const;
+
+		/// @return Parked workers woken up since the pool was created.
+		uint64 GetWakeupCount() const;
+
+		/// @return Job being executed by the calling thread, nullptr outside of a job.
+		static const NOUS_Job* GetCurrentJob();
+
+		/// @return Counters of the injection queues, all priorities added up.
+		NOUS_JobQueueStats GetInjectionQueueStats() const;
+
+		/// @return Counters of a worker deque, in GetThreads() order.
+		NOUS_JobQueueStats GetWorkerQueueStats(uint32 workerIndex) const;
+
+		/// @return Logical core a worker is pinned to, nullptr if it isn't.
+		const NOUS_LogicalCore* GetWorkerCore(uint32 workerIndex) const;
+
+		bool IsPinningWorkers() const;
 
 	private:
 
-		/// @brief Worker loop that each thread executes to process jobs from the queue.
-		/// @param thread The thread executing this loop.
-		void WorkerLoop(NOUS_Thread* thread);
+		static constexpr uint32 c_PRIORITY_COUNT = static_cast<uint32>(NOUS_JobPriority::COUNT);
+		static constexpr uint32 c_BACKGROUND_PRIORITY = static_cast<uint32>(NOUS_JobPriority::BACKGROUND);
+
+		// Idle backoff: spin rounds of c_PAUSES_PER_SPIN_ROUND pauses each (adapted per worker), then yields, then park
+		static constexpr uint32 c_PAUSES_PER_SPIN_ROUND = 32;
+		static constexpr uint32 c_MIN_SPIN_ROUNDS = 2;
+		static constexpr uint32 c_MAX_SPIN_ROUNDS = 32;
+		static constexpr uint32 c_YIELD_ROUNDS = 8;
+
+		struct alignas(MemoryManager::c_CACHE_LINE_SIZE) Worker
+		{
+			NOUS_Thread*							thread = nullptr;
+			NOUS_WorkStealingQueue<NOUS_Job*>		queues[c_PRIORITY_COUNT];
+
+			uint64									randomState = 0;	// Victim selection, only touched by the worker
+
+			const NOUS_LogicalCore*					core = nullptr;		// Pinned core, nullptr if the thread floats
+			bool									smtSibling = false;	// Shares its core with another worker
 
-		std::queue<NOUS_Job*>		mJobQueue;
+			// Other workers, the ones sharing this worker's L3 first
+			nous::vector<Worker*, MemoryManager::MemoryTag::THREAD>	victims;
+			uint64									localVictims = 0;
+
+			uint32									spinRounds = c_MIN_SPIN_ROUNDS;
+			std::atomic<bool>						parked = false;		// Cleared by whoever unparks the worker
+
+			std::atomic<uint64>						executedJobs = 0;
+			std::atomic<uint64>						stolenJobs = 0;
+		};
+
+		/// @brief Worker loop that each thread executes to process jobs from the queues.
+		/// @param worker The worker executing this loop.
+		void WorkerLoop(Worker* worker);
+
+		/// @brief Highest priority job available: own deque, injection queue, then other deques.
+		/// @param worker: nullptr for threads outside the pool, which never pick background jobs.
+		/// @param outStolen: Set if the job came from another worker's deque.
+		NOUS_Job* FindJob(Worker* worker, bool& outStolen);
+
+		NOUS_Job* TakeJob(uint32 priority, uint64& randomState, Worker* worker, bool& outStolen);
+		NOUS_Job* PopInjectedJob(uint32 priority);
+		NOUS_Job* StealJob(uint32 priority, uint64& randomState, Worker* self);
+		NOUS_Job* StealJobFrom(uint32 priority, uint64 randomValue, Worker* self, Worker* const* victims, uint64 victimCount);
+
+		bool TryAcquireBackgroundSlot();
+		void ReleaseBackgroundSlot();
+
+		/// @return true if a sleeping worker would find something to run.
+		bool HasRunnableJobs() const;
+
+		/// @brief Spins, then yields, waiting for runnable jobs before the worker parks.
+		/// @return true if jobs showed up.
+		bool SpinForJobs(Worker* worker);
+
+		/// @brief Sleeps until WakeWorker() picks this worker, unless jobs show up while it registers.
+		void ParkWorker(Worker* worker);
+
+		/// @brief Unparks one worker, unless one is already spinning and will find the job itself.
+		void WakeWorker();
+		void WakeAllWorkers();
+		void UnparkWorker(Worker* worker);
+
+		/// @param worker: nullptr when the job runs on a thread outside the pool.
+		/// @param stolen: Reported to NOUS_JobProfiler.
+		void ExecuteJob(Worker* worker, NOUS_Job* job, bool stolen);
+
+		std::vector<Worker*>		mWorkers;
 		std::vector<NOUS_Thread*>	mThreads;
 
-		std::mutex					mMutex;
-		std::condition_variable		mConditionVar;
+		// External submitters only, workers use their own deques
+		nous::deque<NOUS_Job*, MemoryManager::MemoryTag::JOB>	mInjectionQueues[c_PRIORITY_COUNT];
+		mutable std::mutex			mInjectionMutex;
+
+		// Jobs queued anywhere, lets idle workers skip empty priorities and decide to sleep without scanning every queue
+		std::atomic<uint64>			mQueuedJobs;
+		std::atomic<uint64>			mQueuedPriorityJobs[c_PRIORITY_COUNT];
+
+		// Workers currently holding a background job (nested ones included)
+		std::atomic<uint32>			mActiveBackgroundWorkers;
+		std::atomic<uint32>			mMaxBackgroundWorkers;
+
+		// Parked workers, the last one parked is woken first (its caches are the warmest). Submitters only lock it when someone is parked
+		std::mutex					mParkMutex;
+		std::vector<Worker*>		mParkedWorkers;
+		std::atomic<uint32>			mSleepingWorkers;
+
+		// Spinning only pays off on a core of its own, and a few spinners are enough to catch a burst
+		std::atomic<uint32>			mSpinningWorkers;
+		std::atomic<uint32>			mMaxSpinningWorkers;
+
+		std::atomic<uint64>			mWakeups;
+
 		std::atomic<bool>			mShutdown;
+		bool						mPinWorkers;
+
+		NOUS_JobPool*				mJobPool;
 
 	};
-}
\ No newline at end of file
+}
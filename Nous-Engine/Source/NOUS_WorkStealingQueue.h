@@ -0,0 +1,236 @@
+#pragma once
+
+#include "Globals.h"
+#include "MemoryManager.h"
+
+#include <atomic>
+#include <type_traits>
+
+namespace NOUS_Multithreading
+{
+	///////////////////////////////////////////////////////////////////////////
+	/// @brief Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli, PPoPP'13 memory orderings).
+	/// The owner thread pushes and pops at the bottom (LIFO, cache-warm), any other thread steals from
+	/// the top (FIFO). Only a steal racing the owner for the last element pays for a CAS.
+	/// The ring doubles when full; replaced rings are kept until destruction since a thief may still
+	/// be reading from one.
+	///////////////////////////////////////////////////////////////////////////
+	template<typename T>
+	class NOUS_WorkStealingQueue
+	{
+		static_assert(std::is_pointer_v<T>, "NOUS_WorkStealingQueue stores pointers, nullptr means empty.");
+
+	public:
+
+		/// @brief NOUS_WorkStealingQueue constructor.
+		/// @param capacity: Initial ring size, rounded up to a power of two.
+		explicit NOUS_WorkStealingQueue(uint64 capacity = 256);
+
+		/// @brief NOUS_WorkStealingQueue destructor.
+		/// @note Elements still queued are not destroyed, drain the queue first.
+		~NOUS_WorkStealingQueue();
+
+		/// @brief Owner only. Adds an element at the bottom, growing the ring if needed.
+		void Push(T item);
+
+		/// @brief Owner only. Takes the most recently pushed element.
+		/// @return nullptr if the queue is empty.
+		T Pop();
+
+		/// @brief Any thread. Takes the oldest element.
+		/// @return nullptr if the queue is empty or another thread won the race for the element.
+		T Steal();
+
+		/// @return Approximate element count, exact only when called from the owner with no thieves around.
+		uint64 GetSize() const;
+
+		bool IsEmpty() const;
+
+		/// @brief NOUS_WorkStealingQueue delete copy operators.
+		NOUS_WorkStealingQueue(const NOUS_WorkStealingQueue&) = delete;
+		NOUS_WorkStealingQueue& operator=(const NOUS_WorkStealingQueue&) = delete;
+
+	private:
+
+		struct Ring
+		{
+			int64				capacity;
+			int64				mask;
+			Ring*				previous;	// Replaced ring, released with the queue
+			std::atomic<T>*		slots;
+
+			T Load(int64 index) const { return slots[index & mask].load(std::memory_order_relaxed); }
+			void Store(int64 index, T item) { slots[index & mask].store(item, std::memory_order_relaxed); }
+		};
+
+		static Ring* CreateRing(int64 capacity);
+		static void DestroyRing(Ring* ring);
+
+		Ring* Grow(Ring* ring, int64 bottom, int64 top);
+
+		// Thieves write mTop and the owner writes mBottom, keep them on separate cache lines
+		alignas(MemoryManager::c_CACHE_LINE_SIZE) std::atomic<int64>	mTop;
+		alignas(MemoryManager::c_CACHE_LINE_SIZE) std::atomic<int64>	mBottom;
+		alignas(MemoryManager::c_CACHE_LINE_SIZE) std::atomic<Ring*>	mRing;
+	};
+
+	template<typename T>
+	inline NOUS_WorkStealingQueue<T>::NOUS_WorkStealingQueue(uint64 capacity) :
+		mTop(0), mBottom(0)
+	{
+		int64 ringCapacity = 1;
+
+		while (ringCapacity < static_cast<int64>(capacity))
+		{
+			ringCapacity <<= 1;
+		}
+
+		mRing.store(CreateRing(ringCapacity), std::memory_order_relaxed);
+	}
+
+	template<typename T>
+	inline NOUS_WorkStealingQueue<T>::~NOUS_WorkStealingQueue()
+	{
+		Ring* ring = mRing.load(std::memory_order_relaxed);
+
+		while (ring)
+		{
+			Ring* previous = ring->previous;
+			DestroyRing(ring);
+			ring = previous;
+		}
+	}
+
+	template<typename T>
+	inline void NOUS_WorkStealingQueue<T>::Push(T item)
+	{
+		const int64 bottom = mBottom.load(std::memory_order_relaxed);
+		const int64 top = mTop.load(std::memory_order_acquire);
+
+		Ring* ring = mRing.load(std::memory_order_relaxed);
+
+		if (bottom - top > ring->capacity - 1)
+		{
+			ring = Grow(ring, bottom, top);
+		}
+
+		ring->Store(bottom, item);
+
+		// Release store rather than the paper's fence + relaxed store: same cost on x86, and visible to TSan
+		mBottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	template<typename T>
+	inline T NOUS_WorkStealingQueue<T>::Pop()
+	{
+		const int64 bottom = mBottom.load(std::memory_order_relaxed) - 1;
+		Ring* ring = mRing.load(std::memory_order_relaxed);
+
+		mBottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		int64 top = mTop.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			// Empty, restore the bottom
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T item = ring->Load(bottom);
+
+		if (top == bottom)
+		{
+			// Last element, thieves may be after it too
+			if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				item = nullptr;
+			}
+
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		return item;
+	}
+
+	template<typename T>
+	inline T NOUS_WorkStealingQueue<T>::Steal()
+	{
+		int64 top = mTop.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64 bottom = mBottom.load(std::memory_order_acquire);
+
+		if (top >= bottom) return nullptr;
+
+		Ring* ring = mRing.load(std::memory_order_acquire);
+		T item = ring->Load(top);
+
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+
+		return item;
+	}
+
+	template<typename T>
+	inline uint64 NOUS_WorkStealingQueue<T>::GetSize() const
+	{
+		const int64 bottom = mBottom.load(std::memory_order_relaxed);
+		const int64 top = mTop.load(std::memory_order_relaxed);
+
+		return (bottom > top) ? static_cast<uint64>(bottom - top) : 0;
+	}
+
+	template<typename T>
+	inline bool NOUS_WorkStealingQueue<T>::IsEmpty() const
+	{
+		return GetSize() == 0;
+	}
+
+	template<typename T>
+	inline typename NOUS_WorkStealingQueue<T>::Ring* NOUS_WorkStealingQueue<T>::CreateRing(int64 capacity)
+	{
+		Ring* ring = NOUS_NEW<Ring>(MemoryManager::MemoryTag::JOB);
+
+		ring->capacity = capacity;
+		ring->mask = capacity - 1;
+		ring->previous = nullptr;
+		ring->slots = static_cast<std::atomic<T>*>(MemoryManager::Allocate(sizeof(std::atomic<T>) * capacity, MemoryManager::MemoryTag::JOB));
+
+		// Nothing is published yet, a failed Grow() leaves the queue as it was
+		if (ring->slots == nullptr)
+		{
+			NOUS_DELETE<Ring>(ring, MemoryManager::MemoryTag::JOB);
+
+			NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__);
+			throw std::bad_alloc();
+		}
+
+		return ring;
+	}
+
+	template<typename T>
+	inline void NOUS_WorkStealingQueue<T>::DestroyRing(Ring* ring)
+	{
+		MemoryManager::Free(ring->slots, sizeof(std::atomic<T>) * ring->capacity, MemoryManager::MemoryTag::JOB);
+		NOUS_DELETE<Ring>(ring, MemoryManager::MemoryTag::JOB);
+	}
+
+	template<typename T>
+	inline typename NOUS_WorkStealingQueue<T>::Ring* NOUS_WorkStealingQueue<T>::Grow(Ring* ring, int64 bottom, int64 top)
+	{
+		Ring* grown = CreateRing(ring->capacity * 2);
+
+		for (int64 i = top; i < bottom; ++i)
+		{
+			grown->Store(i, ring->Load(i));
+		}
+
+		grown->previous = ring;
+		mRing.store(grown, std::memory_order_release);
+
+		return grown;
+	}
+}
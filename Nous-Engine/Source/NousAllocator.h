@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Globals.h"
+#include "MemoryManager.h"
+#include "FrameAllocator.h"
+
+#include <vector>
+#include <deque>
+#include <queue>
+#include <unordered_map>
+#include <functional>
+#include <new>
+
+// STL allocator adapter, lets std containers allocate through the engine instead of global operator new.
+// By default blocks come from the MemoryManager under Tag, so they land in the tag's arena and show up in
+// the memory telemetry. Constructed with a FrameAllocator, blocks come from the current frame buffer instead:
+// deallocate() is a no-op and the container must not outlive the frame(s) the FrameAllocator keeps alive.
+
+template<typename T, MemoryManager::MemoryTag Tag = MemoryManager::MemoryTag::UNKNOWN>
+class NousAllocator
+{
+public:
+
+    using value_type = T;
+
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = NousAllocator<U, Tag>;
+    };
+
+    NousAllocator() noexcept : frameAllocator(nullptr) {}
+    explicit NousAllocator(FrameAllocator* frameAllocator) noexcept : frameAllocator(frameAllocator) {}
+
+    template<typename U>
+    NousAllocator(const NousAllocator<U, Tag>& other) noexcept : frameAllocator(other.GetFrameAllocator()) {}
+
+    T* allocate(size_t count);
+    void deallocate(T* ptr, size_t count) noexcept;
+
+    FrameAllocator* GetFrameAllocator() const noexcept { return frameAllocator; }
+
+    template<typename U>
+    bool operator==(const NousAllocator<U, Tag>& other) const noexcept { return frameAllocator == other.GetFrameAllocator(); }
+
+private:
+
+    FrameAllocator* frameAllocator;
+};
+
+template<typename T, MemoryManager::MemoryTag Tag>
+inline T* NousAllocator<T, Tag>::allocate(size_t count)
+{
+    // Containers construct their elements themselves, zeroing the block would be wasted work
+    void* block = frameAllocator ?
+        frameAllocator->Allocate(sizeof(T) * count, alignof(T)) :
+        MemoryManager::AllocateAligned(sizeof(T) * count, alignof(T), Tag, MemoryManager::AllocationFlags::UNINITIALIZED);
+
+    if (block == nullptr)
+    {
+        NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__);
+        throw std::bad_alloc(); // Containers expect allocation failures to throw
+    }
+
+    return static_cast<T*>(block);
+}
+
+template<typename T, MemoryManager::MemoryTag Tag>
+inline void NousAllocator<T, Tag>::deallocate(T* ptr, size_t count) noexcept
+{
+    // Frame memory is released all at once when the frame buffer is reused
+    if (frameAllocator || ptr == nullptr) return;
+
+    MemoryManager::FreeAligned(ptr, sizeof(T) * count, alignof(T), Tag);
+}
+
+// Containers using NousAllocator, e.g. nous::vector<Vertex3D, MemoryManager::MemoryTag::RESOURCE_MESH>.
+namespace nous
+{
+    template<typename T, MemoryManager::MemoryTag Tag = MemoryManager::MemoryTag::ARRAY>
+    using vector = std::vector<T, NousAllocator<T, Tag>>;
+
+    template<typename T, MemoryManager::MemoryTag Tag = MemoryManager::MemoryTag::RING_QUEUE>
+    using deque = std::deque<T, NousAllocator<T, Tag>>;
+
+    template<typename T, MemoryManager::MemoryTag Tag = MemoryManager::MemoryTag::RING_QUEUE>
+    using queue = std::queue<T, nous::deque<T, Tag>>;
+
+    template<typename Key, typename Value, MemoryManager::MemoryTag Tag = MemoryManager::MemoryTag::DICT,
+        typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    using unordered_map = std::unordered_map<Key, Value, Hash, KeyEqual, NousAllocator<std::pair<const Key, Value>, Tag>>;
+}
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "Globals.h"
+#include "MemoryManager.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <mutex>
+
+#define POOL_DEFAULT_SLOTS_PER_CHUNK 64
+#define POOL_MAX_CHUNKS 1024
+
+// Fixed-size object pool for hot, uniformly sized engine objects.
+// Slots are carved out of chunks requested to the MemoryManager under the pool's tag, and free
+// slots are chained through a list of slot indices stored in an array after each chunk's slots.
+// With LockFree = true the free list is a tagged Treiber stack, so any thread can allocate and free
+// without locking; only growing the pool by a new chunk takes a mutex. Chunks are kept until the
+// pool is destroyed.
+// The links live outside the slots and are read and written atomically: a thread popping a stale head
+// can still read the link of a slot another thread already took and is constructing into (its CAS then
+// fails on the tag), without touching the object itself.
+
+template<typename T, bool LockFree = false>
+class PoolAllocator
+{
+public:
+
+    PoolAllocator(uint32 slotsPerChunk = POOL_DEFAULT_SLOTS_PER_CHUNK,
+        MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::POOL_ALLOCATOR);
+
+    ~PoolAllocator();
+
+    // Constructs a T inside a free slot. Asserts if the pool can't grow anymore (POOL_MAX_CHUNKS reached or
+    // out of memory), callers don't check for a null object.
+    template<typename... Args>
+    T* New(Args&&... args);
+
+    // Destructs a T created with New() and returns its slot to the pool.
+    void Delete(T*& ptr);
+
+    // Raw slot access, no construction involved. Allocate() returns nullptr if the pool can't grow.
+    void* Allocate();
+    void Free(void* slot);
+
+    uint64 GetLiveCount() const;
+    uint64 GetCapacity() const;
+    uint64 GetChunkCount() const;
+
+    // Disable copy/move to prevent accidental misuse
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+    PoolAllocator(PoolAllocator&&) = delete;
+    PoolAllocator& operator=(PoolAllocator&&) = delete;
+
+private:
+
+    // Head of the free list: slot index + 1 in the low 32 bits (0 = empty), ABA tag in the high 32 bits.
+    static constexpr uint64 c_INDEX_MASK = 0xFFFFFFFFULL;
+
+    static constexpr uint64 c_SLOT_ALIGNMENT = alignof(T) > alignof(uint32) ? alignof(T) : alignof(uint32);
+    static constexpr uint64 c_SLOT_SIZE = (sizeof(T) + c_SLOT_ALIGNMENT - 1) & ~(c_SLOT_ALIGNMENT - 1);
+
+    // Slots first, then one uint32 link per slot
+    uint64 GetSlotsBytes() const;
+    uint64 GetChunkBytes() const;
+
+    char* GetSlot(uint32 index) const;
+    std::atomic_ref<uint32> NextOf(uint32 index) const;
+
+    bool Grow(uint64 observedChunks);
+
+    void PushFree(uint32 first, uint32 last);
+
+    uint32 slotsPerChunk;
+    uint32 slotsPerChunkLog2;
+    MemoryManager::MemoryTag tag;
+
+    std::atomic<uint64> freeHead;
+    std::atomic<uint64> chunkCount;
+    std::atomic<uint64> liveCount;
+
+    char* chunks[POOL_MAX_CHUNKS];
+
+    std::mutex growMutex;
+};
+
+template<typename T, bool LockFree>
+inline PoolAllocator<T, LockFree>::PoolAllocator(uint32 slotsPerChunk, MemoryManager::MemoryTag tag)
+    : slotsPerChunk(1), slotsPerChunkLog2(0), tag(tag), freeHead(0), chunkCount(0), liveCount(0), chunks()
+{
+    // Power of two chunks turn the slot lookup into a shift and a mask
+    while (this->slotsPerChunk < slotsPerChunk)
+    {
+        this->slotsPerChunk <<= 1;
+        this->slotsPerChunkLog2++;
+    }
+}
+
+template<typename T, bool LockFree>
+inline PoolAllocator<T, LockFree>::~PoolAllocator()
+{
+    if (liveCount.load() > 0)
+    {
+        NOUS_WARN("PoolAllocator destroyed with %" PRIu64 " live objects.", liveCount.load());
+    }
+
+    const uint64 count = chunkCount.load();
+
+    for (uint64 i = 0; i < count; ++i)
+    {
+        MemoryManager::FreeAligned(chunks[i], GetChunkBytes(), c_SLOT_ALIGNMENT, tag);
+        chunks[i] = nullptr;
+    }
+
+    chunkCount = 0;
+    freeHead = 0;
+}
+
+template<typename T, bool LockFree>
+template<typename... Args>
+inline T* PoolAllocator<T, LockFree>::New(Args&&... args)
+{
+    void* slot = Allocate();
+
+    NOUS_ASSERT_MSG(slot != nullptr, "PoolAllocator::New() - Pool exhausted");
+
+    return new(slot) T(std::forward<Args>(args)...);
+}
+
+template<typename T, bool LockFree>
+inline void PoolAllocator<T, LockFree>::Delete(T*& ptr)
+{
+    if (ptr != nullptr)
+    {
+        ptr->~T();
+        Free(ptr);
+        ptr = nullptr;
+    }
+}
+
+template<typename T, bool LockFree>
+inline void* PoolAllocator<T, LockFree>::Allocate()
+{
+    while (true)
+    {
+        uint64 head = freeHead.load(LockFree ? std::memory_order_acquire : std::memory_order_relaxed);
+
+        if ((head & c_INDEX_MASK) == 0)
+        {
+            // Pool exhausted, add a chunk (or wait for the thread that is already adding one)
+            if (!Grow(chunkCount.load(std::memory_order_acquire))) return nullptr;
+            continue;
+        }
+
+        const uint32 index = static_cast<uint32>(head & c_INDEX_MASK) - 1;
+        const uint64 next = (head & ~c_INDEX_MASK) + (1ULL << 32) + NextOf(index).load(std::memory_order_relaxed);
+
+        if constexpr (LockFree)
+        {
+            if (!freeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_relaxed)) continue;
+        }
+        else
+        {
+            freeHead.store(next, std::memory_order_relaxed);
+        }
+
+        liveCount.fetch_add(1, std::memory_order_relaxed);
+
+        return GetSlot(index);
+    }
+}
+
+template<typename T, bool LockFree>
+inline void PoolAllocator<T, LockFree>::Free(void* slot)
+{
+    if (!slot) return;
+
+    // Find the chunk owning the slot
+    const uint64 count = chunkCount.load(std::memory_order_acquire);
+    const uint64 slotsBytes = GetSlotsBytes();
+    char* address = static_cast<char*>(slot);
+
+    for (uint64 i = 0; i < count; ++i)
+    {
+        if (address >= chunks[i] && address < chunks[i] + slotsBytes)
+        {
+            const uint32 index = static_cast<uint32>((i << slotsPerChunkLog2) + (address - chunks[i]) / c_SLOT_SIZE);
+
+            liveCount.fetch_sub(1, std::memory_order_relaxed);
+            PushFree(index, index);
+
+            return;
+        }
+    }
+
+    NOUS_ERROR("PoolAllocator::Free() ERROR: Slot doesn't belong to this pool");
+}
+
+template<typename T, bool LockFree>
+inline uint64 PoolAllocator<T, LockFree>::GetLiveCount() const
+{
+    return liveCount.load(std::memory_order_relaxed);
+}
+
+template<typename T, bool LockFree>
+inline uint64 PoolAllocator<T, LockFree>::GetCapacity() const
+{
+    return chunkCount.load(std::memory_order_relaxed) * slotsPerChunk;
+}
+
+template<typename T, bool LockFree>
+inline uint64 PoolAllocator<T, LockFree>::GetChunkCount() const
+{
+    return chunkCount.load(std::memory_order_relaxed);
+}
+
+template<typename T, bool LockFree>
+inline char* PoolAllocator<T, LockFree>::GetSlot(uint32 index) const
+{
+    return chunks[index >> slotsPerChunkLog2] + (index & (slotsPerChunk - 1)) * c_SLOT_SIZE;
+}
+
+template<typename T, bool LockFree>
+inline uint64 PoolAllocator<T, LockFree>::GetSlotsBytes() const
+{
+    // Slot sizes are multiples of an alignment of at least 4, so the links that follow stay aligned
+    return c_SLOT_SIZE * slotsPerChunk;
+}
+
+template<typename T, bool LockFree>
+inline uint64 PoolAllocator<T, LockFree>::GetChunkBytes() const
+{
+    return GetSlotsBytes() + sizeof(uint32) * slotsPerChunk;
+}
+
+template<typename T, bool LockFree>
+inline std::atomic_ref<uint32> PoolAllocator<T, LockFree>::NextOf(uint32 index) const
+{
+    uint32* links = reinterpret_cast<uint32*>(chunks[index >> slotsPerChunkLog2] + GetSlotsBytes());
+
+    return std::atomic_ref<uint32>(links[index & (slotsPerChunk - 1)]);
+}
+
+template<typename T, bool LockFree>
+inline bool PoolAllocator<T, LockFree>::Grow(uint64 observedChunks)
+{
+    std::lock_guard<std::mutex> lock(growMutex);
+
+    // Another thread already grew the pool while we were waiting
+    if (chunkCount.load(std::memory_order_acquire) != observedChunks) return true;
+
+    if (observedChunks >= POOL_MAX_CHUNKS)
+    {
+        NOUS_ERROR("PoolAllocator::Grow() - Reached the maximum of %d chunks", POOL_MAX_CHUNKS);
+        return false;
+    }
+
+    char* chunk = static_cast<char*>(MemoryManager::AllocateAligned(GetChunkBytes(), c_SLOT_ALIGNMENT, tag));
+
+    if (!chunk) return false;
+
+    chunks[observedChunks] = chunk;
+
+    // Chain the new slots together before publishing them
+    const uint32 first = static_cast<uint32>(observedChunks << slotsPerChunkLog2);
+    const uint32 last = first + slotsPerChunk - 1;
+
+    for (uint32 i = first; i < last; ++i)
+    {
+        NextOf(i).store(i + 2, std::memory_order_relaxed); // Stored as index + 1
+    }
+
+    chunkCount.store(observedChunks + 1, std::memory_order_release);
+
+    PushFree(first, last);
+
+    return true;
+}
+
+template<typename T, bool LockFree>
+inline void PoolAllocator<T, LockFree>::PushFree(uint32 first, uint32 last)
+{
+    uint64 head = freeHead.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        NextOf(last).store(static_cast<uint32>(head & c_INDEX_MASK), std::memory_order_relaxed);
+
+        const uint64 next = (head & ~c_INDEX_MASK) + (1ULL << 32) + (first + 1);
+
+        if constexpr (LockFree)
+        {
+            if (freeHead.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed)) return;
+        }
+        else
+        {
+            freeHead.store(next, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
@@ -0,0 +1,411 @@
+#include "RelocatableHeap.h"
+
+#include "VirtualMemory.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+// Pages are committed in steps of this size, and kept committed this far above the top after a pass.
+static const uint64 c_COMMIT_STEP = MiB(1);
+
+RelocatableHeap::RelocatableHeap(uint64 capacity, uint32 maxHandles, MemoryManager::MemoryTag tag)
+    : tag(tag), memory(nullptr), capacity(0), committed(0), top(0), liveSize(0),
+    handles(nullptr), maxHandles(0), handleCount(0), freeHandle(0), liveHandles(0),
+    compacting(false), dirty(false), scan(0), dest(0), holeBytes(0)
+{
+    NOUS_ASSERT_MSG(maxHandles > 0, "RelocatableHeap - Invalid handle count.");
+
+    this->capacity = VirtualMemory::AlignToPage(capacity);
+    memory = static_cast<uint8*>(VirtualMemory::Reserve(this->capacity));
+
+    handles = static_cast<HandleEntry*>(MemoryManager::Allocate(sizeof(HandleEntry) * maxHandles, tag));
+
+    if (memory == nullptr || handles == nullptr)
+    {
+        NOUS_ERROR("%s() - Allocation Failure", __FUNCTION__);
+        throw std::bad_alloc(); // Handle allocation failure
+    }
+
+    this->maxHandles = maxHandles;
+}
+
+RelocatableHeap::~RelocatableHeap()
+{
+    if (liveHandles > 0)
+    {
+        NOUS_WARN("RelocatableHeap destroyed with %u live blocks (%" PRIu64 " bytes)", liveHandles, liveSize);
+
+        // Holes and gaps keep the block chain walkable, live blocks are the ones still owned by a handle
+        for (uint64 offset = 0; offset < top; offset += GetHeader(offset)->size)
+        {
+            if (GetHeader(offset)->handleIndex != 0)
+            {
+                MemoryManager::TrackExternalFree(GetHeader(offset)->size, tag);
+            }
+        }
+    }
+
+    if (memory)
+    {
+        MemoryManager::TrackExternalDecommit(committed);
+
+        VirtualMemory::Release(memory, capacity);
+        memory = nullptr;
+    }
+
+    if (handles)
+    {
+        MemoryManager::Free(handles, sizeof(HandleEntry) * maxHandles, tag);
+        handles = nullptr;
+    }
+}
+
+RelocatableHandle RelocatableHeap::Allocate(uint64 size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    RelocatableHandle handle;
+
+    const uint64 blockSize = (size + sizeof(BlockHeader) + (c_BLOCK_ALIGNMENT - 1)) & ~(c_BLOCK_ALIGNMENT - 1);
+
+    if (freeHandle == 0 && handleCount == maxHandles)
+    {
+        NOUS_ERROR("RelocatableHeap::Allocate() - Out of handles (%u)", maxHandles);
+        return handle;
+    }
+
+    // Out of room at the top, reclaim every hole before giving up
+    if (top + blockSize > capacity && holeBytes > 0)
+    {
+        while (compacting)
+        {
+            CompactStep(UINT64_MAX, UINT32_MAX);
+        }
+
+        dirty = true;
+
+        do
+        {
+            CompactStep(UINT64_MAX, UINT32_MAX);
+        } while (compacting);
+    }
+
+    if (top + blockSize > capacity || !EnsureCommitted(top + blockSize))
+    {
+        NOUS_ERROR("RelocatableHeap::Allocate() - Out of memory allocating %" PRIu64 " bytes (%" PRIu64 "/%" PRIu64 " used)", size, top, capacity);
+        return handle;
+    }
+
+    if (!MemoryManager::TrackExternalAllocation(blockSize, tag))
+    {
+        return handle;
+    }
+
+    uint32 slot = 0;
+
+    if (freeHandle != 0)
+    {
+        slot = freeHandle - 1;
+        freeHandle = handles[slot].nextFree;
+    }
+    else
+    {
+        slot = handleCount++;
+    }
+
+    HandleEntry& entry = handles[slot];
+    entry.offset = top;
+    entry.pinCount = 0;
+    entry.nextFree = 0;
+
+    BlockHeader* header = GetHeader(top);
+    header->handleIndex = slot + 1;
+    header->size = blockSize;
+
+    top += blockSize;
+    liveSize += blockSize;
+    liveHandles++;
+
+    handle.index = slot + 1;
+    handle.generation = entry.generation;
+
+    return handle;
+}
+
+void RelocatableHeap::Free(RelocatableHandle& handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    HandleEntry* entry = GetEntry(handle);
+
+    if (entry == nullptr)
+    {
+        NOUS_WARN("RelocatableHeap::Free() - Stale or invalid handle");
+        handle = RelocatableHandle();
+        return;
+    }
+
+    NOUS_ASSERT_MSG(entry->pinCount == 0, "RelocatableHeap::Free() - Freeing a pinned block.");
+
+    BlockHeader* header = GetHeader(entry->offset);
+    const uint64 blockSize = header->size;
+
+    header->handleIndex = 0;
+
+    liveSize -= blockSize;
+    liveHandles--;
+
+    MemoryManager::TrackExternalFree(blockSize, tag);
+
+    // Last block, give the space back right away. During a pass the top is only moved by FinishPass()
+    if (!compacting && entry->offset + blockSize == top)
+    {
+        top = entry->offset;
+    }
+    else
+    {
+        holeBytes += blockSize;
+        dirty = true;
+    }
+
+    entry->generation++;
+    entry->nextFree = freeHandle;
+    freeHandle = handle.index;
+
+    handle = RelocatableHandle();
+}
+
+void* RelocatableHeap::Resolve(RelocatableHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    HandleEntry* entry = GetEntry(handle);
+
+    return entry ? memory + entry->offset + sizeof(BlockHeader) : nullptr;
+}
+
+void* RelocatableHeap::Pin(RelocatableHandle handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    HandleEntry* entry = GetEntry(handle);
+
+    if (entry == nullptr) return nullptr;
+
+    entry->pinCount++;
+
+    return memory + entry->offset + sizeof(BlockHeader);
+}
+
+void RelocatableHeap::Unpin(RelocatableHandle handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    HandleEntry* entry = GetEntry(handle);
+
+    if (entry == nullptr || entry->pinCount == 0)
+    {
+        NOUS_WARN("RelocatableHeap::Unpin() - Block isn't pinned");
+        return;
+    }
+
+    // The holes left behind the block by previous passes can be reclaimed now
+    if (--entry->pinCount == 0 && holeBytes > 0)
+    {
+        dirty = true;
+    }
+}
+
+bool RelocatableHeap::IsPinned(RelocatableHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    HandleEntry* entry = GetEntry(handle);
+
+    return entry != nullptr && entry->pinCount > 0;
+}
+
+uint64 RelocatableHeap::GetSize(RelocatableHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    HandleEntry* entry = GetEntry(handle);
+
+    return entry ? GetHeader(entry->offset)->size - sizeof(BlockHeader) : 0;
+}
+
+uint64 RelocatableHeap::Compact(uint64 maxBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return CompactStep(maxBytes, c_MAX_BLOCKS_PER_STEP);
+}
+
+uint64 RelocatableHeap::GetCapacity() const
+{
+    return capacity;
+}
+
+uint64 RelocatableHeap::GetCommittedSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return committed;
+}
+
+uint64 RelocatableHeap::GetUsedSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return top;
+}
+
+uint64 RelocatableHeap::GetLiveSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return liveSize;
+}
+
+uint32 RelocatableHeap::GetLiveHandleCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return liveHandles;
+}
+
+float RelocatableHeap::GetFragmentation() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return (top > 0) ? static_cast<float>(top - liveSize) / static_cast<float>(top) : 0.0f;
+}
+
+RelocatableHeap::BlockHeader* RelocatableHeap::GetHeader(uint64 offset) const
+{
+    return reinterpret_cast<BlockHeader*>(memory + offset);
+}
+
+RelocatableHeap::HandleEntry* RelocatableHeap::GetEntry(RelocatableHandle handle) const
+{
+    if (handle.index == 0 || handle.index > handleCount) return nullptr;
+
+    HandleEntry* entry = &handles[handle.index - 1];
+
+    return (entry->generation == handle.generation) ? entry : nullptr;
+}
+
+bool RelocatableHeap::EnsureCommitted(uint64 end)
+{
+    if (end <= committed) return true;
+
+    uint64 newCommitted = std::min(std::max(VirtualMemory::AlignToPage(end), committed + c_COMMIT_STEP), capacity);
+
+    if (!VirtualMemory::Commit(memory + committed, newCommitted - committed))
+    {
+        return false;
+    }
+
+    MemoryManager::TrackExternalCommit(newCommitted - committed);
+
+    committed = newCommitted;
+
+    return true;
+}
+
+void RelocatableHeap::TrimCommitted()
+{
+    const uint64 keep = std::min(VirtualMemory::AlignToPage(top) + c_COMMIT_STEP, capacity);
+
+    if (committed > keep && VirtualMemory::Decommit(memory + keep, committed - keep))
+    {
+        MemoryManager::TrackExternalDecommit(committed - keep);
+
+        committed = keep;
+    }
+}
+
+uint64 RelocatableHeap::CompactStep(uint64 maxBytes, uint32 maxBlocks)
+{
+    if (!compacting)
+    {
+        if (!dirty || holeBytes == 0) return 0;
+
+        compacting = true;
+        dirty = false;
+        scan = 0;
+        dest = 0;
+    }
+
+    uint64 movedBytes = 0;
+    uint32 visitedBlocks = 0;
+
+    while (scan < top && visitedBlocks < maxBlocks)
+    {
+        BlockHeader* header = GetHeader(scan);
+        const uint64 blockSize = header->size;
+
+        if (header->handleIndex == 0)
+        {
+            scan += blockSize;
+        }
+        else
+        {
+            HandleEntry& entry = handles[header->handleIndex - 1];
+
+            if (entry.pinCount > 0)
+            {
+                // Pinned blocks stay put, the gap below them waits for a later pass
+                if (dest < scan)
+                {
+                    BlockHeader* gap = GetHeader(dest);
+                    gap->handleIndex = 0;
+                    gap->size = scan - dest;
+                }
+
+                dest = scan + blockSize;
+            }
+            else if (dest < scan)
+            {
+                // Always move at least one block, even one larger than the budget, so the pass progresses
+                if (movedBytes > 0 && movedBytes + blockSize > maxBytes) break;
+
+                std::memmove(memory + dest, memory + scan, blockSize);
+                entry.offset = dest;
+
+                movedBytes += blockSize;
+                dest += blockSize;
+            }
+            else
+            {
+                dest += blockSize;
+            }
+
+            scan += blockSize;
+        }
+
+        visitedBlocks++;
+    }
+
+    if (scan >= top)
+    {
+        FinishPass();
+    }
+    else if (dest < scan)
+    {
+        // Keep the block chain walkable until the pass resumes
+        BlockHeader* gap = GetHeader(dest);
+        gap->handleIndex = 0;
+        gap->size = scan - dest;
+    }
+
+    return movedBytes;
+}
+
+void RelocatableHeap::FinishPass()
+{
+    top = dest;
+    holeBytes = top - liveSize;
+
+    compacting = false;
+    scan = 0;
+    dest = 0;
+
+    TrimCommitted();
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Globals.h"
+#include "MemoryManager.h"
+
+#include <mutex>
+
+#define RELOCATABLE_DEFAULT_MAX_HANDLES 65536
+
+// Opt-in heap whose blocks can be moved, meant for large, long-lived payloads (e.g. mesh vertex data).
+// Blocks are referenced through handles instead of pointers: a handle indexes a table holding the
+// block's current offset, plus a generation so stale handles are detected after a Free().
+// Allocation bumps the top of a reserved address range, frees only leave holes, and Compact() slides
+// live blocks down over the holes a bounded number of bytes at a time, so it can run every frame.
+// A full pass is forced when an allocation doesn't fit, which is why this heap never fragments to
+// the point of failing while enough free space is left.
+// Pointers returned by Resolve() are only valid until the next Compact(); Pin() a block to keep its
+// address while it's used (e.g. during a GPU upload). Pinned blocks are never moved.
+// Live blocks are accounted under the heap's tag (and count towards its budget), committed pages are reported
+// to the MemoryManager as memory committed outside the arenas.
+
+struct RelocatableHandle
+{
+    uint32 index = 0;       // Handle table slot + 1, 0 = invalid
+    uint32 generation = 0;
+
+    bool IsValid() const { return index != 0; }
+};
+
+class RelocatableHeap
+{
+public:
+
+    // Reserves capacity bytes of address space, pages are committed as the heap grows.
+    RelocatableHeap(uint64 capacity, uint32 maxHandles = RELOCATABLE_DEFAULT_MAX_HANDLES,
+        MemoryManager::MemoryTag tag = MemoryManager::MemoryTag::ARRAY);
+
+    ~RelocatableHeap();
+
+    // Returns an invalid handle if the heap is full even after compacting it.
+    RelocatableHandle Allocate(uint64 size);
+
+    // Invalidates the handle and leaves a hole for Compact() to reclaim.
+    void Free(RelocatableHandle& handle);
+
+    // Current address of the block, nullptr for stale handles.
+    void* Resolve(RelocatableHandle handle) const;
+
+    // Resolves and pins the block, it won't move until every Pin() is matched by an Unpin().
+    void* Pin(RelocatableHandle handle);
+    void Unpin(RelocatableHandle handle);
+    bool IsPinned(RelocatableHandle handle) const;
+
+    uint64 GetSize(RelocatableHandle handle) const;
+
+    /**
+     * @brief Slides live blocks down over the holes left by Free().
+     * @param maxBytes: Budget of bytes moved, the pass resumes where it stopped on the next call.
+     * @return Bytes moved.
+     */
+    uint64 Compact(uint64 maxBytes);
+
+    uint64 GetCapacity() const;
+    uint64 GetCommittedSize() const;
+    uint64 GetUsedSize() const;         // Top of the heap, live blocks plus holes
+    uint64 GetLiveSize() const;
+    uint32 GetLiveHandleCount() const;
+
+    // Share of the used space lost to holes, 0 when fully compacted.
+    float GetFragmentation() const;
+
+    // Disable copy/move to prevent accidental misuse
+    RelocatableHeap(const RelocatableHeap&) = delete;
+    RelocatableHeap& operator=(const RelocatableHeap&) = delete;
+    RelocatableHeap(RelocatableHeap&&) = delete;
+    RelocatableHeap& operator=(RelocatableHeap&&) = delete;
+
+private:
+
+    struct BlockHeader
+    {
+        uint32 handleIndex;     // Handle table slot + 1, 0 = hole
+        uint32 padding;
+        uint64 size;            // Header included
+    };
+
+    struct HandleEntry
+    {
+        uint64 offset;          // Of the block header
+        uint32 generation;
+        uint32 pinCount;
+        uint32 nextFree;        // Free slot list, slot + 1
+        uint32 padding;
+    };
+
+    static constexpr uint64 c_BLOCK_ALIGNMENT = 16;
+
+    // Blocks visited per Compact() call at most, bounds the cost of long runs of small holes.
+    static constexpr uint32 c_MAX_BLOCKS_PER_STEP = 4096;
+
+    BlockHeader* GetHeader(uint64 offset) const;
+    HandleEntry* GetEntry(RelocatableHandle handle) const;
+
+    bool EnsureCommitted(uint64 end);
+    void TrimCommitted();
+
+    uint64 CompactStep(uint64 maxBytes, uint32 maxBlocks);
+    void FinishPass();
+
+private:
+
+    MemoryManager::MemoryTag tag;
+
+    uint8* memory;
+    uint64 capacity;
+    uint64 committed;
+    uint64 top;
+    uint64 liveSize;
+
+    HandleEntry* handles;
+    uint32 maxHandles;
+    uint32 handleCount;     // Slots handed out at least once
+    uint32 freeHandle;      // Head of the free slot list, slot + 1
+    uint32 liveHandles;
+
+    // Compaction pass state: blocks below dest are packed, [dest, scan) is free, scan is the next block.
+    bool compacting;
+    bool dirty;             // Holes appeared (or blocks were unpinned) since the last pass started
+    uint64 scan;
+    uint64 dest;
+    uint64 holeBytes;
+
+    mutable std::mutex mutex;
+};
@@ -149,9 +149,9 @@ bool RendererFrontend::DrawFrame(RenderPacket* packet)
 		// Use Camera Attributes, passed along with renderpacket.
 		UpdateGlobalWorldState(BuiltInRenderpass::SCENE, packet->editorCamera.GetProjectionMatrix(), packet->editorCamera.GetViewMatrix(), packet->editorCamera.GetPos(), float4::one, 0);
 
-		for (auto& geometry : packet->geometries)
+		for (uint32 i = 0; i < packet->geometryCount; ++i)
 		{
-			DrawGeometry(BuiltInRenderpass::SCENE, geometry);
+			DrawGeometry(BuiltInRenderpass::SCENE, packet->geometries[i]);
 		}
 
 		// DrawGameCamera();
@@ -174,9 +174,9 @@ bool RendererFrontend::DrawFrame(RenderPacket* packet)
 		// Use Camera Attributes, passed along with renderpacket.
 		UpdateGlobalWorldState(BuiltInRenderpass::GAME, packet->gameCamera.GetProjectionMatrix(), packet->gameCamera.GetViewMatrix(), packet->gameCamera.GetPos(), float4::one, 0);
 
-		for (auto& geometry : packet->geometries)
+		for (uint32 i = 0; i < packet->geometryCount; ++i)
 		{
-			DrawGeometry(BuiltInRenderpass::GAME, geometry);
+			DrawGeometry(BuiltInRenderpass::GAME, packet->geometries[i]);
 		}
 
 		if (!EndRenderpass(BuiltInRenderpass::GAME))
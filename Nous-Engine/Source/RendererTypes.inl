@@ -29,7 +29,9 @@ struct RenderPacket
     Camera gameCamera;
     float deltaTime;
 
-    std::vector<GeometryRenderData> geometries;
+    // Allocated from the Application's FrameAllocator, only valid during the frame it was built in.
+    GeometryRenderData* geometries = nullptr;
+    uint32 geometryCount = 0;
 };
 
 enum class RendererBackendType
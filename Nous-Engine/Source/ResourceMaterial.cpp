@@ -8,6 +8,8 @@ ResourceMaterial::ResourceMaterial(UID uid) : Resource(uid, ResourceType::MATERI
 	ID = INVALID_ID;
 	internalID = INVALID_ID;
 	generation = INVALID_ID;
+
+	diffuseColor = float4::zero;
 }
 
 ResourceMaterial::~ResourceMaterial()
@@ -6,6 +6,11 @@ ResourceMesh::ResourceMesh(UID uid) : Resource(uid, ResourceType::MESH)
 	internalID = INVALID_ID;
 	generation = INVALID_ID;
 
+	vertexCount = 0;
+	indexCount = 0;
+
+	pendingLoads = 0;
+
 	material = nullptr;
 }
 
@@ -4,6 +4,8 @@
 #include "Resource.h"
 
 #include "RendererTypes.inl"
+#include "NousAllocator.h"
+#include "RelocatableHeap.h"
 
 class ResourceMaterial;
 
@@ -22,8 +24,17 @@ public:
 	uint32 internalID;
 	uint32 generation;
 
-	std::vector<Vertex3D> vertices;
-	std::vector<uint32> indices;
+	nous::vector<Vertex3D, MemoryManager::MemoryTag::RESOURCE_MESH> vertices;
+	nous::vector<uint32, MemoryManager::MemoryTag::RESOURCE_MESH> indices;
+
+	// Geometry read from the library lives in the Application's relocatable heap instead of the vectors
+	RelocatableHandle vertexData;
+	RelocatableHandle indexData;
+	uint64 vertexCount;
+	uint64 indexCount;
+
+	// Importer loads in flight, the CPU copy can't be released meanwhile (guarded by the resource manager's mutex)
+	uint32 pendingLoads;
 
 	ResourceMaterial* material;
 };
\ No newline at end of file
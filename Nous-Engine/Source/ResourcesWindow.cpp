@@ -22,7 +22,7 @@ void Resources::Draw()
     {
         if (ImGui::Begin(title, p_open))
         {
-            std::unordered_map<UID, Resource*> resourcesMap = External->resourceManager->GetResourcesMap();
+            const auto& resourcesMap = External->resourceManager->GetResourcesMap();
             uint32 currentResourceCount = resourcesMap.size();
 
             ImGui::TextColored(
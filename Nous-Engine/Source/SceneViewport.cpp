@@ -131,7 +131,7 @@ void SceneViewport::Draw()
                         External->jobSystem->SubmitJob([path]()
                             {
                                 External->resourceManager->CreateResource(path);
-                            }, "Create Resource");
+                            }, "Create Resource", NOUS_Multithreading::NOUS_JobPriority::BACKGROUND);
                         
                     }
 
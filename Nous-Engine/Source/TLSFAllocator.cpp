@@ -0,0 +1,355 @@
+#include "TLSFAllocator.h"
+
+#include "MemoryManager.h"
+#include "Logger.h"
+
+#include <bit>
+
+static const uint64 c_FREE_BIT = 1;
+static const uint64 c_INVALID_OFFSET = ~0ULL;
+
+uint64 TLSFAllocator::GetMemoryRequirement(uint64 totalSize)
+{
+    // Caught here too, callers size their reservation with this before constructing the allocator.
+    NOUS_ASSERT_MSG(totalSize < (1ULL << c_FL_INDEX_MAX), "TLSF pool exceeds the maximum block size.");
+
+    // Block headers are stored inside the pool, the control structure has a fixed size.
+    return sizeof(InternalState);
+}
+
+TLSFAllocator::TLSFAllocator(uint64 totalSize, void* memory, void* pool)
+{
+    state_ = reinterpret_cast<InternalState*>(memory);
+    new (state_) InternalState();
+
+    NOUS_ASSERT_MSG((reinterpret_cast<uintptr_t>(pool) & (c_ALIGNMENT - 1)) == 0, "TLSF pool must be 16-byte aligned.");
+    NOUS_ASSERT_MSG(totalSize < (1ULL << c_FL_INDEX_MAX), "TLSF pool exceeds the maximum block size.");
+
+    state_->totalSize = totalSize & ~(c_ALIGNMENT - 1);
+    state_->pool = static_cast<char*>(pool);
+
+    Clear();
+}
+
+TLSFAllocator::~TLSFAllocator()
+{
+    if (state_)
+    {
+        MemoryManager::ZeroMemory(state_, GetMemoryRequirement(state_->totalSize));
+    }
+}
+
+bool TLSFAllocator::Allocate(uint64 size, uint64* outOffset)
+{
+    if (!outOffset || !state_ || size == 0) return false;
+
+    uint64 blockSize = (size + c_HEADER_SIZE + (c_ALIGNMENT - 1)) & ~(c_ALIGNMENT - 1);
+    blockSize = std::max(blockSize, c_MIN_BLOCK_SIZE);
+
+    uint32 fl = 0, sl = 0;
+    MappingSearch(blockSize, &fl, &sl);
+
+    BlockHeader* block = (fl < c_FL_INDEX_COUNT) ? FindSuitableBlock(&fl, &sl) : nullptr;
+
+    // Not reported here, the DynamicAllocator owner grows the pool and retries before calling it an error
+    if (!block) return false;
+
+    RemoveFreeBlock(block);
+
+    // Split the remainder into a new free block if it's big enough to hold one
+    const uint64 remaining = GetSize(block) - blockSize;
+
+    if (remaining >= c_MIN_BLOCK_SIZE)
+    {
+        BlockHeader* remainder = GetBlock(GetOffset(block) + blockSize);
+        remainder->prevPhysOffset = GetOffset(block);
+        remainder->size = remaining | c_FREE_BIT;
+
+        BlockHeader* next = GetNextPhys(remainder);
+
+        if (next) next->prevPhysOffset = GetOffset(remainder);
+        else state_->lastBlockOffset = GetOffset(remainder);
+
+        InsertFreeBlock(remainder);
+
+        block->size = blockSize;
+    }
+    else
+    {
+        block->size = GetSize(block);
+    }
+
+    state_->freeSpace -= GetSize(block);
+
+    *outOffset = GetOffset(block) + c_HEADER_SIZE;
+
+    return true;
+}
+
+bool TLSFAllocator::Free(uint64 size, uint64 offset)
+{
+    if (!state_ || offset < c_HEADER_SIZE || offset >= state_->totalSize) return false;
+
+    BlockHeader* block = GetBlock(offset - c_HEADER_SIZE);
+
+    if (IsFree(block) || GetSize(block) < size + c_HEADER_SIZE)
+    {
+        // Log warning about possible corruption
+        NOUS_WARN("TLSFAllocator::Free(). WARNING: Possible Memory Corruption.");
+        return false;
+    }
+
+    state_->freeSpace += GetSize(block);
+
+    // Coalesce with the previous physical block
+    if (block->prevPhysOffset != c_INVALID_OFFSET)
+    {
+        BlockHeader* prev = GetBlock(block->prevPhysOffset);
+
+        if (IsFree(prev))
+        {
+            RemoveFreeBlock(prev);
+            prev->size = GetSize(prev) + GetSize(block);
+            block = prev;
+        }
+    }
+
+    // Coalesce with the next physical block
+    BlockHeader* next = GetNextPhys(block);
+
+    if (next && IsFree(next))
+    {
+        RemoveFreeBlock(next);
+        block->size = GetSize(block) + GetSize(next);
+    }
+
+    next = GetNextPhys(block);
+
+    if (next) next->prevPhysOffset = GetOffset(block);
+    else state_->lastBlockOffset = GetOffset(block);
+
+    block->size = GetSize(block) | c_FREE_BIT;
+    InsertFreeBlock(block);
+
+    return true;
+}
+
+bool TLSFAllocator::Grow(uint64 newTotalSize)
+{
+    if (!state_) return false;
+
+    newTotalSize &= ~(c_ALIGNMENT - 1);
+
+    NOUS_ASSERT_MSG(newTotalSize < (1ULL << c_FL_INDEX_MAX), "TLSF pool exceeds the maximum block size.");
+
+    if (newTotalSize <= state_->totalSize) return false;
+
+    const uint64 oldTotalSize = state_->totalSize;
+    const uint64 growth = newTotalSize - oldTotalSize;
+
+    // An empty pool has no blocks yet, start it from scratch
+    if (oldTotalSize < c_MIN_BLOCK_SIZE)
+    {
+        state_->totalSize = newTotalSize;
+        Clear();
+        return true;
+    }
+
+    BlockHeader* last = GetBlock(state_->lastBlockOffset);
+
+    if (IsFree(last))
+    {
+        // Stretch the trailing free block over the new memory
+        RemoveFreeBlock(last);
+        last->size = (GetSize(last) + growth) | c_FREE_BIT;
+        state_->totalSize = newTotalSize;
+        InsertFreeBlock(last);
+    }
+    else if (growth >= c_MIN_BLOCK_SIZE)
+    {
+        BlockHeader* tail = GetBlock(oldTotalSize);
+        tail->prevPhysOffset = state_->lastBlockOffset;
+        tail->size = growth | c_FREE_BIT;
+
+        state_->totalSize = newTotalSize;
+        state_->lastBlockOffset = oldTotalSize;
+        InsertFreeBlock(tail);
+    }
+    else
+    {
+        // Too small to hold a block, wait for a bigger growth
+        return false;
+    }
+
+    state_->freeSpace += growth;
+
+    return true;
+}
+
+void TLSFAllocator::Clear()
+{
+    if (!state_) return;
+
+    state_->flBitmap = 0;
+    MemoryManager::ZeroMemory(state_->slBitmap, sizeof(state_->slBitmap));
+    MemoryManager::ZeroMemory(state_->blocks, sizeof(state_->blocks));
+
+    state_->freeSpace = 0;
+
+    if (state_->totalSize < c_MIN_BLOCK_SIZE) return;
+
+    BlockHeader* block = GetBlock(0);
+    block->prevPhysOffset = c_INVALID_OFFSET;
+    block->size = state_->totalSize | c_FREE_BIT;
+
+    state_->lastBlockOffset = 0;
+
+    state_->freeSpace = state_->totalSize;
+
+    InsertFreeBlock(block);
+}
+
+uint64 TLSFAllocator::FreeSpace() const
+{
+    return state_ ? state_->freeSpace : 0;
+}
+
+uint64 TLSFAllocator::LargestFreeBlock() const
+{
+    if (!state_ || !state_->flBitmap) return 0;
+
+    // The biggest block lives in the highest non-empty bin, which only needs a short scan.
+    const uint32 fl = 31 - std::countl_zero(state_->flBitmap);
+    const uint32 sl = 31 - std::countl_zero(state_->slBitmap[fl]);
+
+    uint64 largest = 0;
+
+    for (BlockHeader* block = state_->blocks[fl][sl]; block; block = block->nextFree)
+    {
+        largest = std::max(largest, GetSize(block));
+    }
+
+    return largest > c_HEADER_SIZE ? largest - c_HEADER_SIZE : 0;
+}
+
+// ----------------------------------------------------------------------- //
+
+void TLSFAllocator::MappingInsert(uint64 size, uint32* fl, uint32* sl)
+{
+    if (size < c_SMALL_BLOCK_SIZE)
+    {
+        // Small blocks are linearly split in SL_INDEX_COUNT bins of ALIGNMENT bytes
+        *fl = 0;
+        *sl = static_cast<uint32>(size / (c_SMALL_BLOCK_SIZE / c_SL_INDEX_COUNT));
+    }
+    else
+    {
+        const uint32 bit = static_cast<uint32>(std::bit_width(size) - 1);
+
+        *sl = static_cast<uint32>((size >> (bit - c_SL_INDEX_COUNT_LOG2)) ^ c_SL_INDEX_COUNT);
+        *fl = static_cast<uint32>(bit - (c_FL_INDEX_SHIFT - 1));
+    }
+}
+
+void TLSFAllocator::MappingSearch(uint64 size, uint32* fl, uint32* sl)
+{
+    // Round up to the next bin so any block found there is guaranteed to fit
+    if (size >= c_SMALL_BLOCK_SIZE)
+    {
+        const uint32 bit = static_cast<uint32>(std::bit_width(size) - 1);
+        size += (1ULL << (bit - c_SL_INDEX_COUNT_LOG2)) - 1;
+    }
+
+    MappingInsert(size, fl, sl);
+}
+
+TLSFAllocator::BlockHeader* TLSFAllocator::FindSuitableBlock(uint32* fl, uint32* sl)
+{
+    uint32 slMap = state_->slBitmap[*fl] & (~0U << *sl);
+
+    if (!slMap)
+    {
+        // No block in this first level, look for the next non-empty one
+        const uint32 flMap = (*fl + 1 < 32) ? (state_->flBitmap & (~0U << (*fl + 1))) : 0;
+
+        if (!flMap) return nullptr;
+
+        *fl = static_cast<uint32>(std::countr_zero(flMap));
+        slMap = state_->slBitmap[*fl];
+    }
+
+    *sl = static_cast<uint32>(std::countr_zero(slMap));
+
+    return state_->blocks[*fl][*sl];
+}
+
+void TLSFAllocator::InsertFreeBlock(BlockHeader* block)
+{
+    uint32 fl = 0, sl = 0;
+    MappingInsert(GetSize(block), &fl, &sl);
+
+    BlockHeader* head = state_->blocks[fl][sl];
+
+    block->nextFree = head;
+    block->prevFree = nullptr;
+
+    if (head) head->prevFree = block;
+
+    state_->blocks[fl][sl] = block;
+
+    state_->flBitmap |= (1U << fl);
+    state_->slBitmap[fl] |= (1U << sl);
+}
+
+void TLSFAllocator::RemoveFreeBlock(BlockHeader* block)
+{
+    uint32 fl = 0, sl = 0;
+    MappingInsert(GetSize(block), &fl, &sl);
+
+    if (block->prevFree) block->prevFree->nextFree = block->nextFree;
+    if (block->nextFree) block->nextFree->prevFree = block->prevFree;
+
+    if (state_->blocks[fl][sl] == block)
+    {
+        state_->blocks[fl][sl] = block->nextFree;
+
+        if (!block->nextFree)
+        {
+            state_->slBitmap[fl] &= ~(1U << sl);
+
+            if (!state_->slBitmap[fl])
+            {
+                state_->flBitmap &= ~(1U << fl);
+            }
+        }
+    }
+
+    block->nextFree = nullptr;
+    block->prevFree = nullptr;
+}
+
+TLSFAllocator::BlockHeader* TLSFAllocator::GetBlock(uint64 offset) const
+{
+    return reinterpret_cast<BlockHeader*>(state_->pool + offset);
+}
+
+uint64 TLSFAllocator::GetOffset(const BlockHeader* block) const
+{
+    return reinterpret_cast<const char*>(block) - state_->pool;
+}
+
+TLSFAllocator::BlockHeader* TLSFAllocator::GetNextPhys(const BlockHeader* block) const
+{
+    const uint64 nextOffset = GetOffset(block) + GetSize(block);
+    return (nextOffset < state_->totalSize) ? GetBlock(nextOffset) : nullptr;
+}
+
+uint64 TLSFAllocator::GetSize(const BlockHeader* block)
+{
+    return block->size & ~c_FREE_BIT;
+}
+
+bool TLSFAllocator::IsFree(const BlockHeader* block)
+{
+    return (block->size & c_FREE_BIT) != 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Globals.h"
+
+// Two-Level Segregated Fit allocator.
+// Free blocks are binned by a first level (power of two) and a second level (linear subdivision
+// of that power of two), each level indexed by a bitmap. Allocation, free and coalescing are O(1).
+// Block headers live in-band, right before the returned offset, so the pool must be CPU memory.
+
+class TLSFAllocator
+{
+public:
+
+    static constexpr uint64 c_ALIGNMENT_LOG2 = 4;
+    static constexpr uint64 c_ALIGNMENT = 1ULL << c_ALIGNMENT_LOG2;
+
+    static constexpr uint64 c_SL_INDEX_COUNT_LOG2 = 5;
+    static constexpr uint64 c_SL_INDEX_COUNT = 1ULL << c_SL_INDEX_COUNT_LOG2;
+
+    static constexpr uint64 c_FL_INDEX_MAX = 38; // Blocks up to 256 GiB
+    static constexpr uint64 c_FL_INDEX_SHIFT = c_SL_INDEX_COUNT_LOG2 + c_ALIGNMENT_LOG2;
+    static constexpr uint64 c_FL_INDEX_COUNT = c_FL_INDEX_MAX - c_FL_INDEX_SHIFT + 1;
+
+    static constexpr uint64 c_SMALL_BLOCK_SIZE = 1ULL << c_FL_INDEX_SHIFT;
+
+    struct BlockHeader
+    {
+        uint64 prevPhysOffset;  // INVALID offset for the first block in the pool
+        uint64 size;            // Total block size (header included), bit 0 flags a free block
+
+        // Only valid while the block is free, they overlap the user payload.
+        BlockHeader* nextFree;
+        BlockHeader* prevFree;
+    };
+
+    static constexpr uint64 c_HEADER_SIZE = 2 * sizeof(uint64);
+    static constexpr uint64 c_MIN_BLOCK_SIZE = sizeof(BlockHeader);
+
+    static uint64 GetMemoryRequirement(uint64 totalSize);
+
+    /// @param totalSize: Size of the managed pool.
+    /// @param memory: Block of GetMemoryRequirement() bytes for the control structure.
+    /// @param pool: Block of totalSize bytes (16-byte aligned) handed out to the user.
+    TLSFAllocator(uint64 totalSize, void* memory, void* pool);
+    ~TLSFAllocator();
+
+    bool Allocate(uint64 size, uint64* outOffset);
+    bool Free(uint64 size, uint64 offset);
+
+    /// @brief Extends the pool in place, the memory right after the current pool must be accessible.
+    bool Grow(uint64 newTotalSize);
+
+    void Clear();
+
+    uint64 FreeSpace() const;
+    uint64 LargestFreeBlock() const;
+
+private:
+
+    struct InternalState
+    {
+        uint64 totalSize;
+        uint64 freeSpace;
+        uint64 lastBlockOffset; // Physically last block, extended by Grow()
+        char* pool;
+
+        uint32 flBitmap;
+        uint32 slBitmap[c_FL_INDEX_COUNT];
+        BlockHeader* blocks[c_FL_INDEX_COUNT][c_SL_INDEX_COUNT];
+
+        InternalState() : totalSize(0), freeSpace(0), lastBlockOffset(0), pool(nullptr), flBitmap(0), slBitmap(), blocks() {}
+    };
+
+    static void MappingInsert(uint64 size, uint32* fl, uint32* sl);
+    static void MappingSearch(uint64 size, uint32* fl, uint32* sl);
+
+    BlockHeader* FindSuitableBlock(uint32* fl, uint32* sl);
+
+    void InsertFreeBlock(BlockHeader* block);
+    void RemoveFreeBlock(BlockHeader* block);
+
+    BlockHeader* GetBlock(uint64 offset) const;
+    uint64 GetOffset(const BlockHeader* block) const;
+    BlockHeader* GetNextPhys(const BlockHeader* block) const;
+
+    static uint64 GetSize(const BlockHeader* block);
+    static bool IsFree(const BlockHeader* block);
+
+    InternalState* state_ = nullptr;
+};
@@ -0,0 +1,98 @@
+#include "VirtualMemory.h"
+
+#include "Logger.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+uint64 VirtualMemory::GetPageSize()
+{
+	static const uint64 pageSize = []()
+		{
+#ifdef _WIN32
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return static_cast<uint64>(info.dwPageSize);
+#else
+			return static_cast<uint64>(sysconf(_SC_PAGESIZE));
+#endif
+		}();
+
+	return pageSize;
+}
+
+void* VirtualMemory::Reserve(uint64 size)
+{
+#ifdef _WIN32
+	void* address = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+	void* address = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (address == MAP_FAILED) address = nullptr;
+#endif
+
+	if (!address)
+	{
+		NOUS_ERROR("VirtualMemory::Reserve() - Failed to reserve %llu bytes", size);
+	}
+
+	return address;
+}
+
+bool VirtualMemory::Commit(void* address, uint64 size, bool useHugePages)
+{
+	if (size == 0) return true;
+
+#ifdef _WIN32
+	// Windows has no transparent huge pages, large pages need a privilege and can't be committed lazily.
+	const bool committed = VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+	const bool committed = mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+
+#ifdef MADV_HUGEPAGE
+	if (committed && useHugePages)
+	{
+		madvise(address, size, MADV_HUGEPAGE);
+	}
+#endif
+#endif
+
+	if (!committed)
+	{
+		NOUS_ERROR("VirtualMemory::Commit() - Failed to commit %llu bytes", size);
+	}
+
+	return committed;
+}
+
+bool VirtualMemory::Decommit(void* address, uint64 size)
+{
+	if (size == 0) return true;
+
+#ifdef _WIN32
+	return VirtualFree(address, size, MEM_DECOMMIT) != 0;
+#else
+	// Drop the pages first so the range reads as zero if it gets committed again
+	return madvise(address, size, MADV_DONTNEED) == 0 && mprotect(address, size, PROT_NONE) == 0;
+#endif
+}
+
+void VirtualMemory::Release(void* address, uint64 size)
+{
+	if (!address) return;
+
+#ifdef _WIN32
+	VirtualFree(address, 0, MEM_RELEASE);
+#else
+	munmap(address, size);
+#endif
+}
+
+uint64 VirtualMemory::AlignToPage(uint64 size)
+{
+	const uint64 pageSize = GetPageSize();
+	return (size + (pageSize - 1)) & ~(pageSize - 1);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Globals.h"
+
+// Thin wrapper over the OS virtual memory API.
+// Address ranges are reserved first (no physical memory or commit charge) and committed page by page
+// when they're actually needed. Every size and address must be a multiple of GetPageSize().
+
+namespace VirtualMemory
+{
+	uint64 GetPageSize();
+
+	/**
+	 * @brief Reserves an inaccessible address range.
+	 * @return Base address of the range, nullptr on failure.
+	 */
+	void* Reserve(uint64 size);
+
+	/**
+	 * @brief Makes part of a reserved range readable and writable. Committed pages read as zero.
+	 * @param useHugePages: Hint to back the range with transparent huge pages where the OS supports it.
+	 */
+	bool Commit(void* address, uint64 size, bool useHugePages = false);
+
+	/**
+	 * @brief Returns the physical pages of a committed range to the OS, the range stays reserved.
+	 */
+	bool Decommit(void* address, uint64 size);
+
+	void Release(void* address, uint64 size);
+
+	uint64 AlignToPage(uint64 size);
+}
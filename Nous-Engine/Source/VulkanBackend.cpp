@@ -345,8 +345,6 @@ void VulkanBackend::Resized(uint16 width, uint16 height)
 
 bool VulkanBackend::BeginFrame(float dt)
 {
-    ProcessPendingSubmissions();
-
     vkContext->frameDeltaTime = dt;
 
     VulkanDevice* device = &vkContext->device;
@@ -1064,7 +1062,7 @@ bool VulkanBackend::CreateGeometry(uint32 vertexCount, const Vertex3D* vertices,
     internalData->vertexSize = sizeof(Vertex3D) * vertexCount;
 
     if (!NOUS_VulkanBuffer::UploadDataRange(vkContext, pool, 0, queue, &vkContext->objectVertexBuffer,
-        &internalData->vertexBufferOffset, internalData->vertexSize, vertices))
+        &internalData->vertexBufferOffset, internalData->vertexSize, sizeof(Vertex3D), vertices))
     {
         NOUS_ERROR("VulkanBackend::CreateGeometry() failed to upload to the vertex buffer!");
         return false;
@@ -1077,7 +1075,7 @@ bool VulkanBackend::CreateGeometry(uint32 vertexCount, const Vertex3D* vertices,
         internalData->indexSize = sizeof(uint32) * indexCount;
 
         if (!NOUS_VulkanBuffer::UploadDataRange(vkContext, pool, 0, queue, &vkContext->objectIndexBuffer,
-            &internalData->indexBufferOffset, internalData->indexSize, indices))
+            &internalData->indexBufferOffset, internalData->indexSize, sizeof(uint32), indices))
         {
             NOUS_ERROR("VulkanBackend::CreateGeometry() failed to upload to the index buffer!");
             return false;
@@ -1138,30 +1136,4 @@ void VulkanBackend::DestroyGeometry(ResourceMesh* geometry)
 VulkanContext* VulkanBackend::GetVulkanContext()
 {
     return vkContext;
-}
-
-void VulkanBackend::ProcessPendingSubmissions() 
-{
-    std::unique_lock<std::mutex> lock(vkContext->submitQueueMutex);
-
-    while (!vkContext->submitQueue.empty()) 
-    {
-        auto task = std::move(vkContext->submitQueue.front());
-        vkContext->submitQueue.pop_front();
-
-        lock.unlock(); // Unlock while processing
-
-        std::lock_guard<std::mutex> queueLock(vkContext->device.graphicsQueueMutex);
-        VkResult result = vkQueueSubmit(task.queue, task.submitCount, task.pSubmits, task.fence);
-
-        bool success = (result == VK_SUCCESS);
-        if (success && task.waitIdle) 
-        {
-            success = (vkQueueWaitIdle(task.queue) == VK_SUCCESS);
-        }
-
-        task.resultPromise.set_value(success);
-
-        lock.lock(); // Re-lock for next iteration
-    }
 }
\ No newline at end of file
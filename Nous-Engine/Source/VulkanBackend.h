@@ -50,8 +50,6 @@ public:
 
 	static VulkanContext* GetVulkanContext();
 
-	void ProcessPendingSubmissions();
-
 	VulkanCommandBuffer* GetCommandBufferByRenderpassID(BuiltInRenderpass renderpassID);
 
 private:
@@ -300,7 +300,7 @@ void NOUS_VulkanBuffer::UnlockMemory(VulkanContext* vkContext, VulkanBuffer* buf
     vkUnmapMemory(vkContext->device.logicalDevice, buffer->memory);
 }
 
-bool NOUS_VulkanBuffer::Allocate(VulkanBuffer* buffer, uint64 size, uint64* outOffset)
+bool NOUS_VulkanBuffer::Allocate(VulkanBuffer* buffer, uint64 size, uint64 alignment, uint64* outOffset)
 {
     // ----- FREE LIST ----- //
     if (!buffer || !size || !outOffset) 
@@ -309,7 +309,7 @@ bool NOUS_VulkanBuffer::Allocate(VulkanBuffer* buffer, uint64 size, uint64* outO
         return false;
     }
 
-    return buffer->bufferFreelist->Allocate(size, outOffset);
+    return buffer->bufferFreelist->Allocate(size, alignment, outOffset);
 }
 
 bool NOUS_VulkanBuffer::Free(VulkanBuffer* buffer, uint64 size, uint64 offset)
@@ -326,11 +326,11 @@ bool NOUS_VulkanBuffer::Free(VulkanBuffer* buffer, uint64 size, uint64 offset)
 
 // -------------------------------------------------------------------------------------------------------- //
 
-bool NOUS_VulkanBuffer::UploadDataRange(VulkanContext* vkContext, VkCommandPool pool, VkFence fence, VkQueue queue, VulkanBuffer* buffer, uint64* outOffset, uint64 size, const void* data)
+bool NOUS_VulkanBuffer::UploadDataRange(VulkanContext* vkContext, VkCommandPool pool, VkFence fence, VkQueue queue, VulkanBuffer* buffer, uint64* outOffset, uint64 size, uint64 alignment, const void* data)
 {
     // ----- FREE LIST ----- //
     // Allocate space in the buffer.
-    if (!NOUS_VulkanBuffer::Allocate(buffer, size, outOffset))
+    if (!NOUS_VulkanBuffer::Allocate(buffer, size, alignment, outOffset))
     {
         NOUS_ERROR("NOUS_VulkanBuffer::UploadDataRange() failed to allocate from the given buffer!");
         return false;
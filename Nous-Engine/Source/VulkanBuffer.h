@@ -28,13 +28,13 @@ namespace NOUS_VulkanBuffer
 	void* LockMemory(VulkanContext* vkContext, VulkanBuffer* buffer, uint64 offset, uint64 size, uint32 flags);
 	void UnlockMemory(VulkanContext* vkContext, VulkanBuffer* buffer);
 
-	bool Allocate(VulkanBuffer* buffer, uint64 size, uint64* outOffset);
+	bool Allocate(VulkanBuffer* buffer, uint64 size, uint64 alignment, uint64* outOffset);
 	bool Free(VulkanBuffer* buffer, uint64 size, uint64 offset);
 
 	// -------------------------------------------------------------------------------------------------------- //
 
 	bool UploadDataRange(VulkanContext* vkContext, VkCommandPool pool, VkFence fence, VkQueue queue,
-		VulkanBuffer* buffer, uint64* outOffset, uint64 size, const void* data);
+		VulkanBuffer* buffer, uint64* outOffset, uint64 size, uint64 alignment, const void* data);
 
 	void FreeDataRange(VulkanContext* vkContext, VulkanBuffer* buffer, uint64 offset, uint64 size);
 }
\ No newline at end of file
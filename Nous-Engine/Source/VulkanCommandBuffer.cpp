@@ -211,7 +211,7 @@ void NOUS_VulkanCommandBuffer::CommandBufferEndAndFreeSingleTime(VulkanContext*
     queueSubmitInfo.commandBufferCount = 1;
     queueSubmitInfo.pCommandBuffers = &commandBuffer->handle;
 
-    NOUS_VulkanMultithreading::CreateQueueSubmitTask(vkContext, queue, 1, &queueSubmitInfo, 0, true);
+    NOUS_VulkanMultithreading::QueueSubmitThreadSafe(vkContext, queue, 1, &queueSubmitInfo, 0, true);
 
     // Free the command buffer.
     CommandBufferFree(vkContext, commandPool, commandBuffer);
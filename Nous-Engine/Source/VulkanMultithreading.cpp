@@ -107,66 +107,28 @@ VkCommandPool NOUS_VulkanMultithreading::GetThreadCommandPool(VulkanContext* vkC
 
 bool NOUS_VulkanMultithreading::QueueSubmitThreadSafe(VulkanContext* vkContext, VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence, bool waitIdle)
 {
-    // If we're on the main thread, submit immediately
-    if (NOUS_Multithreading::GetMainThread()->GetID() == NOUS_Multithreading::NOUS_Thread::GetThreadID(std::this_thread::get_id())) 
-    {
+    auto submit = [=]() -> bool {
         std::lock_guard<std::mutex> lock(vkContext->device.graphicsQueueMutex);
         VkResult result = vkQueueSubmit(queue, submitCount, pSubmits, fence);
         if (result != VK_SUCCESS) return false;
         if (waitIdle) return vkQueueWaitIdle(queue) == VK_SUCCESS;
         return true;
-    }
-
-    // Otherwise, enqueue the task for the main thread
-    VulkanSubmitTask task;
-    task.queue = queue;
-    task.submitCount = submitCount;
-    task.pSubmits = pSubmits;
-    task.fence = fence;
-    task.waitIdle = waitIdle;
-
-    std::promise<bool> resultPromise;
-    auto resultFuture = resultPromise.get_future();
-    task.resultPromise = std::move(resultPromise);
-
-    {
-        std::lock_guard<std::mutex> lock(vkContext->submitQueueMutex);
-        vkContext->submitQueue.push_back(std::move(task));
-    }
-    vkContext->submitQueueCV.notify_one();
-
-    return resultFuture.get(); // Block until the main thread processes it
-}
+    };
 
-bool NOUS_VulkanMultithreading::CreateQueueSubmitTask(VulkanContext* vkContext, VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence, bool waitIdle)
-{
     // If we're on the main thread, submit immediately
-    if (NOUS_Multithreading::GetMainThread()->GetID() == NOUS_Multithreading::NOUS_Thread::GetThreadID(std::this_thread::get_id()))
+    if (External->jobSystem->IsMainThread())
     {
-        std::lock_guard<std::mutex> lock(vkContext->device.graphicsQueueMutex);
-        VkResult result = vkQueueSubmit(queue, submitCount, pSubmits, fence);
-        if (result != VK_SUCCESS) return false;
-        if (waitIdle) return vkQueueWaitIdle(queue) == VK_SUCCESS;
-        return true;
+        return submit();
     }
 
-    // Otherwise, enqueue the task for the main thread
-    VulkanSubmitTask task;
-    task.queue = queue;
-    task.submitCount = submitCount;
-    task.pSubmits = pSubmits;
-    task.fence = fence;
-    task.waitIdle = waitIdle;
+    // Otherwise, hand it to the main thread. pSubmits stays valid, this thread doesn't return before the task runs
+    bool result = false;
 
-    std::promise<bool> resultPromise;
-    auto resultFuture = resultPromise.get_future();
-    task.resultPromise = std::move(resultPromise);
+    NOUS_Multithreading::NOUS_JobHandle submitTask = External->jobSystem->SubmitMainThreadTask(
+        [&result, &submit]() { result = submit(); }, "Vulkan Queue Submit");
 
-    {
-        std::lock_guard<std::mutex> lock(vkContext->submitQueueMutex);
-        vkContext->submitQueue.push_back(std::move(task));
-    }
-    vkContext->submitQueueCV.notify_one();
+    // Runs other jobs until the main thread gets to it
+    External->jobSystem->Wait(submitTask);
 
-    return resultFuture.get(); // Block until the main thread processes it
-}
+    return result;
+}
\ No newline at end of file
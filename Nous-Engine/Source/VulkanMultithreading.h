@@ -11,5 +11,4 @@ namespace NOUS_VulkanMultithreading
     VkCommandPool GetThreadCommandPool(VulkanContext* vkContext, uint32 threadID);
 
 	bool QueueSubmitThreadSafe(VulkanContext* vkContext, VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence, bool waitIdle);
-	bool CreateQueueSubmitTask(VulkanContext* vkContext, VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence, bool waitIdle);
 }
\ No newline at end of file
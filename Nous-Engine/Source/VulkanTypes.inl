@@ -9,8 +9,7 @@
 
 #include "Vulkan.h"
 #include "FreeList.h"
-
-#include <future>
+#include "NousAllocator.h"
 
 struct VulkanImage
 {
@@ -134,7 +133,7 @@ struct VulkanDevice
     VkCommandPool mainGraphicsCommandPool;
 
     /* MULTITHREADING */
-    std::unordered_map<uint32, VkCommandPool> workerCommandPools;
+    nous::unordered_map<uint32, VkCommandPool, MemoryManager::MemoryTag::RENDERER> workerCommandPools;
 
     VkQueue graphicsQueue;
     std::mutex graphicsQueueMutex;
@@ -364,15 +363,6 @@ struct VulkanImGuiResources
     std::array<VkDescriptorSet, 3> m_GameViewportDescriptorSets;
 };
 
-struct VulkanSubmitTask {
-    VkQueue queue;
-    uint32_t submitCount;
-    const VkSubmitInfo* pSubmits;
-    VkFence fence;
-    bool waitIdle;
-    std::promise<bool> resultPromise;
-};
-
 /**
  * @brief Stores all the Vulkan Context variables
  */
@@ -427,10 +417,6 @@ struct VulkanContext
     std::array<VulkanGeometryData, VULKAN_MAX_GEOMETRY_COUNT> geometries;
 
     VulkanImGuiResources imGuiResources;
-
-    std::deque<VulkanSubmitTask> submitQueue;
-    std::mutex submitQueueMutex;
-    std::condition_variable submitQueueCV;
 };
 
 struct VulkanTextureData 